@@ -4,14 +4,33 @@
 #include "lve_renderer.hpp"
 #include "lve_window.hpp"
 #include "lve_game_object.hpp"
+#include "lve_broad_phase.hpp"
+#include "lve_aabb_tree.hpp"
+#include "lve_camera.hpp"
 #include "lve_descriptors.hpp"
 #include "lve_imgui.hpp"
+#include "lve_simple_render_system.hpp"
 
 //std
 #include <memory>
 #include <vector>
 
 namespace lve {
+    /**
+     * @brief Runtime options of the application, usually filled from the command line.
+    */
+    struct AppConfig {
+        bool headless = false; /** @brief Render into offscreen images without creating a window. */
+        int frameCount = 0; /** @brief Number of frames to render before exiting (0 to run until the window is closed). */
+        bool frustumCulling = true; /** @brief Skip the objects outside the camera frustum. */
+        bool gpuCulling = false; /** @brief Start with the GPU-driven path (compute culling and indirect draws), it can be switched in the inspector. */
+        bool optimizeMeshes = true; /** @brief Reorder the imported meshes for the vertex cache, overdraw and vertex fetch, and split the large ones into meshlets. */
+        bool clusterCulling = true; /** @brief Cull the meshlets of the visible objects one by one (CPU path). */
+        bool lodSelection = true; /** @brief Draw each object with the level of detail matching its size on screen (CPU path). */
+        bool shaderHotReload = true; /** @brief Rebuild the pipelines in the background when their SPIR-V files change. */
+        LveModel::VertexFormat vertexFormat = LveModel::VertexFormat::Float; /** @brief Layout of the vertex buffers of the models (Compact quantizes them to 20 bytes per vertex). */
+    };
+
     /**
      * @brief Main class representing the application.
     */
@@ -19,11 +38,13 @@ namespace lve {
     public:
         static constexpr int WIDTH = 1280; /** @brief Width of the application window. */
         static constexpr int HEIGHT = 720; /** @brief Height of the application window. */
+        static constexpr int MAX_STEPS_PER_FRAME = 5; /** @brief Largest number of simulation steps run before a frame, the time beyond is dropped. */
 
         /**
-         * @brief Default constructor for the FirstApp class.
+         * @brief Constructor for the FirstApp class.
+         * @param config : The runtime options of the application.
         */
-        FirstApp();
+        FirstApp(const AppConfig& config = AppConfig{});
 
         /**
          * @brief Destructor for the FirstApp class.
@@ -56,16 +77,51 @@ namespace lve {
         */
         void loadCubesCollision();
 
+        /**
+         * @brief Registers the collision box of a game object in the broad phase and the AABB tree.
+         * @param gameObject : The game object (must have a transform component).
+        */
+        void addCollider(LveGameObject& gameObject);
+
+        /**
+         * @brief Updates the broad phase and the AABB tree with the moved boxes and bounces the moving objects off the boxes they overlap.
+        */
+        void updateCollisions();
+
+        /**
+         * @brief Casts a ray from the camera through the mouse cursor and finds the closest collision box it hits.
+         * @param camera : The camera the scene is rendered with.
+         * @param picked : Receives the ID of the game object hit.
+         * @return True if a game object was hit, false otherwise.
+        */
+        bool pickObject(const LveCamera& camera, LveGameObject::id_t& picked);
+
+        /**
+         * @brief Prints the frame time statistics gathered while running.
+         * @param frameTimes : Duration of every rendered frame, in seconds.
+         * @param renderStats : Counters of the last rendered frame.
+         * @param gpuDriven : True if the last frame was culled on the GPU.
+        */
+        void printFrameStats(std::vector<double>& frameTimes, const RenderStats& renderStats, bool gpuDriven);
+
+        /**
+         * @brief Prints the device memory usage of every heap (blocks, allocations, bytes and fragmentation).
+        */
+        void printMemoryStats();
+
 
 
         // ----------------- Variable -----------------
-        LveWindow lveWindow{ WIDTH, HEIGHT, "GG ENGINE" }; /** @brief Main application window. */
+        AppConfig config; /** @brief Runtime options of the application. */
+        LveWindow lveWindow; /** @brief Main application window. */
         LveDevice lveDevice{ lveWindow }; /** @brief Vulkan device for rendering. */
         LveRenderer lveRenderer{ lveWindow,lveDevice }; /** @brief Renderer for rendering graphics. */
         LveImgui lveImgui{ lveWindow, lveDevice, lveRenderer }; /** @brief ImGui integration for UI. */
 
         // note: order of declarations matters
         std::unique_ptr<LveDescriptorPool> globalPool{}; /** @brief Descriptor pool for global settings. */
-        LveGameObject::Map gameObjects; /** @brief Map of game objects in the application. */
+        LveRegistry registry; /** @brief Registry holding the components of the game objects. */
+        LveBroadPhase broadPhase; /** @brief Sweep and prune over the collision boxes of the game objects. */
+        LveAabbTree aabbTree; /** @brief Bounding volume hierarchy over the collision boxes, used for the ray casts and the spatial queries. */
     };
 }
\ No newline at end of file
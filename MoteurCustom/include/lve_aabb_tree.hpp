@@ -0,0 +1,191 @@
+#pragma once
+
+#include "AABB.hpp"
+#include "lve_frustum.hpp"
+#include "Sphere.hpp"
+
+//libs
+#include <glm/glm.hpp>
+
+//std
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace lve {
+    /**
+     * @brief Dynamic bounding volume hierarchy over AABB boxes.
+     * Leaves store a fat box (the box enlarged by a margin), so an object moving inside its fat box does not touch the tree.
+     * Leaves are inserted with the surface area heuristic and the tree is kept balanced with AVL rotations.
+     * Queries reuse an internal stack, so they must not run concurrently on the same tree.
+    */
+    class LveAabbTree {
+    public:
+        static constexpr int32_t NULL_NODE = -1; /** @brief Index of a missing node. */
+
+        using QueryCallback = std::function<bool(int32_t proxy)>; /** @brief Called for each leaf whose fat box matches the query, returns false to stop the query. */
+        using RayCallback = std::function<float(int32_t proxy, float maxDistance)>; /** @brief Called for each leaf whose fat box is hit, returns the distance of the hit on the object (maxDistance to ignore it, a negative value to stop). */
+
+        /**
+         * @brief Constructor for an empty tree.
+         * @param margin : Enlargement of the boxes stored in the leaves.
+        */
+        explicit LveAabbTree(float margin = 0.1f) : margin(margin) {}
+
+        /**
+         * @brief Adds a box to the tree.
+         * @param box : The bounding box.
+         * @param userData : Value stored with the box (usually an entity ID).
+         * @return The proxy identifying the box.
+        */
+        int32_t createProxy(const AABB& box, uint32_t userData);
+
+        /**
+         * @brief Removes a box from the tree.
+         * @param proxy : The proxy returned by createProxy.
+        */
+        void destroyProxy(int32_t proxy);
+
+        /**
+         * @brief Moves a box, the leaf is only reinserted if the box left its fat box.
+         * @param proxy : The proxy returned by createProxy.
+         * @param box : The new bounding box.
+         * @return True if the leaf was reinserted, false otherwise.
+        */
+        bool moveProxy(int32_t proxy, const AABB& box);
+
+        /**
+         * @brief Gets the value stored with a box.
+         * @param proxy : The proxy returned by createProxy.
+         * @return The user data.
+        */
+        uint32_t getUserData(int32_t proxy) const { return nodes[proxy].userData; }
+
+        /**
+         * @brief Gets the enlarged box stored in a leaf.
+         * @param proxy : The proxy returned by createProxy.
+         * @return The fat box.
+        */
+        const AABB& getFatAABB(int32_t proxy) const { return nodes[proxy].box; }
+
+        /**
+         * @brief Calls the callback for every leaf whose fat box overlaps a box.
+         * @param box : The query box.
+         * @param callback : The function called for each leaf.
+        */
+        void query(const AABB& box, const QueryCallback& callback) const;
+
+        /**
+         * @brief Calls the callback for every leaf whose fat box intersects a sphere.
+         * @param sphere : The query sphere.
+         * @param callback : The function called for each leaf.
+        */
+        void querySphere(const Sphere& sphere, const QueryCallback& callback) const;
+
+        /**
+         * @brief Calls the callback for every leaf whose fat box may be inside a frustum.
+         * @param frustum : The query frustum.
+         * @param callback : The function called for each leaf.
+        */
+        void queryFrustum(const LveFrustum& frustum, const QueryCallback& callback) const;
+
+        /**
+         * @brief Casts a ray through the tree, the ray is shortened by every hit returned by the callback.
+         * @param origin : The origin of the ray.
+         * @param direction : The normalized direction of the ray.
+         * @param maxDistance : The length of the ray.
+         * @param callback : The function called for each leaf hit by the ray.
+        */
+        void raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, const RayCallback& callback) const;
+
+        /**
+         * @brief Intersects a ray with a box (slab test).
+         * @param box : The box.
+         * @param origin : The origin of the ray.
+         * @param direction : The normalized direction of the ray.
+         * @param maxDistance : The length of the ray.
+         * @param distance : Receives the distance of the entry point (0 if the origin is inside the box).
+         * @return True if the ray hits the box before maxDistance, false otherwise.
+        */
+        static bool intersectRay(const AABB& box, const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float& distance);
+
+        /**
+         * @brief Gets the height of the tree.
+         * @return The height (0 for a single leaf or an empty tree).
+        */
+        int32_t getHeight() const { return root == NULL_NODE ? 0 : nodes[root].height; }
+
+        /**
+         * @brief Gets the number of boxes in the tree.
+         * @return The number of boxes.
+        */
+        size_t getProxyCount() const { return proxyCount; }
+
+
+    private:
+        /**
+         * @brief Node of the tree, leaves have no children.
+        */
+        struct Node {
+            AABB box; /** @brief Fat box of a leaf, union of the children boxes otherwise. */
+            uint32_t userData = 0; /** @brief Value stored with a leaf. */
+            int32_t parent = NULL_NODE; /** @brief Parent node, or next free node when the node is in the free list. */
+            int32_t child1 = NULL_NODE; /** @brief First child. */
+            int32_t child2 = NULL_NODE; /** @brief Second child. */
+            int32_t height = -1; /** @brief Height of the subtree (0 for a leaf, -1 for a free node). */
+
+            /**
+             * @brief Checks if the node is a leaf.
+             * @return True if the node has no children, false otherwise.
+            */
+            bool isLeaf() const { return child1 == NULL_NODE; }
+        };
+
+        /**
+         * @brief Takes a node from the free list, growing the node array if needed.
+         * @return The index of the node.
+        */
+        int32_t allocateNode();
+
+        /**
+         * @brief Gives a node back to the free list.
+         * @param node : The index of the node.
+        */
+        void freeNode(int32_t node);
+
+        /**
+         * @brief Inserts a leaf next to the sibling that minimizes the surface area of the tree.
+         * @param leaf : The index of the leaf.
+        */
+        void insertLeaf(int32_t leaf);
+
+        /**
+         * @brief Detaches a leaf from the tree (the leaf node is kept).
+         * @param leaf : The index of the leaf.
+        */
+        void removeLeaf(int32_t leaf);
+
+        /**
+         * @brief Rotates a subtree if its children heights differ by more than one.
+         * @param index : The root of the subtree.
+         * @return The new root of the subtree.
+        */
+        int32_t balance(int32_t index);
+
+        /**
+         * @brief Recomputes the boxes and heights from a node up to the root, balancing on the way.
+         * @param index : The first node to update.
+        */
+        void refitAncestors(int32_t index);
+
+
+
+        // ----------------- Variable -----------------
+        std::vector<Node> nodes{}; /** @brief Nodes of the tree, indexed by node (and proxy) ID. */
+        int32_t root = NULL_NODE; /** @brief Root node. */
+        int32_t freeList = NULL_NODE; /** @brief First free node. */
+        size_t proxyCount = 0; /** @brief Number of leaves. */
+        float margin; /** @brief Enlargement of the boxes stored in the leaves. */
+        mutable std::vector<int32_t> stack{}; /** @brief Traversal stack reused by the queries. */
+    };
+}  // namespace lve
@@ -0,0 +1,25 @@
+#pragma once
+
+//std
+#include <cstddef>
+#include <string>
+
+namespace lve {
+    /**
+     * @brief Runs a CPU micro-benchmark and prints its results on the standard output.
+     * Available benchmarks :
+     * - transforms : batched SIMD model/normal matrices versus the scalar path.
+     * - broadphase : sweep and prune versus the all-pairs AABB test.
+     * - aabbtree : AABB tree box, sphere, ray and frustum queries versus linear scans.
+     * - lights : clustered light assignment for a growing number of lights (count is the largest one), lights shaded per fragment versus all of them.
+     * - objimport : multithreaded corner building and deduplication of LveObjLoader versus the std::unordered_map import, on a generated OBJ of count triangles.
+     * - meshopt : ACMR and ATVR of a grid of count triangles in row order and in random order, before and after LveMeshOptimizer.
+     * - vertexformat : LveVertexQuantizer on count random vertices, time and worst decoding error of each attribute.
+     * - meshlets : LveMeshletBuilder on a sphere of count triangles, meshlet sizes and frustum and normal cone culling for a camera seeing part of it.
+     * - lod : LveMeshSimplifier on a sphere of count triangles, triangles and error of each level and the level picked for a camera moving away.
+     * @param name : The name of the benchmark.
+     * @param count : The number of elements processed per iteration (0 for the benchmark default).
+     * @return EXIT_SUCCESS if the benchmark ran, EXIT_FAILURE if the name is unknown or the results do not match the reference.
+    */
+    int runBenchmark(const std::string& name, size_t count);
+}  // namespace lve
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "AABB.hpp"
+
+//std
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace lve {
+    /**
+     * @brief Broad phase of the collision detection using sweep and prune on the X axis.
+     * The proxies stay sorted between two calls of findPairs, so the insertion sort only moves the boxes that crossed another one (almost linear for coherent motion).
+    */
+    class LveBroadPhase {
+    public:
+        using PairCallback = std::function<void(uint32_t userDataA, uint32_t userDataB)>; /** @brief Narrow phase called for each overlapping pair. */
+
+        /**
+         * @brief Adds a box to the broad phase.
+         * @param box : The bounding box.
+         * @param userData : Value given back to the pair callback (usually an entity ID).
+         * @return The proxy identifying the box.
+        */
+        uint32_t insert(const AABB& box, uint32_t userData);
+
+        /**
+         * @brief Removes a box from the broad phase.
+         * @param proxy : The proxy returned by insert.
+        */
+        void remove(uint32_t proxy);
+
+        /**
+         * @brief Moves a box.
+         * @param proxy : The proxy returned by insert.
+         * @param box : The new bounding box.
+        */
+        void update(uint32_t proxy, const AABB& box);
+
+        /**
+         * @brief Finds every pair of overlapping boxes and calls the narrow phase for each one.
+         * @param callback : Function called once per overlapping pair.
+        */
+        void findPairs(const PairCallback& callback);
+
+        /**
+         * @brief Gets the number of boxes in the broad phase.
+         * @return The number of boxes.
+        */
+        size_t getProxyCount() const { return sortedProxies.size(); }
+
+
+    private:
+        /**
+         * @brief Box stored in the broad phase.
+        */
+        struct Proxy {
+            AABB box; /** @brief Bounding box. */
+            uint32_t userData; /** @brief Value given back to the pair callback. */
+        };
+
+
+
+        // ----------------- Variable -----------------
+        std::vector<Proxy> proxies{}; /** @brief Proxies, indexed by proxy ID. */
+        std::vector<uint32_t> freeProxies{}; /** @brief Removed proxy IDs, reused by insert. */
+        std::vector<uint32_t> sortedProxies{}; /** @brief Proxies sorted on box.minX. */
+        std::vector<uint32_t> activeProxies{}; /** @brief Proxies overlapping the sweep position on X (reused between calls). */
+    };
+}  // namespace lve
@@ -28,8 +28,8 @@ namespace lve {
         LveBuffer& operator=(const LveBuffer&) = delete;
 
         /**
-         * @brief Maps the buffer memory.
-         * @param size : The size of the memory to map.
+         * @brief Maps a range of the buffer memory, getMappedMemory() then points to its start.
+         * @param size : The size of the memory to map (VK_WHOLE_SIZE for the rest of the buffer).
          * @param offset : The offset from the beginning of the buffer.
          * @return Result of the memory mapping operation.
         */
@@ -43,8 +43,8 @@ namespace lve {
         /**
          * @brief Writes data to the buffer.
          * @param data : The data to be written.
-         * @param size : The size of the data to be written.
-         * @param offset : The offset from the beginning of the buffer.
+         * @param size : The size of the data to be written (VK_WHOLE_SIZE for the whole mapped range).
+         * @param offset : The offset from the beginning of the mapped range.
         */
         void writeToBuffer(void* data, VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
         
@@ -163,8 +163,9 @@ namespace lve {
         // ----------------- Variable -----------------
         LveDevice& lveDevice; /** @brief Vulkan logical device. */
         void* mapped = nullptr; /** @brief Pointer to the mapped memory. */
+        VkDeviceSize mappedSize = 0; /** @brief Size of the mapped range. */
         VkBuffer buffer = VK_NULL_HANDLE; /** @brief Vulkan buffer handle. */
-        VkDeviceMemory memory = VK_NULL_HANDLE; /** @brief Vulkan device memory handle. */
+        LveAllocation memory{}; /** @brief Part of a device memory block bound to the buffer. */
 
         VkDeviceSize bufferSize; /** @brief Total size of the buffer. */
         uint32_t instanceCount; /** @brief Number of instances in the buffer. */
@@ -78,6 +78,14 @@ namespace lve {
         */
         glm::vec3 getPosition() const { return glm::vec3(inverseViewMatrix[3]); }
 
+        /**
+         * @brief Projects a length on the screen, for both projections (the perspective divides it by the depth).
+         * @param size : The length, in world units.
+         * @param position : The world position where the length is measured.
+         * @return The projected length as a fraction of the viewport height (the float maximum for a position on or behind the camera plane).
+        */
+        float getProjectedSize(float size, const glm::vec3& position) const;
+
 
     private:
         // ----------------- Variable -----------------
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "lve_frame_info.hpp"
+
+//libs
+#include <glm/glm.hpp>
+
+//std
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+    /**
+     * @brief Clustered forward lighting : the view frustum is split in screen tiles and exponential depth slices, and each cluster keeps the list of the lights whose sphere touches it.
+     * The fragment shader only loops over the lights of its cluster, so the shading cost depends on the local light density instead of the total number of lights.
+     * The grid is built on the CPU, with a conservative screen space box per light and depth slice (a light may be listed in a few clusters it does not touch, never the opposite).
+    */
+    class LveClusterGrid {
+    public:
+        static constexpr uint32_t TILES_X = 16; /** @brief Number of screen tiles on X. */
+        static constexpr uint32_t TILES_Y = 9; /** @brief Number of screen tiles on Y. */
+        static constexpr uint32_t SLICES = 24; /** @brief Number of depth slices between the near and far planes. */
+        static constexpr uint32_t CLUSTER_COUNT = TILES_X * TILES_Y * SLICES; /** @brief Total number of clusters. */
+        static constexpr float LIGHT_CUTOFF = 0.01f; /** @brief Light intensity under which a light is ignored, gives the range of the lights. */
+
+        /**
+         * @brief Computes the distance at which the intensity of a light falls under LIGHT_CUTOFF.
+         * @param color : The color of the light (w component is intensity).
+         * @return The range of the light.
+        */
+        static float computeLightRange(const glm::vec4& color);
+
+        /**
+         * @brief Gets the index of a cluster in the cluster array.
+         * @param x : The tile on X.
+         * @param y : The tile on Y.
+         * @param slice : The depth slice.
+         * @return The index of the cluster.
+        */
+        static uint32_t getClusterIndex(uint32_t x, uint32_t y, uint32_t slice) { return (slice * TILES_Y + y) * TILES_X + x; }
+
+        /**
+         * @brief Assigns the lights to the clusters.
+         * @param view : The view matrix of the camera.
+         * @param projection : The perspective projection of the camera (depth from 0 to 1, like LveCamera::setPerspectiveProjection).
+         * @param lights : The lights, in world space (position.w is the range given by computeLightRange).
+        */
+        void build(const glm::mat4& view, const glm::mat4& projection, const std::vector<PointLight>& lights);
+
+        /**
+         * @brief Gets the depth slice of a view space depth, with the same formula as the fragment shader.
+         * @param viewDepth : The depth in view space.
+         * @return The depth slice.
+        */
+        uint32_t getSlice(float viewDepth) const;
+
+        /**
+         * @brief Gets the light range of every cluster.
+         * @return The offset in the light index list (x) and the number of lights (y) of each cluster.
+        */
+        const std::vector<glm::uvec2>& getClusters() const { return clusters; }
+
+        /**
+         * @brief Gets the lights of every cluster, one after the other.
+         * @return The light index list.
+        */
+        const std::vector<uint32_t>& getLightIndices() const { return lightIndices; }
+
+        /**
+         * @brief Gets the scale and bias turning log(view depth) into a depth slice.
+         * @return The scale (x) and bias (y).
+        */
+        glm::vec2 getSliceScaleBias() const { return { sliceScale, sliceBias }; }
+
+
+    private:
+        /**
+         * @brief Clusters of one depth slice touched by a light.
+        */
+        struct LightBounds {
+            uint32_t light; /** @brief Index of the light. */
+            uint8_t slice; /** @brief Depth slice. */
+            uint8_t minX, maxX; /** @brief Tile range on X. */
+            uint8_t minY, maxY; /** @brief Tile range on Y. */
+        };
+
+        /**
+         * @brief Adds the clusters touched by a light to lightBounds, one entry per depth slice.
+         * @param view : The view matrix of the camera.
+         * @param projection : The projection matrix of the camera.
+         * @param lightIndex : The index of the light.
+         * @param light : The light.
+        */
+        void addLightBounds(const glm::mat4& view, const glm::mat4& projection, uint32_t lightIndex, const PointLight& light);
+
+
+
+        // ----------------- Variable -----------------
+        std::vector<glm::uvec2> clusters = std::vector<glm::uvec2>(CLUSTER_COUNT, glm::uvec2{ 0 }); /** @brief Offset and light count of each cluster. */
+        std::vector<uint32_t> lightIndices{}; /** @brief Lights of every cluster, one after the other. */
+        std::vector<LightBounds> lightBounds{}; /** @brief Clusters touched by each visible light, per depth slice (reused between builds). */
+        std::array<float, SLICES + 1> sliceDepths{}; /** @brief View space depth of the limits of the depth slices. */
+        float nearPlane = 0.1f; /** @brief Near plane extracted from the projection. */
+        float farPlane = 100.f; /** @brief Far plane extracted from the projection. */
+        float sliceScale = 0.f; /** @brief SLICES / log(far / near). */
+        float sliceBias = 0.f; /** @brief -SLICES * log(near) / log(far / near). */
+    };
+}  // namespace lve
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "lve_device.hpp"
+
+//std
+#include <string>
+
+namespace lve {
+    /**
+     * @brief Represents a Vulkan compute pipeline.
+    */
+    class LveComputePipeline {
+    public:
+        /**
+         * @brief Constructs an LveComputePipeline.
+         * @param device : The LveDevice reference.
+         * @param compFilePath : The path to the compute shader file.
+         * @param pipelineLayout : The pipeline layout (descriptor sets and push constants used by the shader).
+        */
+        LveComputePipeline(LveDevice& device, const std::string& compFilePath, VkPipelineLayout pipelineLayout);
+
+        /**
+         * @brief Destructor to release associated resources.
+        */
+        ~LveComputePipeline();
+
+        LveComputePipeline(const LveComputePipeline&) = delete;
+        LveComputePipeline& operator=(const LveComputePipeline&) = delete;
+
+        /**
+         * @brief Binds the compute pipeline to the specified Vulkan command buffer.
+         * @param commandBuffer : The Vulkan command buffer.
+        */
+        void bind(VkCommandBuffer commandBuffer);
+
+
+    private:
+        // ----------------- Variable -----------------
+        LveDevice& lveDevice; /** @brief Reference to the LveDevice. */
+        VkPipeline computePipeline; /** @brief Vulkan compute pipeline. */
+        VkShaderModule compShaderModule; /** @brief Compute shader module. */
+    };
+}  // namespace lve
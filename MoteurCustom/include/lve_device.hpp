@@ -1,13 +1,21 @@
 #pragma once
 
 #include "lve_window.hpp"
+#include "lve_memory_allocator.hpp"
 
 // std lib headers
+#include <array>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <vulkan/vulkan.h>
 
 namespace lve {
+    class LveUploadQueue;
+    class LveGeometryPool;
+    class LvePipelineRegistry;
+
     /**
      * @brief Structure holding details about swap chain support.
     */
@@ -23,6 +31,8 @@ namespace lve {
     struct QueueFamilyIndices {
         uint32_t graphicsFamily = 0; /** @brief Index of the graphics queue family. */
         uint32_t presentFamily = 0; /** @brief Index of the presentation queue family. */
+        uint32_t transferFamily = 0; /** @brief Index of the queue family of the uploads (a transfer only family when the device has one, the graphics family otherwise). */
+        uint32_t transferQueueIndex = 0; /** @brief Index of the upload queue in its family (1 when it is a second queue of the graphics family). */
         bool graphicsFamilyHasValue = false; /** @brief Flag indicating if graphics family index is valid. */
         bool presentFamilyHasValue = false; /** @brief Flag indicating if presentation family index is valid. */
 
@@ -43,6 +53,7 @@ namespace lve {
         #else
             const bool enableValidationLayers = true; /** @brief Enable Vulkan validation layers flag (Debug mode). */
         #endif
+        static constexpr size_t QUEUE_MUTEX_COUNT = 3; /** @brief One mutex per distinct queue among the graphics, present and transfer queues. */
 
         /**
          * @brief Constructor for LveDevice.
@@ -90,6 +101,12 @@ namespace lve {
         */
         VkSurfaceKHR getSurface() const { return surface_; }
 
+        /**
+         * @brief Check if the device runs without a presentation surface.
+         * @return True if the device is headless, false otherwise.
+        */
+        bool isHeadless() const { return window.isHeadless(); }
+
         /**
          * @brief Get Vulkan graphics queue.
          * @return Vulkan graphics queue handle.
@@ -102,12 +119,85 @@ namespace lve {
         */
         VkQueue getPresentQueue() const { return presentQueue_; }
 
+        /**
+         * @brief Get the queue receiving the uploads (the graphics queue itself if the device has no other queue).
+         * @return Vulkan transfer queue handle.
+        */
+        VkQueue getTransferQueue() const { return transferQueue_; }
+
+        /**
+         * @brief Get the queue family of the transfer queue.
+         * @return Transfer queue family index.
+        */
+        uint32_t getTransferQueueFamily() const { return transferFamily_; }
+
+        /**
+         * @brief Lock a queue for a vkQueueSubmit, vkQueuePresentKHR or vkQueueWaitIdle, Vulkan requires the calls on one VkQueue to be externally synchronized.
+         * The graphics, present and transfer queues share the same mutex when they are the same VkQueue.
+         * @param queue : The graphics, present or transfer queue.
+         * @return The lock, to hold until the call returns.
+        */
+        std::unique_lock<std::mutex> lockQueue(VkQueue queue);
+
+        /**
+         * @brief Lock every queue, for the calls synchronizing them all (vkDeviceWaitIdle).
+         * @return The locks, to hold until the call returns.
+        */
+        std::array<std::unique_lock<std::mutex>, QUEUE_MUTEX_COUNT> lockQueues();
+
+        /**
+         * @brief Wait for the device to be idle, with every queue locked so that no other thread submits meanwhile.
+        */
+        void waitIdle();
+
         /**
          * @brief Get graphics queue family index.
          * @return Graphics queue family index.
         */
         static uint32_t getGraphicsQueueFamily() { QueueFamilyIndices indice; return indice.graphicsFamily; }
 
+        /**
+         * @brief Get the device memory sub-allocator used by the buffers and images.
+         * @return The memory allocator.
+        */
+        LveMemoryAllocator& getAllocator() const { return *allocator; }
+
+        /**
+         * @brief Get the queue uploading data to the device local buffers without waiting.
+         * @return The upload queue.
+        */
+        LveUploadQueue& getUploadQueue() const { return *uploadQueue; }
+
+        /**
+         * @brief Get the shared vertex and index buffers of the models.
+         * @return The geometry pool.
+        */
+        LveGeometryPool& getGeometryPool() const { return *geometryPool; }
+
+        /**
+         * @brief Get the registry sharing the graphics pipelines and their shader modules.
+         * @return The pipeline registry.
+        */
+        LvePipelineRegistry& getPipelineRegistry() const { return *pipelineRegistry; }
+
+        /**
+         * @brief Check if one indirect draw call can read several draw commands (multiDrawIndirect is enabled when the device supports it).
+         * @return True if vkCmdDrawIndexedIndirect accepts a drawCount above 1.
+        */
+        bool supportsMultiDrawIndirect() const { return multiDrawIndirect_; }
+
+        /**
+         * @brief Get the pipeline cache given to every pipeline creation, loaded from PIPELINE_CACHE_PATH and written back by the destructor.
+         * @return Vulkan pipeline cache handle.
+        */
+        VkPipelineCache getPipelineCache() const { return pipelineCache_; }
+
+        /**
+         * @brief Write the content of the pipeline cache to PIPELINE_CACHE_PATH, through a temporary file so that a crash never leaves a truncated cache.
+         * @return True if the file was written.
+        */
+        bool savePipelineCache();
+
         /**
          * @brief Get details about swap chain support.
          * @return SwapChainSupportDetails structure.
@@ -138,14 +228,14 @@ namespace lve {
         VkFormat findSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 
         /**
-         * @brief Create a Vulkan buffer.
+         * @brief Create a Vulkan buffer (shared with the transfer queue family when it is a transfer destination).
          * @param size : Size of the buffer.
          * @param usage : Buffer usage flags.
          * @param properties : Memory properties flags.
          * @param buffer : Output parameter for Vulkan buffer handle.
-         * @param bufferMemory : Output parameter for Vulkan buffer memory handle.
+         * @param bufferMemory : Output parameter for the part of a memory block bound to the buffer (give it back with getAllocator().free).
         */
-        void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
+        void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, LveAllocation& bufferMemory);
         
         /**
          * @brief Begin a single time command.
@@ -182,13 +272,14 @@ namespace lve {
          * @param imageInfo : Vulkan image creation information.
          * @param properties : Memory properties flags.
          * @param image : Output parameter for Vulkan image handle.
-         * @param imageMemory : Output parameter for Vulkan image memory handle.
+         * @param imageMemory : Output parameter for the part of a memory block bound to the image (give it back with getAllocator().free).
         */
-        void createImageWithInfo(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
+        void createImageWithInfo(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties, VkImage& image, LveAllocation& imageMemory);
 
 
 
         // ----------------- Variable -----------------
+        static constexpr const char* PIPELINE_CACHE_PATH = "pipeline.cache"; /** @brief File of the pipeline cache, next to the shaders folder. */
         VkPhysicalDeviceProperties properties; /** @brief Vulkan physical device properties. */
 
 
@@ -223,6 +314,19 @@ namespace lve {
         */
         void createCommandPool();
 
+        /**
+         * @brief Create the pipeline cache, filled with PIPELINE_CACHE_PATH if the file was written by the same driver and device.
+        */
+        void createPipelineCache();
+
+        /**
+         * @brief Check that pipeline cache data was written by this driver and device (a driver may crash on the data of another one).
+         * @param data : The pipeline cache data, starting with its header.
+         * @param size : The size of the data.
+         * @return True if the header matches the device.
+        */
+        bool isPipelineCacheCompatible(const char* data, size_t size) const;
+
         /**
          * @brief Check if the physical device is suitable for the application.
          * @param device : Vulkan physical device handle.
@@ -236,6 +340,12 @@ namespace lve {
         */
         std::vector<const char*> getRequiredExtensions();
 
+        /**
+         * @brief Get the list of required Vulkan device extensions (none when headless).
+         * @return List of required device extensions.
+        */
+        std::vector<const char*> getRequiredDeviceExtensions();
+
         /**
          * @brief Check if the required validation layers are supported.
          * @return True if all validation layers are supported, false otherwise.
@@ -282,11 +392,21 @@ namespace lve {
         VkPhysicalDevice physicalDevice = VK_NULL_HANDLE; /** @brief Vulkan physical device handle. */
         LveWindow& window; /** @brief Reference to the LveWindow instance. */
         VkCommandPool commandPool; /** @brief Vulkan command pool handle. */
+        VkPipelineCache pipelineCache_ = VK_NULL_HANDLE; /** @brief Vulkan pipeline cache handle shared by every pipeline. */
 
         VkDevice device_; /** @brief Vulkan logical device handle. */
-        VkSurfaceKHR surface_; /** @brief Vulkan surface handle. */
+        VkSurfaceKHR surface_ = VK_NULL_HANDLE; /** @brief Vulkan surface handle (VK_NULL_HANDLE when headless). */
         VkQueue graphicsQueue_; /** @brief Vulkan graphics queue handle. */
         VkQueue presentQueue_; /** @brief Vulkan presentation queue handle. */
+        VkQueue transferQueue_; /** @brief Vulkan queue handle of the uploads. */
+        uint32_t graphicsFamily_ = 0; /** @brief Index of the graphics queue family. */
+        uint32_t transferFamily_ = 0; /** @brief Index of the transfer queue family. */
+        std::array<std::mutex, QUEUE_MUTEX_COUNT> queueMutexes_; /** @brief Mutex of the graphics queue, of the present queue and of the transfer queue, when they are distinct VkQueues. */
+        std::unique_ptr<LveMemoryAllocator> allocator; /** @brief Sub-allocator of the device memory. */
+        std::unique_ptr<LveUploadQueue> uploadQueue; /** @brief Staging ring and batched copies of the uploads. */
+        std::unique_ptr<LveGeometryPool> geometryPool; /** @brief Shared vertex and index buffers of the models. */
+        std::unique_ptr<LvePipelineRegistry> pipelineRegistry; /** @brief Shared graphics pipelines and shader modules. */
+        bool multiDrawIndirect_ = false; /** @brief True if the multiDrawIndirect feature is enabled. */
 
         const std::vector<const char*> validationLayers = { "VK_LAYER_KHRONOS_validation" }; /** @brief List of validation layers to enable. */
         const std::vector<const char*> deviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME }; /** @brief List of required device extensions. */
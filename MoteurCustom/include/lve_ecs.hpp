@@ -0,0 +1,267 @@
+#pragma once
+
+//std
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace lve {
+    using entity_t = uint32_t; /** @brief Type alias for an entity identifier. */
+
+    /**
+     * @brief Type-erased interface of a component pool, used by the registry to destroy entities.
+    */
+    class LveComponentPoolBase {
+    public:
+        virtual ~LveComponentPoolBase() = default;
+
+        /**
+         * @brief Checks if an entity owns a component in this pool.
+         * @param entity : The entity.
+         * @return True if the entity has the component, false otherwise.
+        */
+        virtual bool has(entity_t entity) const = 0;
+
+        /**
+         * @brief Removes the component of an entity (does nothing if the entity has none).
+         * @param entity : The entity.
+        */
+        virtual void remove(entity_t entity) = 0;
+    };
+
+    /**
+     * @brief Sparse set storing the components of one type in a dense, contiguous array.
+     * The sparse array maps an entity to its index in the dense arrays, removals swap the last component into the hole.
+     * References to components are invalidated when a component of the same type is added or removed.
+     * @tparam T : The component type.
+    */
+    template <typename T>
+    class LveComponentPool : public LveComponentPoolBase {
+    public:
+        static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max(); /** @brief Sparse value of entities without the component. */
+
+        /**
+         * @brief Adds a component to an entity (the entity must not have one yet).
+         * @param entity : The entity.
+         * @param ...args : Arguments used to brace-initialize the component.
+         * @return Reference to the new component.
+        */
+        template <typename... Args>
+        T& emplace(entity_t entity, Args&&... args) {
+            assert(!has(entity) && "Entity already has this component");
+            if (entity >= sparse.size()) {
+                sparse.resize(static_cast<size_t>(entity) + 1, INVALID_INDEX);
+            }
+            sparse[entity] = static_cast<uint32_t>(dense.size());
+            dense.push_back(entity);
+            components.push_back(T{ std::forward<Args>(args)... });
+            return components.back();
+        }
+
+        /**
+         * @brief Removes the component of an entity (does nothing if the entity has none).
+         * @param entity : The entity.
+        */
+        void remove(entity_t entity) override {
+            if (!has(entity)) {
+                return;
+            }
+            uint32_t index = sparse[entity];
+            entity_t last = dense.back();
+            dense[index] = last;
+            components[index] = std::move(components.back());
+            sparse[last] = index;
+            sparse[entity] = INVALID_INDEX;
+            dense.pop_back();
+            components.pop_back();
+        }
+
+        /**
+         * @brief Checks if an entity owns a component in this pool.
+         * @param entity : The entity.
+         * @return True if the entity has the component, false otherwise.
+        */
+        bool has(entity_t entity) const override { return entity < sparse.size() && sparse[entity] != INVALID_INDEX; }
+
+        /**
+         * @brief Gets the component of an entity (the entity must have one).
+         * @param entity : The entity.
+         * @return Reference to the component.
+        */
+        T& get(entity_t entity) { assert(has(entity) && "Entity does not have this component"); return components[sparse[entity]]; }
+
+        /**
+         * @brief Gets the component of an entity if it has one.
+         * @param entity : The entity.
+         * @return Pointer to the component, nullptr if the entity has none.
+        */
+        T* tryGet(entity_t entity) { return has(entity) ? &components[sparse[entity]] : nullptr; }
+
+        /**
+         * @brief Gets the index of an entity's component in the dense arrays.
+         * @param entity : The entity.
+         * @return The dense index, INVALID_INDEX if the entity has no component.
+        */
+        uint32_t indexOf(entity_t entity) const { return has(entity) ? sparse[entity] : INVALID_INDEX; }
+
+        /**
+         * @brief Gets the number of components in the pool.
+         * @return The number of components.
+        */
+        size_t size() const { return dense.size(); }
+
+        /**
+         * @brief Gets the entities owning a component, in the same order as the components.
+         * @return The dense array of entities.
+        */
+        const std::vector<entity_t>& entities() const { return dense; }
+
+        /**
+         * @brief Gets the contiguous array of components.
+         * @return The dense array of components.
+        */
+        std::vector<T>& data() { return components; }
+
+
+    private:
+        // ----------------- Variable -----------------
+        std::vector<uint32_t> sparse{}; /** @brief Index in the dense arrays of every entity (INVALID_INDEX if absent). */
+        std::vector<entity_t> dense{}; /** @brief Entities owning a component. */
+        std::vector<T> components{}; /** @brief Components, stored contiguously. */
+    };
+
+    /**
+     * @brief Owns the entities and one component pool per component type.
+     * Systems iterate the dense pools directly or through each(), which only visits the entities owning every requested component.
+    */
+    class LveRegistry {
+    public:
+        LveRegistry() = default;
+        LveRegistry(const LveRegistry&) = delete;
+        LveRegistry& operator=(const LveRegistry&) = delete;
+
+        /**
+         * @brief Creates a new entity with a unique identifier (identifiers are never reused).
+         * @return The new entity.
+        */
+        entity_t create() { return nextEntity++; }
+
+        /**
+         * @brief Destroys an entity by removing all its components.
+         * @param entity : The entity to destroy.
+        */
+        void destroy(entity_t entity) {
+            for (auto& pool : pools) {
+                if (pool != nullptr) {
+                    pool->remove(entity);
+                }
+            }
+        }
+
+        /**
+         * @brief Adds a component to an entity.
+         * @tparam T : The component type.
+         * @param entity : The entity.
+         * @param ...args : Arguments used to brace-initialize the component.
+         * @return Reference to the new component.
+        */
+        template <typename T, typename... Args>
+        T& emplace(entity_t entity, Args&&... args) { return pool<T>().emplace(entity, std::forward<Args>(args)...); }
+
+        /**
+         * @brief Removes a component from an entity.
+         * @tparam T : The component type.
+         * @param entity : The entity.
+        */
+        template <typename T>
+        void remove(entity_t entity) { pool<T>().remove(entity); }
+
+        /**
+         * @brief Checks if an entity has a component.
+         * @tparam T : The component type.
+         * @param entity : The entity.
+         * @return True if the entity has the component, false otherwise.
+        */
+        template <typename T>
+        bool has(entity_t entity) { return pool<T>().has(entity); }
+
+        /**
+         * @brief Gets a component of an entity (the entity must have it).
+         * @tparam T : The component type.
+         * @param entity : The entity.
+         * @return Reference to the component.
+        */
+        template <typename T>
+        T& get(entity_t entity) { return pool<T>().get(entity); }
+
+        /**
+         * @brief Gets a component of an entity if it has one.
+         * @tparam T : The component type.
+         * @param entity : The entity.
+         * @return Pointer to the component, nullptr if the entity has none.
+        */
+        template <typename T>
+        T* tryGet(entity_t entity) { return pool<T>().tryGet(entity); }
+
+        /**
+         * @brief Gets the pool of a component type, creating it on first use.
+         * @tparam T : The component type.
+         * @return Reference to the pool.
+        */
+        template <typename T>
+        LveComponentPool<T>& pool() {
+            size_t typeId = componentTypeId<T>();
+            if (typeId >= pools.size()) {
+                pools.resize(typeId + 1);
+            }
+            if (pools[typeId] == nullptr) {
+                pools[typeId] = std::make_unique<LveComponentPool<T>>();
+            }
+            return static_cast<LveComponentPool<T>&>(*pools[typeId]);
+        }
+
+        /**
+         * @brief Calls a function for every entity owning all the requested components.
+         * The pool of the first component drives the iteration in dense order, so it should be the rarest one.
+         * Components must not be added or removed from the visited pools inside the function.
+         * @tparam T : The component type driving the iteration.
+         * @tparam ...Rest : The other required component types.
+         * @param fn : Function called as fn(entity, T&, Rest&...).
+        */
+        template <typename T, typename... Rest, typename Fn>
+        void each(Fn&& fn) {
+            auto& driver = pool<T>();
+            auto& entities = driver.entities();
+            auto& components = driver.data();
+            for (size_t i = 0; i < entities.size(); i++) {
+                entity_t entity = entities[i];
+                if ((has<Rest>(entity) && ...)) {
+                    fn(entity, components[i], get<Rest>(entity)...);
+                }
+            }
+        }
+
+
+    private:
+        /**
+         * @brief Gets a unique index for every component type.
+         * @tparam T : The component type.
+         * @return The index of the component type.
+        */
+        template <typename T>
+        static size_t componentTypeId() {
+            static const size_t typeId = nextComponentTypeId++;
+            return typeId;
+        }
+
+
+
+        // ----------------- Variable -----------------
+        inline static size_t nextComponentTypeId = 0; /** @brief Next index given to a component type. */
+        std::vector<std::unique_ptr<LveComponentPoolBase>> pools{}; /** @brief Component pools, indexed by component type. */
+        entity_t nextEntity = 0; /** @brief Identifier of the next created entity. */
+    };
+}  // namespace lve
@@ -7,14 +7,11 @@
 #include <vulkan/vulkan.h>
 
 namespace lve {
-
-#define MAX_LIGHTS 10
-
     /**
      * @brief Structure representing a point light source in 3D space.
     */
     struct PointLight {
-        glm::vec4 position{}; /** @brief Position of the point light (ignore w component). */
+        glm::vec4 position{}; /** @brief Position of the point light (w component is range). */
         glm::vec4 color{}; /** @brief Color of the point light (w component is intensity). */
     };
 
@@ -26,8 +23,9 @@ namespace lve {
         glm::mat4 view{ 1.f }; /** @brief View matrix. */
         glm::mat4 inverseView{ 1.f }; /** @brief Inverse view matrix. */
         glm::vec4 ambientLightColor{ 1.f, 1.f, 1.f, .02f }; /** @brief Ambient light color (w component is intensity). */
-        PointLight pointLights[MAX_LIGHTS]; /** @brief Array of point lights. */
-        int numLights; /** @brief Number of active point lights. */
+        glm::vec4 clusterParams{ 0.f }; /** @brief Tile size in pixels (xy), scale (z) and bias (w) turning log(view depth) into a depth slice. */
+        glm::uvec4 clusterGrid{ 0 }; /** @brief Number of tiles on X (x) and Y (y) and of depth slices (z) of the light clusters. */
+        int numLights = 0; /** @brief Number of active point lights (the lights themselves are in the storage buffers of LveLightClusters). */
     };
     
     /**
@@ -39,6 +37,6 @@ namespace lve {
         VkCommandBuffer commandBuffer; /** @brief Vulkan command buffer for rendering commands. */
         LveCamera& camera; /** @brief Reference to the camera used for rendering. */
         VkDescriptorSet globalDescriptorSet; /** @brief Vulkan descriptor set for global UBO binding. */
-        LveGameObject::Map& gameObjects; /** @brief Reference to the map of game objects in the scene. */
+        LveRegistry& registry; /** @brief Reference to the registry holding the components of the scene. */
     };
 }  // namespace lve
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "AABB.hpp"
+
+//libs
+#include <glm/glm.hpp>
+
+//std
+#include <array>
+
+namespace lve {
+    /**
+     * @brief View frustum made of six planes, extracted from a projection * view matrix.
+     * The planes point inside the frustum, the depth range is [0, 1] (GLM_FORCE_DEPTH_ZERO_TO_ONE).
+    */
+    class LveFrustum {
+    public:
+        /**
+         * @brief Constructor for a frustum that contains everything.
+        */
+        LveFrustum();
+
+        /**
+         * @brief Constructor extracting the planes of a projection * view matrix.
+         * @param viewProjection : The projection * view matrix of the camera.
+        */
+        explicit LveFrustum(const glm::mat4& viewProjection);
+
+        /**
+         * @brief Checks if a box is at least partly inside the frustum.
+         * The test is conservative : a box outside the frustum but crossing the planes near a corner is reported as visible.
+         * @param box : The box in the space of the matrix (world space for projection * view).
+         * @return True if the box may be visible, false if it is fully outside one plane.
+        */
+        bool intersectsAABB(const AABB& box) const;
+
+        /**
+         * @brief Checks if a sphere is at least partly inside the frustum, with the same conservative test as intersectsAABB.
+         * @param center : The center of the sphere in the space of the matrix (model space for projection * view * model).
+         * @param radius : The radius of the sphere.
+         * @return True if the sphere may be visible, false if it is fully outside one plane.
+        */
+        bool intersectsSphere(const glm::vec3& center, float radius) const;
+
+        /**
+         * @brief Gets the planes of the frustum, to upload them to a shader.
+         * @return The left, right, bottom, top, near and far planes (normal in xyz, distance in w).
+        */
+        const std::array<glm::vec4, 6>& getPlanes() const { return planes; }
+
+        /**
+         * @brief Computes the box enclosing a transformed box.
+         * @param box : The box in local space.
+         * @param matrix : The transform matrix (model matrix).
+         * @return The box in the transformed space.
+        */
+        static AABB transformAABB(const AABB& box, const glm::mat4& matrix);
+
+
+    private:
+        // ----------------- Variable -----------------
+        std::array<glm::vec4, 6> planes; /** @brief Left, right, bottom, top, near and far planes (normal in xyz, distance in w). */
+    };
+}  // namespace lve
@@ -1,22 +1,22 @@
 #pragma once
 
+#include "lve_ecs.hpp"
 #include "lve_model.hpp"
+#include "lve_transform_batch.hpp"
 //libs
 #include "glm/gtc/matrix_transform.hpp"
 #include "Colision.hpp"
 
 //Std
 #include <memory>
-#include <unordered_map>
 
 namespace lve {
     /**
      * @brief Structure representing the transformation component of a game object.
+     * The simulation changes the current state once per fixed step, the object is drawn between the state of the previous step and the current one
+     * (see setInterpolation), so that its motion stays smooth whatever the frame rate.
     */
     struct TransformComponent {
-        glm::vec3 translation{}; /** @brief Translation vector. */
-        glm::vec3 scale{ 1.f,1.f,1.f }; /** @brief Scale vector. */
-        glm::vec3  rotation; /** @brief Rotation vector. */
         glm::vec3 vitesse{ 0.0f,0.0f,0.0f }; /** @brief Velocity vector. */
         glm::vec3 acceleration{ 0.0f,0.0f,0.0f }; /** @brief Acceleration vector. */
         float friction = 1.0f; /** @brief Friction coefficient. */
@@ -24,16 +24,78 @@ namespace lve {
         AABB colisionBox = AABB(); /** @brief Collision box. */
 
         /**
-         * @brief Generates a 4x4 transformation matrix based on translation, scale, and rotation.
+         * @brief Gets the 4x4 transformation matrix of the drawn state, between the previous and the current step.
+         * The matrix is cached and only recomputed after the transform changed.
          * @return The transformation matrix.
         */
-        glm::mat4 mat4();
+        const glm::mat4& mat4();
 
         /**
-         * @brief Generates a 3x3 normal matrix based on the inverse of the scale and rotation.
+         * @brief Gets the 3x3 normal matrix of the drawn state, based on the inverse of the scale and rotation.
+         * The matrix is cached and only recomputed after the transform changed.
          * @return The normal matrix.
         */
-        glm::mat3 normalMatrix();
+        const glm::mat3& normalMatrix();
+
+        /**
+         * @brief Gets the translation of the object.
+         * @return The translation vector.
+        */
+        const glm::vec3& getTranslation() const { return translation; }
+
+        /**
+         * @brief Gets the rotation of the object.
+         * @return The rotation vector.
+        */
+        const glm::vec3& getRotation() const { return rotation; }
+
+        /**
+         * @brief Gets the scale of the object.
+         * @return The scale vector.
+        */
+        const glm::vec3& getScale() const { return scale; }
+
+        /**
+         * @brief Gets the drawn translation, between the previous and the current step.
+         * @return The translation vector.
+        */
+        glm::vec3 getInterpolatedTranslation() const { return glm::mix(previousTranslation, translation, interpolation); }
+
+        /**
+         * @brief Gets the drawn rotation, between the previous and the current step (each angle turns the shorter way).
+         * @return The rotation vector.
+        */
+        glm::vec3 getInterpolatedRotation() const;
+
+        /**
+         * @brief Gets the drawn scale, between the previous and the current step.
+         * @return The scale vector.
+        */
+        glm::vec3 getInterpolatedScale() const { return glm::mix(previousScale, scale, interpolation); }
+
+        /**
+         * @brief Keeps the current state as the previous one, called before each simulation step.
+        */
+        void storePreviousState();
+
+        /**
+         * @brief Sets where the object is drawn between the previous and the current step.
+         * @param alpha : The fraction of a step elapsed since the current one (0 draws the previous state, 1 the current one).
+        */
+        void setInterpolation(float alpha);
+
+        /**
+         * @brief Checks if the cached matrices must be recomputed.
+         * @return True if the transform changed since the matrices were last computed, false otherwise.
+        */
+        bool isDirty() const { return dirty; }
+
+        /**
+         * @brief Stores matrices computed outside of the component (batched update) and clears the dirty flag.
+         * @param modelMatrix : The transformation matrix matching the drawn state.
+         * @param normalMatrix : The normal matrix matching the drawn state.
+        */
+        void setCachedMatrices(const glm::mat4& modelMatrix, const glm::mat3& normalMatrix);
 
         /**
          * @brief Sets the transformation with the provided translation and scale.
@@ -48,6 +110,18 @@ namespace lve {
         */
         void setTranslation(glm::vec3 translation);
 
+        /**
+         * @brief Sets the rotation of the object.
+         * @param rotation : The new rotation vector.
+        */
+        void setRotation(glm::vec3 rotation);
+
+        /**
+         * @brief Sets the scale of the object.
+         * @param scale : The new scale vector.
+        */
+        void setScale(glm::vec3 scale);
+
         /**
          * @brief Updates the position based on velocity.
         */
@@ -63,80 +137,150 @@ namespace lve {
          * @param box : The collision box.
         */
         void bouncingAABB(AABB box);
+
+
+    private:
+        /**
+         * @brief Recomputes the cached model and normal matrices.
+        */
+        void updateMatrices();
+
+        /**
+         * @brief Fits the collision box to the translation and scale.
+        */
+        void updateColisionBox();
+
+
+
+        // ----------------- Variable -----------------
+        glm::vec3 translation{}; /** @brief Translation vector. */
+        glm::vec3 scale{ 1.f,1.f,1.f }; /** @brief Scale vector. */
+        glm::vec3 rotation{}; /** @brief Rotation vector. */
+        glm::vec3 previousTranslation{}; /** @brief Translation at the previous step. */
+        glm::vec3 previousScale{ 1.f,1.f,1.f }; /** @brief Scale at the previous step. */
+        glm::vec3 previousRotation{}; /** @brief Rotation at the previous step. */
+        float interpolation = 1.f; /** @brief Fraction of the way from the previous to the current state that is drawn. */
+        glm::mat4 modelMatrix{ 1.f }; /** @brief Cached transformation matrix. */
+        glm::mat3 normalMat{ 1.f }; /** @brief Cached normal matrix. */
+        bool dirty = true; /** @brief True when the cached matrices are out of date. */
     };
 
     /**
      * @brief Structure representing the point light component of a game object.
+     * The light radius is stored in the scale of the transform component.
     */
     struct PointLightComponent {
         float lightIntensity = 1.0f; /** @brief Intensity of the point light. */
+        glm::vec3 color{ 1.f }; /** @brief Color of the point light. */
+    };
+
+    /**
+     * @brief Structure representing the model component of a game object.
+    */
+    struct ModelComponent {
+        std::shared_ptr<LveModel> model{}; /** @brief Pointer to the model drawn for the game object. */
+    };
+
+    /**
+     * @brief Structure representing the collider component of a game object.
+     * The box itself is the colisionBox of the transform component.
+    */
+    struct ColliderComponent {
+        uint32_t proxy = 0; /** @brief Proxy of the collision box in the broad phase. */
+        int32_t treeProxy = -1; /** @brief Proxy of the collision box in the AABB tree. */
     };
 
     /**
-     * @brief Class representing a game object in the LVE engine.
+     * @brief Lightweight handle to an entity of the registry.
+     * The components are stored in the registry pools, the handle only keeps the entity ID, so it can be freely copied.
     */
     class LveGameObject {
     public:
-        using id_t = unsigned int; /** @brief Type alias for the object ID. */
-        using Map = std::unordered_map<id_t, LveGameObject>; /** @brief Type alias for the object map. */
+        using id_t = entity_t; /** @brief Type alias for the object ID. */
 
         /**
-         * @brief Creates a new game object with a unique ID.
+         * @brief Creates a new game object with a unique ID and a transform component.
+         * @param registry : The registry owning the components.
          * @return The newly created game object.
         */
-        static LveGameObject createGameObject() { static id_t currentId = 0; return LveGameObject{ currentId++ }; }
+        static LveGameObject createGameObject(LveRegistry& registry);
         
         /**
          * @brief Creates a point light game object with the specified parameters.
+         * @param registry : The registry owning the components.
          * @param intensity : The light intensity.
          * @param radius : The light radius.
          * @param color : The light color.
          * @return The created point light game object.
         */
-        static LveGameObject makePointLight(float intensity = 10.f, float radius = 0.1f, glm::vec3 color = glm::vec3(1.f));
+        static LveGameObject makePointLight(LveRegistry& registry, float intensity = 10.f, float radius = 0.1f, glm::vec3 color = glm::vec3(1.f));
 
-        LveGameObject(const LveGameObject&) = delete;
-        LveGameObject& operator=(const LveGameObject&) = delete;
-        LveGameObject(LveGameObject&&) = default;
-        LveGameObject& operator=(LveGameObject&&) = default;
+        /**
+         * @brief Constructor for a handle to an existing entity.
+         * @param registry : The registry owning the components.
+         * @param objId : The ID of the entity.
+        */
+        LveGameObject(LveRegistry& registry, id_t objId) : registry(&registry), id(objId) {}
 
         /**
          * @brief Gets the ID of the game object.
          * @return The ID.
         */
-        id_t getId() { return id; }
+        id_t getId() const { return id; }
 
         /**
-         * @brief Gets the minimum point of the bounding box.
-         * @return The minimum point.
+         * @brief Gets the transform component of the game object.
+         * @return Reference to the transform component.
         */
-        glm::vec3 get_point_box_min() { return { -transform.translation.x / 2, -transform.translation.y / 2, -transform.translation.z / 2 }; }
-        
+        TransformComponent& transform() { return registry->get<TransformComponent>(id); }
+
         /**
-         * @brief Gets the maximum point of the bounding box.
-         * @return The maximum point.
+         * @brief Sets the model drawn for the game object, adding the model component if needed.
+         * @param model : The model.
         */
-        glm::vec3 get_point_box_max() { return { transform.translation.x / 2, transform.translation.y / 2, transform.translation.z / 2 }; }
+        void setModel(std::shared_ptr<LveModel> model);
 
+        /**
+         * @brief Adds a component to the game object.
+         * @tparam T : The component type.
+         * @param ...args : Arguments used to brace-initialize the component.
+         * @return Reference to the new component.
+        */
+        template <typename T, typename... Args>
+        T& addComponent(Args&&... args) { return registry->emplace<T>(id, std::forward<Args>(args)...); }
 
+        /**
+         * @brief Gets a component of the game object (the object must have it).
+         * @tparam T : The component type.
+         * @return Reference to the component.
+        */
+        template <typename T>
+        T& getComponent() { return registry->get<T>(id); }
 
-        // ----------------- Variable -----------------
-        std::shared_ptr<LveModel>model{}; /** @brief Pointer to the model associated with the game object. */
-        glm::vec3 color{}; /** @brief Color of the game object. */
-        TransformComponent transform{}; /** @brief Transformation component of the game object. */
-        std::unique_ptr<PointLightComponent> pointLight = nullptr; /** @brief Pointer to the point light component. */
-
-
-    private:
         /**
-         * @brief Private constructor for creating a game object with a specified ID.
-         * @param objId The ID of the game object.
+         * @brief Checks if the game object has a component.
+         * @tparam T : The component type.
+         * @return True if the object has the component, false otherwise.
         */
-        LveGameObject(id_t objId) : id(objId) {}
+        template <typename T>
+        bool hasComponent() { return registry->has<T>(id); }
 
+        /**
+         * @brief Gets the minimum point of the bounding box.
+         * @return The minimum point.
+        */
+        glm::vec3 get_point_box_min() { auto& t = transform().getTranslation(); return { -t.x / 2, -t.y / 2, -t.z / 2 }; }
+        
+        /**
+         * @brief Gets the maximum point of the bounding box.
+         * @return The maximum point.
+        */
+        glm::vec3 get_point_box_max() { auto& t = transform().getTranslation(); return { t.x / 2, t.y / 2, t.z / 2 }; }
 
 
+    private:
         // ----------------- Variable -----------------
+        LveRegistry* registry; /** @brief Registry owning the components of the game object. */
         id_t id; /** @brief ID of the game object. */
     };
 }
\ No newline at end of file
@@ -0,0 +1,225 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_buffer.hpp"
+
+//std
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lve {
+    /**
+     * @brief Usage of the blocks of the geometry pool.
+    */
+    struct LveGeometryPoolStats {
+        uint32_t blockCount = 0; /** @brief Number of live blocks (device local buffers). */
+        uint32_t meshCount = 0; /** @brief Number of live meshes. */
+        VkDeviceSize blockBytes = 0; /** @brief Bytes of the blocks. */
+        VkDeviceSize usedBytes = 0; /** @brief Bytes given to the vertices and indices of the meshes. */
+        VkDeviceSize largestFreeRange = 0; /** @brief Largest free range of the blocks. */
+    };
+
+    /**
+     * @brief Shared geometry arena : the vertices and indices of every mesh are ranges of a few large device local buffers (the blocks).
+     * A block holds both vertices and indices, a mesh is a vertex range aligned on its vertex stride and an index range aligned on its index size,
+     * so that it is drawn with the vertexOffset and firstIndex of getRange while the whole block stays bound (any vertex format and index type can share a block).
+     * A block keeps its free ranges sorted by offset, allocations take the best fitting range and freed ranges are merged with their neighbours.
+     * Freed ranges are reused MAX_FRAMES_IN_FLIGHT frames later, when no frame in flight can read them anymore, and an empty block is then released.
+     * compact moves the meshes of the least used block into the free ranges of the others with copies on the upload queue,
+     * a moved mesh switches to its new range at the first beginFrame after its copy has finished.
+    */
+    class LveGeometryPool {
+    public:
+        static constexpr VkDeviceSize BLOCK_SIZE = 64 * 1024 * 1024; /** @brief Size of the blocks (a larger mesh gets a block of its own size). */
+        static constexpr uint32_t INVALID_MESH = UINT32_MAX; /** @brief Handle of no mesh. */
+
+        /**
+         * @brief Place of a mesh in the pool, as given to the draw commands.
+        */
+        struct MeshRange {
+            uint32_t block = 0; /** @brief Block holding the mesh. */
+            int32_t vertexOffset = 0; /** @brief First vertex of the mesh in the block, in vertices of its stride. */
+            uint32_t firstIndex = 0; /** @brief First index of the mesh in the block, in indices of its size. */
+        };
+
+        /**
+         * @brief Constructor, no block is created until the first mesh.
+         * @param device : The LveDevice reference (its upload queue fills the blocks).
+        */
+        LveGeometryPool(LveDevice& device);
+
+        /**
+         * @brief Destructor releasing every block.
+        */
+        ~LveGeometryPool();
+
+        LveGeometryPool(const LveGeometryPool&) = delete;
+        LveGeometryPool& operator=(const LveGeometryPool&) = delete;
+
+        /**
+         * @brief Reserves the vertex and index ranges of a mesh in one block (thread safe).
+         * @param vertexStride : The size of a vertex.
+         * @param vertexCount : The number of vertices.
+         * @param indexSize : The size of an index (2 or 4).
+         * @param indexCount : The number of indices (0 for a mesh without indices).
+         * @return The handle of the mesh.
+        */
+        uint32_t allocate(uint32_t vertexStride, uint32_t vertexCount, uint32_t indexSize, uint32_t indexCount);
+
+        /**
+         * @brief Uploads the vertices and indices of a mesh through the upload queue (thread safe).
+         * @param mesh : The handle of the mesh.
+         * @param vertices : vertexCount vertices of vertexStride bytes.
+         * @param indices : indexCount indices of indexSize bytes (may be nullptr if the mesh has no indices).
+         * @return The ticket of the upload.
+        */
+        uint64_t upload(uint32_t mesh, const void* vertices, const void* indices);
+
+        /**
+         * @brief Releases a mesh (thread safe), its ranges are reused once the frames in flight are done with them.
+         * Its upload must be complete.
+         * @param mesh : The handle of the mesh.
+        */
+        void free(uint32_t mesh);
+
+        /**
+         * @brief Gets the place of a mesh (thread safe), it does not change between two beginFrame calls.
+         * @param mesh : The handle of the mesh.
+         * @return The block and the offsets of the mesh.
+        */
+        MeshRange getRange(uint32_t mesh) const;
+
+        /**
+         * @brief Gets the buffer of a block (thread safe), to bind as vertex buffer and index buffer at offset 0.
+         * @param block : The index of the block.
+         * @return The buffer.
+        */
+        VkBuffer getBuffer(uint32_t block) const;
+
+        /**
+         * @brief Starts a frame (thread safe) : the ranges freed MAX_FRAMES_IN_FLIGHT frames ago are reused, the moves whose copy has finished take effect
+         * and the pool is compacted if meshes were released.
+         * Must be called after the fence of the frame has been waited on, before recording it.
+        */
+        void beginFrame();
+
+        /**
+         * @brief Moves the meshes of the least used block into the free ranges of the other blocks, so that it can be released (thread safe).
+         * @return The number of meshes being moved.
+        */
+        uint32_t compact();
+
+        /**
+         * @brief Gets the usage of the pool (thread safe).
+         * @return The statistics.
+        */
+        LveGeometryPoolStats getStats() const;
+
+
+    private:
+        /**
+         * @brief One device local buffer shared by several meshes.
+        */
+        struct Block {
+            std::unique_ptr<LveBuffer> buffer; /** @brief Buffer holding the vertices and indices. */
+            VkDeviceSize size = 0; /** @brief Size of the buffer. */
+            std::map<VkDeviceSize, VkDeviceSize> freeRanges; /** @brief Free ranges (offset to size), sorted by offset. */
+            VkDeviceSize usedBytes = 0; /** @brief Bytes given to the ranges of the meshes, including the ranges waiting to be reused. */
+            uint32_t meshCount = 0; /** @brief Number of meshes with a range in the block, including the moving ones. */
+        };
+
+        /**
+         * @brief Vertex and index ranges of a mesh in a block.
+        */
+        struct Placement {
+            uint32_t block = 0; /** @brief Block holding the ranges. */
+            VkDeviceSize vertexOffset = 0; /** @brief Offset of the vertices in the block, in bytes. */
+            VkDeviceSize indexOffset = 0; /** @brief Offset of the indices in the block, in bytes. */
+        };
+
+        /**
+         * @brief A mesh of the pool.
+        */
+        struct Mesh {
+            uint32_t vertexStride = 0; /** @brief Size of a vertex. */
+            uint32_t vertexCount = 0; /** @brief Number of vertices. */
+            uint32_t indexSize = 0; /** @brief Size of an index. */
+            uint32_t indexCount = 0; /** @brief Number of indices. */
+            Placement placement{}; /** @brief Ranges read by the draws. */
+            MeshRange range{}; /** @brief placement, in the units of the draw commands. */
+            Placement movePlacement{}; /** @brief Ranges receiving the copy of a move. */
+            uint64_t uploadTicket = 0; /** @brief Ticket of the upload, 0 until it is recorded (only then can the mesh be moved). */
+            uint64_t moveTicket = 0; /** @brief Ticket of the copy of a move (0 if the mesh is not moving). */
+            bool live = false; /** @brief False for a free handle. */
+        };
+
+        /**
+         * @brief Ranges waiting for the frames in flight before being reused.
+        */
+        struct PendingFree {
+            uint32_t block = 0; /** @brief Block of the ranges. */
+            VkDeviceSize vertexOffset = 0; /** @brief Offset of the vertex range. */
+            VkDeviceSize vertexBytes = 0; /** @brief Size of the vertex range. */
+            VkDeviceSize indexOffset = 0; /** @brief Offset of the index range. */
+            VkDeviceSize indexBytes = 0; /** @brief Size of the index range (0 if none). */
+            uint64_t frame = 0; /** @brief Frame during which the ranges were released. */
+        };
+
+        /**
+         * @brief Places the ranges of a mesh in a block, creating a block if none has room (the mutex must be locked).
+         * @param mesh : The mesh.
+         * @param excludedBlock : A block not to use (UINT32_MAX for none).
+         * @param createBlock : True to create a block if no block has room.
+         * @param placement : Receives the ranges.
+         * @return False if no block has room and none could be created.
+        */
+        bool place(const Mesh& mesh, uint32_t excludedBlock, bool createBlock, Placement& placement);
+
+        /**
+         * @brief Takes the best fitting range of a block (the mutex must be locked).
+         * @param block : The block.
+         * @param size : The size of the range.
+         * @param alignment : The alignment of the offset (any value, not only powers of two).
+         * @param offset : Receives the offset of the range.
+         * @return False if the block has no free range large enough.
+        */
+        static bool allocateRange(Block& block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset);
+
+        /**
+         * @brief Gives a range back to its block, merging it with its free neighbours (the mutex must be locked).
+         * @param block : The block.
+         * @param offset : The offset of the range.
+         * @param size : The size of the range.
+        */
+        static void freeRange(Block& block, VkDeviceSize offset, VkDeviceSize size);
+
+        /**
+         * @brief Queues the ranges of a placement until the frames in flight are done with them (the mutex must be locked).
+         * @param mesh : The mesh owning the ranges.
+         * @param placement : The ranges.
+        */
+        void retirePlacement(const Mesh& mesh, const Placement& placement);
+
+        /**
+         * @brief Computes the range of a mesh from its placement.
+         * @param mesh : The mesh, its range is updated.
+        */
+        static void updateRange(Mesh& mesh);
+
+
+
+        // ----------------- Variable -----------------
+        LveDevice& lveDevice; /** @brief Reference to the LveDevice. */
+        std::vector<std::unique_ptr<Block>> blocks; /** @brief Blocks, nullptr for a released block whose index can be reused. */
+        std::vector<Mesh> meshes; /** @brief Meshes, indexed by handle. */
+        std::vector<uint32_t> freeMeshes; /** @brief Handles that can be reused. */
+        std::vector<PendingFree> pendingFrees; /** @brief Released ranges, oldest first. */
+        std::vector<uint32_t> movingMeshes; /** @brief Meshes whose move has not taken effect yet. */
+        uint64_t frameCount = 0; /** @brief Number of beginFrame calls. */
+        bool compactionNeeded = false; /** @brief True when ranges were released since the last compaction. */
+        mutable std::mutex mutex; /** @brief Protects the blocks and the meshes, so that models can be loaded from several threads. */
+    };
+}  // namespace lve
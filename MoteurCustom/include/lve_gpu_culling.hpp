@@ -0,0 +1,174 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_buffer.hpp"
+#include "lve_compute_pipeline.hpp"
+#include "lve_descriptors.hpp"
+#include "lve_frame_info.hpp"
+#include "lve_game_object.hpp"
+#include "lve_transform_batch.hpp"
+
+//std
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+    /**
+     * @brief Per-object data read by the culling compute shader (std430 layout of cull.comp).
+    */
+    struct GpuObjectData {
+        glm::mat4 modelMatrix{ 1.f }; /** @brief Model (object to world) matrix. */
+        glm::mat4 normalMatrix{ 1.f }; /** @brief Normal matrix (only the upper 3x3 part is used). */
+        glm::vec4 boundsMin{ 0.f }; /** @brief Minimum corner of the model box, in model space. */
+        glm::vec4 boundsMax{ 0.f }; /** @brief Maximum corner of the model box, in model space. */
+        glm::uvec4 drawInfo{ 0 }; /** @brief Index of the draw of the model in x. */
+    };
+
+    /**
+     * @brief Indirect draw of one model, the compute shader counts the visible instances in command.instanceCount.
+    */
+    struct GpuDrawCommand {
+        VkDrawIndexedIndirectCommand command; /** @brief Parameters read by vkCmdDrawIndexedIndirect. */
+        uint32_t instanceBase; /** @brief First instance of the draw in the instance buffer. */
+        uint32_t padding[2]; /** @brief Keeps the std430 stride at 32 bytes. */
+    };
+
+    /**
+     * @brief GPU-driven culling : the objects live in a storage buffer, a compute shader tests them against the frustum and fills the instance buffer and the indirect draws.
+     * The CPU only compares the entity, model and dirty flag of each object and uploads the objects that changed.
+     * Models without an index buffer are not drawn by this path.
+     * When the device supports multiDrawIndirect, the consecutive float format models of one geometry block share a single vkCmdDrawIndexedIndirect.
+    */
+    class LveGpuCulling {
+    public:
+        static constexpr VkDeviceSize INSTANCE_SIZE = 2 * sizeof(glm::mat4); /** @brief Size of one instance written by the shader (model and normal matrices). */
+        static constexpr uint32_t WORKGROUP_SIZE = 64; /** @brief local_size_x of cull.comp. */
+
+        /**
+         * @brief Constructor creating the compute pipeline and its descriptor sets.
+         * @param device : The LveDevice reference.
+        */
+        LveGpuCulling(LveDevice& device);
+
+        /**
+         * @brief Destructor to release associated resources.
+        */
+        ~LveGpuCulling();
+
+        LveGpuCulling(const LveGpuCulling&) = delete;
+        LveGpuCulling& operator=(const LveGpuCulling&) = delete;
+
+        /**
+         * @brief Uploads the objects that changed and records the culling dispatch (must be called outside of a render pass).
+         * @param frameInfo : The frame information.
+         * @param frustumCulling : True to skip the objects outside the camera frustum, false to keep everything.
+        */
+        void cull(FrameInfo& frameInfo, bool frustumCulling);
+
+        /**
+         * @brief Records the indirect draws of the models with the instances written by the last cull (the descriptor sets must be bound).
+         * @param frameInfo : The frame information.
+         * @param bindModel : Binds the pipeline and the buffers of a model before its draw, returns false to skip the model.
+        */
+        void draw(FrameInfo& frameInfo, const std::function<bool(LveModel&)>& bindModel);
+
+        /**
+         * @brief Uploads every object again on the next frames (their matrices may have been rebuilt without the GPU copy).
+        */
+        void invalidate();
+
+        /**
+         * @brief Gets the number of objects sent to the compute shader by the last cull.
+         * @return The object count.
+        */
+        uint32_t getObjectCount() const { return objectCount; }
+
+        /**
+         * @brief Gets the number of visible objects read back from the GPU (late by LveSwapChain::MAX_FRAMES_IN_FLIGHT frames).
+         * @return The visible object count.
+        */
+        uint32_t getVisibleCount() const { return visibleCount; }
+
+        /**
+         * @brief Gets the number of indirect draw calls recorded by the last draw (a call may draw several models).
+         * @return The draw count.
+        */
+        uint32_t getDrawCount() const { return drawCount; }
+
+
+    private:
+        /**
+         * @brief Buffers of one frame in flight.
+        */
+        struct FrameResources {
+            std::unique_ptr<LveBuffer> objectBuffer; /** @brief Host visible copy of the objects. */
+            std::unique_ptr<LveBuffer> drawBuffer; /** @brief Host visible indirect draws (read back for the visible count). */
+            std::unique_ptr<LveBuffer> instanceBuffer; /** @brief Device local instances, written by the shader and read as a vertex buffer. */
+            uint32_t drawCount = 0; /** @brief Number of draws written in drawBuffer. */
+            VkDescriptorSet descriptorSet = VK_NULL_HANDLE; /** @brief Storage buffers of the compute shader. */
+        };
+
+        /**
+         * @brief Creates the descriptor set layout, the pool and the pipeline layout of the compute shader.
+        */
+        void createPipelineLayout();
+
+        /**
+         * @brief Gets the draw of a model, adding it if the model is new.
+         * @param model : The model.
+         * @return The index of the draw.
+        */
+        uint32_t getDrawIndex(const std::shared_ptr<LveModel>& model);
+
+        /**
+         * @brief Removes the draws no object uses anymore so that their models can be released, the slots whose draw moved are uploaded again.
+        */
+        void pruneDraws();
+
+        /**
+         * @brief Marks an object to be uploaded in the buffers of every frame in flight.
+         * @param slot : The index of the object in the object buffer.
+        */
+        void markPending(uint32_t slot);
+
+        /**
+         * @brief Grows the buffers of a frame if they are too small, the objects are then all uploaded again for this frame.
+         * @param frameIndex : The index of the frame in flight.
+        */
+        void reserveFrame(int frameIndex);
+
+
+
+        // ----------------- Variable -----------------
+        LveDevice& lveDevice; /** @brief Reference to the LveDevice. */
+        std::unique_ptr<LveDescriptorSetLayout> setLayout; /** @brief Layout of the storage buffers of the compute shader. */
+        std::unique_ptr<LveDescriptorPool> descriptorPool; /** @brief Pool of the descriptor sets of every frame. */
+        VkPipelineLayout pipelineLayout; /** @brief Layout of the compute pipeline. */
+        std::unique_ptr<LveComputePipeline> computePipeline; /** @brief Culling compute pipeline. */
+        std::vector<FrameResources> frames; /** @brief Buffers of every frame in flight. */
+
+        std::vector<LveGameObject::id_t> slotEntities; /** @brief Entity of each object slot. */
+        std::vector<LveModel*> slotModels; /** @brief Model of each object slot (kept alive by its draw in drawModels). */
+        std::vector<GpuObjectData> slotObjects; /** @brief CPU copy of each object slot, uploaded to the frames whose copy is out of date. */
+        std::vector<uint32_t> changedSlots; /** @brief Slots changed by the current cull (reused between frames). */
+        std::vector<TransformComponent*> changedTransforms; /** @brief Transform of each changed slot (reused between frames). */
+        std::vector<uint8_t> pendingFrames; /** @brief Frames in flight (bit mask) whose buffer still holds an old copy of each slot. */
+        std::vector<uint32_t> pendingSlots; /** @brief Slots with a non-zero pendingFrames mask. */
+
+        std::vector<std::shared_ptr<LveModel>> drawModels; /** @brief Model of each draw, held until no object uses it. */
+        std::unordered_map<LveModel*, uint32_t> drawLookup; /** @brief Draw of each model. */
+        std::vector<uint32_t> drawObjectCounts; /** @brief Number of objects using each draw. */
+        std::vector<uint32_t> drawRemap; /** @brief New index of each draw while pruning (reused between frames). */
+
+        LveTransformBatch transformBatch; /** @brief Dirty transforms of the current frame, rebuilt together by the SIMD kernel. */
+        std::vector<TransformComponent*> dirtyTransforms; /** @brief Components receiving the matrices of transformBatch (reused between frames). */
+        std::vector<glm::mat4> batchModelMatrices; /** @brief Model matrices computed by transformBatch (reused between frames). */
+        std::vector<glm::mat3> batchNormalMatrices; /** @brief Normal matrices computed by transformBatch (reused between frames). */
+
+        uint32_t objectCount = 0; /** @brief Number of objects sent to the compute shader by the last cull. */
+        uint32_t visibleCount = 0; /** @brief Visible objects read back from the GPU. */
+        uint32_t drawCount = 0; /** @brief Number of indirect draws recorded by the last draw. */
+    };
+}  // namespace lve
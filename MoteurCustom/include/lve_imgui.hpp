@@ -4,6 +4,9 @@
 #include "lve_swap_chain.hpp"
 #include "lve_renderer.hpp"
 
+//libs
+#include <glm/glm.hpp>
+
 namespace lve {
     /**
      * @brief Class representing an ImGui interface for Vulkan rendering.
@@ -53,6 +56,41 @@ namespace lve {
         */
         float getPositionSliderValue(int xyz);
 
+        /**
+         * @brief Shows another game object in the inspector.
+         * @param id : The ID of the game object.
+         * @param objectPosition : The current position of the game object.
+         * @param objectRotation : The current rotation of the game object.
+         * @param objectScale : The current scale of the game object.
+        */
+        void setInspectedObject(unsigned int id, const glm::vec3& objectPosition, const glm::vec3& objectRotation, const glm::vec3& objectScale);
+
+        /**
+         * @brief Checks if ImGui uses the mouse (cursor over a window or a widget).
+         * @return True if the mouse inputs belong to the UI, false otherwise.
+        */
+        bool wantsMouse() const;
+
+        /**
+         * @brief Sets the render counters shown in the inspector.
+         * @param visibleCount : The number of objects that passed the frustum culling.
+         * @param objectCount : The number of objects with a model.
+         * @param drawCount : The number of draw calls.
+        */
+        void setRenderStats(uint32_t visibleCount, uint32_t objectCount, uint32_t drawCount);
+
+        /**
+         * @brief Sets the state of the GPU culling checkbox.
+         * @param enabled : True to check it.
+        */
+        void setGpuCulling(bool enabled);
+
+        /**
+         * @brief Checks if the GPU culling checkbox is checked.
+         * @return True if the objects must be culled on the GPU, false otherwise.
+        */
+        bool isGpuCullingEnabled() const;
+
 
     private:
 
@@ -76,6 +114,6 @@ namespace lve {
         LveWindow& lveWindow; /** @brief Reference to the LveWindow object. */
         LveDevice& lveDevice; /** @brief Reference to the LveDevice object. */
         LveRenderer& lveRenderer; /** @brief Reference to the LveRenderer object. */
-        VkDescriptorPool imguiPool; /** @brief Vulkan descriptor pool for ImGui. */
+        VkDescriptorPool imguiPool = VK_NULL_HANDLE; /** @brief Vulkan descriptor pool for ImGui. */
     };
 }
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_buffer.hpp"
+#include "lve_cluster_grid.hpp"
+#include "lve_descriptors.hpp"
+#include "lve_frame_info.hpp"
+
+//std
+#include <memory>
+#include <vector>
+
+namespace lve {
+    /**
+     * @brief GPU side of the clustered forward lighting : uploads the lights and the cluster grid in the storage buffers of the global descriptor set.
+     * Bindings of the global set : 1 the lights, 2 the offset and count of each cluster, 3 the light index list.
+    */
+    class LveLightClusters {
+    public:
+        static constexpr uint32_t LIGHT_BINDING = 1; /** @brief Binding of the light buffer in the global set. */
+        static constexpr uint32_t CLUSTER_BINDING = 2; /** @brief Binding of the cluster buffer in the global set. */
+        static constexpr uint32_t INDEX_BINDING = 3; /** @brief Binding of the light index buffer in the global set. */
+
+        /**
+         * @brief Constructor.
+         * @param device : The LveDevice reference.
+         * @param globalSetLayout : The layout of the global descriptor set (with the three storage bindings).
+         * @param globalPool : The pool of the global descriptor sets.
+        */
+        LveLightClusters(LveDevice& device, LveDescriptorSetLayout& globalSetLayout, LveDescriptorPool& globalPool);
+
+        LveLightClusters(const LveLightClusters&) = delete;
+        LveLightClusters& operator=(const LveLightClusters&) = delete;
+
+        /**
+         * @brief Assigns the lights to the clusters, uploads them and fills the cluster parameters of the UBO (the view and projection of the UBO must be set).
+         * @param frameInfo : The frame information.
+         * @param ubo : The global uniform buffer object.
+         * @param lights : The lights, in world space (position.w is the range given by LveClusterGrid::computeLightRange).
+         * @param extent : The size of the swap chain images, in pixels.
+        */
+        void update(FrameInfo& frameInfo, GlobalUbo& ubo, const std::vector<PointLight>& lights, VkExtent2D extent);
+
+        /**
+         * @brief Gets the cluster grid built by the last update.
+         * @return The cluster grid.
+        */
+        const LveClusterGrid& getGrid() const { return clusterGrid; }
+
+
+    private:
+        /**
+         * @brief Buffers of one frame in flight.
+        */
+        struct FrameResources {
+            std::unique_ptr<LveBuffer> lightBuffer; /** @brief Lights. */
+            std::unique_ptr<LveBuffer> clusterBuffer; /** @brief Offset and count of each cluster. */
+            std::unique_ptr<LveBuffer> indexBuffer; /** @brief Light index list. */
+            VkDescriptorSet descriptorSet = VK_NULL_HANDLE; /** @brief Global set whose storage bindings point to these buffers. */
+        };
+
+        /**
+         * @brief Grows the buffers of a frame if they are too small and points the global set to them.
+         * @param frameInfo : The frame information.
+         * @param lightCount : The number of lights to upload.
+         * @param indexCount : The number of light indices to upload.
+        */
+        void reserveFrame(FrameInfo& frameInfo, uint32_t lightCount, uint32_t indexCount);
+
+
+
+        // ----------------- Variable -----------------
+        LveDevice& lveDevice; /** @brief Reference to the LveDevice. */
+        LveDescriptorSetLayout& globalSetLayout; /** @brief Layout of the global descriptor set. */
+        LveDescriptorPool& globalPool; /** @brief Pool of the global descriptor sets. */
+        LveClusterGrid clusterGrid; /** @brief Lights of each cluster, built on the CPU. */
+        std::vector<FrameResources> frames; /** @brief Buffers of every frame in flight. */
+    };
+}  // namespace lve
@@ -0,0 +1,173 @@
+#pragma once
+
+//libs
+#include <vulkan/vulkan.h>
+
+//std
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lve {
+    /**
+     * @brief Part of a device memory block given to a buffer or an image.
+    */
+    struct LveAllocation {
+        VkDeviceMemory memory = VK_NULL_HANDLE; /** @brief Memory block holding the allocation. */
+        VkDeviceSize offset = 0; /** @brief Offset of the allocation in the block. */
+        VkDeviceSize size = 0; /** @brief Size reserved in the block. */
+        void* mapped = nullptr; /** @brief Host address of the allocation (nullptr if the memory is not host visible). */
+        uint32_t pool = 0; /** @brief Pool owning the block. */
+        uint32_t block = 0; /** @brief Index of the block in its pool. */
+    };
+
+    /**
+     * @brief Memory usage of one heap of the physical device.
+    */
+    struct LveMemoryHeapStats {
+        uint32_t blockCount = 0; /** @brief Number of live device memory objects (vkAllocateMemory calls). */
+        uint32_t allocationCount = 0; /** @brief Number of live buffers and images. */
+        VkDeviceSize blockBytes = 0; /** @brief Bytes allocated from the driver. */
+        VkDeviceSize usedBytes = 0; /** @brief Bytes given to buffers and images. */
+        VkDeviceSize largestFreeRange = 0; /** @brief Largest free range of the blocks. */
+        float fragmentation = 0.f; /** @brief 1 - largestFreeRange / free bytes (0 when all the free memory is contiguous). */
+    };
+
+    /**
+     * @brief Sub-allocator of device memory : buffers and images are placed in large blocks (one vkAllocateMemory per block) instead of one allocation each.
+     * Each memory type has two pools, one for buffers and one for optimal tiling images, so that bufferImageGranularity never has to be checked.
+     * A block keeps its free ranges sorted by offset, allocations take the best fitting range and freed ranges are merged with their neighbours.
+     * Host visible blocks stay mapped for their whole life, LveAllocation::mapped points inside the block.
+    */
+    class LveMemoryAllocator {
+    public:
+        static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64 * 1024 * 1024; /** @brief Size of the blocks of large heaps. */
+
+        /**
+         * @brief Constructor.
+         * @param device : The logical device.
+         * @param physicalDevice : The physical device, for the memory types and heaps.
+        */
+        LveMemoryAllocator(VkDevice device, VkPhysicalDevice physicalDevice);
+
+        /**
+         * @brief Destructor releasing every block.
+        */
+        ~LveMemoryAllocator();
+
+        LveMemoryAllocator(const LveMemoryAllocator&) = delete;
+        LveMemoryAllocator& operator=(const LveMemoryAllocator&) = delete;
+
+        /**
+         * @brief Allocates memory for a buffer or an image (thread safe).
+         * @param requirements : The memory requirements of the resource.
+         * @param memoryType : The index of the memory type, from LveDevice::findMemoryType.
+         * @param optimalImage : True for an image with optimal tiling, false for a buffer or a linear image.
+         * @return The allocation, to bind to the resource at allocation.offset.
+        */
+        LveAllocation allocate(const VkMemoryRequirements& requirements, uint32_t memoryType, bool optimalImage);
+
+        /**
+         * @brief Gives an allocation back to its block (thread safe), the block is released if it is dedicated or if its pool has another empty block.
+         * @param allocation : The allocation, reset on return.
+        */
+        void free(LveAllocation& allocation);
+
+        /**
+         * @brief Flushes host writes to a range of an allocation (nothing to do on host coherent memory).
+         * @param allocation : The allocation.
+         * @param size : The size of the range (VK_WHOLE_SIZE for the rest of the allocation).
+         * @param offset : The offset of the range in the allocation.
+         * @return Result of vkFlushMappedMemoryRanges.
+        */
+        VkResult flush(const LveAllocation& allocation, VkDeviceSize size, VkDeviceSize offset);
+
+        /**
+         * @brief Makes device writes to a range of an allocation visible to the host (nothing to do on host coherent memory).
+         * @param allocation : The allocation.
+         * @param size : The size of the range (VK_WHOLE_SIZE for the rest of the allocation).
+         * @param offset : The offset of the range in the allocation.
+         * @return Result of vkInvalidateMappedMemoryRanges.
+        */
+        VkResult invalidate(const LveAllocation& allocation, VkDeviceSize size, VkDeviceSize offset);
+
+        /**
+         * @brief Gets the memory usage of every heap.
+         * @return The statistics, indexed by heap.
+        */
+        std::vector<LveMemoryHeapStats> getHeapStats() const;
+
+
+    private:
+        /**
+         * @brief One device memory object, shared by several resources.
+        */
+        struct Block {
+            VkDeviceMemory memory = VK_NULL_HANDLE; /** @brief Device memory object. */
+            VkDeviceSize size = 0; /** @brief Size of the block. */
+            void* mapped = nullptr; /** @brief Host address of the block (host visible memory only). */
+            std::map<VkDeviceSize, VkDeviceSize> freeRanges; /** @brief Free ranges (offset to size), sorted by offset. */
+            uint32_t allocationCount = 0; /** @brief Number of live allocations. */
+            VkDeviceSize usedBytes = 0; /** @brief Bytes given to the allocations. */
+            bool dedicated = false; /** @brief True for a block created for a single large resource. */
+        };
+
+        /**
+         * @brief Blocks of one memory type for one kind of resource.
+        */
+        struct Pool {
+            uint32_t memoryType = 0; /** @brief Index of the memory type. */
+            VkDeviceSize blockSize = 0; /** @brief Size of the shared blocks. */
+            VkDeviceSize granularity = 1; /** @brief Alignment of offsets and sizes (nonCoherentAtomSize for non coherent host visible memory). */
+            bool hostVisible = false; /** @brief True if the blocks are mapped. */
+            bool coherent = false; /** @brief True if flush and invalidate are not needed. */
+            std::vector<std::unique_ptr<Block>> blocks; /** @brief Blocks, nullptr for a released block whose index can be reused. */
+        };
+
+        /**
+         * @brief Creates a block in a pool.
+         * @param pool : The pool.
+         * @param size : The size of the block.
+         * @param dedicated : True if the block holds a single resource.
+         * @return The index of the block in the pool.
+        */
+        uint32_t createBlock(Pool& pool, VkDeviceSize size, bool dedicated);
+
+        /**
+         * @brief Releases a block and its device memory.
+         * @param pool : The pool owning the block.
+         * @param blockIndex : The index of the block.
+        */
+        void destroyBlock(Pool& pool, uint32_t blockIndex);
+
+        /**
+         * @brief Takes the best fitting free range of a block.
+         * @param block : The block.
+         * @param size : The size to allocate.
+         * @param alignment : The alignment of the offset.
+         * @param offset : Receives the offset of the allocation.
+         * @return False if no free range is large enough.
+        */
+        static bool allocateFromBlock(Block& block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset);
+
+        /**
+         * @brief Builds the mapped memory range of a part of an allocation, aligned on nonCoherentAtomSize.
+         * @param allocation : The allocation.
+         * @param size : The size of the range (VK_WHOLE_SIZE for the rest of the allocation).
+         * @param offset : The offset of the range in the allocation.
+         * @return The mapped memory range.
+        */
+        VkMappedMemoryRange getMappedRange(const LveAllocation& allocation, VkDeviceSize size, VkDeviceSize offset) const;
+
+
+
+        // ----------------- Variable -----------------
+        VkDevice device; /** @brief Logical device. */
+        VkPhysicalDeviceMemoryProperties memoryProperties; /** @brief Memory types and heaps of the physical device. */
+        VkDeviceSize nonCoherentAtomSize = 1; /** @brief Alignment of the flushed and invalidated ranges. */
+        std::vector<Pool> pools; /** @brief Two pools per memory type : buffers (even indices) and optimal images (odd indices). */
+        mutable std::mutex mutex; /** @brief Protects the pools, so that resources can be created from several threads. */
+    };
+}  // namespace lve
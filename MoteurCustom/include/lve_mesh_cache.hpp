@@ -0,0 +1,156 @@
+#pragma once
+
+#include "lve_model.hpp"
+
+//std
+#include <cstdint>
+#include <string>
+
+namespace lve {
+    /**
+     * @brief Binary copy of a loaded mesh, so that the OBJ parsing and the vertex deduplication only happen once.
+     * The file is a Header followed by the raw Vertex array, the uint32_t index array, the Meshlet array and the Lod array, it is memory mapped when read :
+     * the arrays are uploaded straight from the mapping, without an intermediate copy.
+     * A cache is valid only for the OBJ whose checksum it stores, and only for the VERSION and Vertex layout that wrote it.
+    */
+    class LveMeshCache {
+    public:
+        static constexpr uint32_t MAGIC = 0x4D45564C; /** @brief "LVEM" in little endian. */
+        static constexpr uint32_t VERSION = 3; /** @brief Version of the format, to increase whenever the layout of the file, of LveModel::Vertex, LveModel::Meshlet or LveModel::Lod changes. */
+        static constexpr uint32_t FLAG_OPTIMIZED = 1; /** @brief The mesh went through LveMeshOptimizer. */
+
+        /**
+         * @brief Beginning of a cache file.
+        */
+        struct Header {
+            uint32_t magic = MAGIC; /** @brief Identifies a mesh cache file. */
+            uint32_t version = VERSION; /** @brief Version of the format. */
+            uint32_t vertexSize = sizeof(LveModel::Vertex); /** @brief Size of a vertex, in bytes. */
+            uint32_t vertexCount = 0; /** @brief Number of vertices after the header. */
+            uint32_t indexCount = 0; /** @brief Number of indices after the vertices. */
+            uint32_t flags = 0; /** @brief FLAG_ values describing how the mesh was processed. */
+            uint32_t meshletCount = 0; /** @brief Number of meshlets after the indices. */
+            uint32_t lodCount = 0; /** @brief Number of levels of detail after the meshlets. */
+            uint64_t sourceSize = 0; /** @brief Size of the OBJ file, in bytes. */
+            uint64_t sourceChecksum = 0; /** @brief Checksum of the OBJ file. */
+        };
+
+        /**
+         * @brief Constructor, no file is mapped.
+        */
+        LveMeshCache() = default;
+
+        /**
+         * @brief Destructor, unmaps the file.
+        */
+        ~LveMeshCache();
+
+        LveMeshCache(const LveMeshCache&) = delete;
+        LveMeshCache& operator=(const LveMeshCache&) = delete;
+
+        /**
+         * @brief Gets the path of the cache of a mesh file.
+         * @param sourcePath : The path to the OBJ file.
+         * @return The path of its cache, next to it.
+        */
+        static std::string getCachePath(const std::string& sourcePath);
+
+        /**
+         * @brief Computes the checksum of a file (a fast 64 bits hash, not a cryptographic one).
+         * @param filePath : The path to the file.
+         * @param fileSize : Receives the size of the file.
+         * @return The checksum, 0 if the file cannot be read.
+        */
+        static uint64_t computeChecksum(const std::string& filePath, uint64_t& fileSize);
+
+        /**
+         * @brief Writes the cache of a mesh (through a temporary file, a reader never sees a partial cache).
+         * @param cachePath : The path of the cache.
+         * @param sourceSize : The size of the OBJ file.
+         * @param sourceChecksum : The checksum of the OBJ file.
+         * @param flags : The FLAG_ values of the mesh.
+         * @param builder : The loaded mesh.
+         * @return False if the file could not be written.
+        */
+        static bool write(const std::string& cachePath, uint64_t sourceSize, uint64_t sourceChecksum, uint32_t flags, const LveModel::Builder& builder);
+
+        /**
+         * @brief Maps a cache file and checks that it matches the OBJ file.
+         * @param cachePath : The path of the cache.
+         * @param sourceSize : The size of the OBJ file.
+         * @param sourceChecksum : The checksum of the OBJ file.
+         * @param flags : The FLAG_ values the mesh must have been written with.
+         * @return False if the cache is missing, stale, processed differently or damaged (nothing stays mapped).
+        */
+        bool open(const std::string& cachePath, uint64_t sourceSize, uint64_t sourceChecksum, uint32_t flags);
+
+        /**
+         * @brief Gets the vertices of the mapped cache.
+         * @return Pointer to the vertices, in the mapping.
+        */
+        const LveModel::Vertex* getVertices() const { return vertices; }
+
+        /**
+         * @brief Gets the number of vertices of the mapped cache.
+         * @return The vertex count.
+        */
+        uint32_t getVertexCount() const { return vertexCount; }
+
+        /**
+         * @brief Gets the indices of the mapped cache.
+         * @return Pointer to the indices, in the mapping.
+        */
+        const uint32_t* getIndices() const { return indices; }
+
+        /**
+         * @brief Gets the number of indices of the mapped cache.
+         * @return The index count.
+        */
+        uint32_t getIndexCount() const { return indexCount; }
+
+        /**
+         * @brief Gets the meshlets of the mapped cache.
+         * @return Pointer to the meshlets, in the mapping.
+        */
+        const LveModel::Meshlet* getMeshlets() const { return meshlets; }
+
+        /**
+         * @brief Gets the number of meshlets of the mapped cache.
+         * @return The meshlet count.
+        */
+        uint32_t getMeshletCount() const { return meshletCount; }
+
+        /**
+         * @brief Gets the levels of detail of the mapped cache.
+         * @return Pointer to the levels, in the mapping.
+        */
+        const LveModel::Lod* getLods() const { return lods; }
+
+        /**
+         * @brief Gets the number of levels of detail of the mapped cache.
+         * @return The level count.
+        */
+        uint32_t getLodCount() const { return lodCount; }
+
+
+    private:
+        /**
+         * @brief Unmaps the file, if one is mapped.
+        */
+        void close();
+
+
+
+        // ----------------- Variable -----------------
+        const void* mappedData = nullptr; /** @brief Start of the mapped file. */
+        size_t mappedSize = 0; /** @brief Size of the mapped file. */
+        const LveModel::Vertex* vertices = nullptr; /** @brief Vertices, in the mapping. */
+        uint32_t vertexCount = 0; /** @brief Number of vertices. */
+        const uint32_t* indices = nullptr; /** @brief Indices, in the mapping. */
+        uint32_t indexCount = 0; /** @brief Number of indices. */
+        const LveModel::Meshlet* meshlets = nullptr; /** @brief Meshlets, in the mapping. */
+        uint32_t meshletCount = 0; /** @brief Number of meshlets. */
+        const LveModel::Lod* lods = nullptr; /** @brief Levels of detail, in the mapping. */
+        uint32_t lodCount = 0; /** @brief Number of levels of detail. */
+    };
+}  // namespace lve
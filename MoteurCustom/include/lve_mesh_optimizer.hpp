@@ -0,0 +1,63 @@
+#pragma once
+
+#include "lve_model.hpp"
+
+//std
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+    /**
+     * @brief Post-transform vertex cache efficiency of an index buffer, measured on a FIFO cache.
+    */
+    struct LveVertexCacheStats {
+        float acmr = 0.f; /** @brief Average cache miss ratio : vertex shader runs per triangle (0.5 at best on a regular grid, 3 at worst). */
+        float atvr = 0.f; /** @brief Average transformed vertex ratio : vertex shader runs per referenced vertex (1 at best). */
+    };
+
+    /**
+     * @brief Reorders the triangles and the vertices of a mesh for the GPU, at import time.
+     * - optimizeVertexCache : Forsyth's linear-speed ordering, triangles reusing the vertices still in the post-transform cache come first.
+     * - optimizeOverdraw : the cache friendly order is cut into clusters where the cache restarts anyway, the clusters facing outwards are drawn first so that they occlude the others.
+     * - optimizeVertexFetch : the vertices are stored in the order of their first use, unreferenced vertices are dropped.
+    */
+    class LveMeshOptimizer {
+    public:
+        static constexpr uint32_t CACHE_SIZE = 16; /** @brief Size of the FIFO cache simulated by the statistics and the overdraw clustering. */
+
+        /**
+         * @brief Runs the three passes on a mesh.
+         * @param builder : The mesh, reordered in place.
+        */
+        static void optimize(LveModel::Builder& builder);
+
+        /**
+         * @brief Reorders the triangles for the post-transform vertex cache.
+         * @param indices : The triangle list, reordered in place.
+         * @param vertexCount : The number of vertices.
+        */
+        static void optimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount);
+
+        /**
+         * @brief Reorders clusters of triangles to reduce overdraw, keeping the cache efficiency of each cluster (run after optimizeVertexCache).
+         * @param indices : The triangle list, reordered in place.
+         * @param vertices : The vertices.
+        */
+        static void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<LveModel::Vertex>& vertices);
+
+        /**
+         * @brief Sorts the vertices by first use and remaps the indices.
+         * @param vertices : The vertices, reordered in place.
+         * @param indices : The triangle list, remapped in place.
+        */
+        static void optimizeVertexFetch(std::vector<LveModel::Vertex>& vertices, std::vector<uint32_t>& indices);
+
+        /**
+         * @brief Measures the vertex cache efficiency of a triangle list.
+         * @param indices : The triangle list.
+         * @param vertexCount : The number of vertices.
+         * @return ACMR and ATVR with a FIFO cache of CACHE_SIZE entries.
+        */
+        static LveVertexCacheStats analyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount);
+    };
+}  // namespace lve
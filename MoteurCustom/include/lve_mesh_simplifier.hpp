@@ -0,0 +1,48 @@
+#pragma once
+
+#include "lve_model.hpp"
+
+//std
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+    /**
+     * @brief Builds the levels of detail of a mesh by quadric edge collapse on its index buffer.
+     * A collapse moves a vertex onto one of its neighbours, so that every level reads the vertices of the full mesh and only adds indices.
+     * The cost of a collapse is the quadric error of the moved vertex : the sum of its squared distances to the planes of the triangles merged into it.
+     * Each pass collapses the cheapest edges whose vertices were not touched yet by the pass and that do not flip a triangle,
+     * the vertices of open borders and attribute seams (edges of a single triangle) never move, so the outline and the UV islands stay in place.
+    */
+    class LveMeshSimplifier {
+    public:
+        static constexpr uint32_t MAX_LODS = 5; /** @brief Largest number of levels, the full mesh included. */
+        static constexpr uint32_t MIN_TRIANGLES = 1024; /** @brief Smaller meshes only have level 0. */
+        static constexpr float LOD_RATIO = 0.5f; /** @brief Triangle count of a level relative to the previous one. */
+
+        /**
+         * @brief Appends the levels of detail after the indices of the full mesh and fills builder.lods (level 0 is the full mesh).
+         * A level is kept if it removes at least a tenth of the triangles of the previous one, its indices are ordered for the vertex cache.
+         * @param builder : The mesh, its indices must only be the full mesh.
+        */
+        static void buildLods(LveModel::Builder& builder);
+
+        /**
+         * @brief Simplifies a triangle list down to a number of indices, or until no edge can be collapsed.
+         * @param vertices : The vertices, they are not changed.
+         * @param indices : The triangle list, replaced by the simplified one.
+         * @param targetIndexCount : The number of indices to reach.
+         * @return The estimated distance between the simplified and the original surfaces (square root of the largest collapse error).
+        */
+        static float simplify(const std::vector<LveModel::Vertex>& vertices, std::vector<uint32_t>& indices, size_t targetIndexCount);
+
+        /**
+         * @brief Picks the coarsest level whose error stays under a size on screen.
+         * @param lods : The levels of a model, level 0 first.
+         * @param screenSizePerUnit : The projected size of one model unit, as a fraction of the viewport height (see LveCamera::getProjectedSize).
+         * @param maxScreenError : The largest projected error allowed, as a fraction of the viewport height.
+         * @return The index of the level (0 if lods is empty).
+        */
+        static uint32_t selectLod(const std::vector<LveModel::Lod>& lods, float screenSizePerUnit, float maxScreenError);
+    };
+}  // namespace lve
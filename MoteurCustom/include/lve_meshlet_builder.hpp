@@ -0,0 +1,36 @@
+#pragma once
+
+#include "lve_model.hpp"
+
+//std
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+    /**
+     * @brief Splits the index buffer of a mesh into meshlets : clusters of at most MAX_VERTICES vertices and MAX_TRIANGLES neighbouring triangles,
+     * each one contiguous in the index buffer, with a bounding sphere for the frustum culling and a normal cone for the back face culling.
+     * A meshlet grows from a seed triangle by adding the adjacent triangle that brings the fewest new vertices (the oldest candidate on a tie),
+     * so that it stays compact, and the next meshlet starts next to the previous one.
+    */
+    class LveMeshletBuilder {
+    public:
+        static constexpr uint32_t MAX_VERTICES = 64; /** @brief Largest number of distinct vertices of a meshlet. */
+        static constexpr uint32_t MAX_TRIANGLES = 124; /** @brief Largest number of triangles of a meshlet. */
+        static constexpr uint32_t MIN_TRIANGLES = 4096; /** @brief Smaller meshes are drawn whole, culling their clusters would cost more than it saves. */
+
+        /**
+         * @brief Reorders the indices of a mesh meshlet by meshlet and fills builder.meshlets (the vertices are not changed).
+         * @param builder : The mesh.
+        */
+        static void build(LveModel::Builder& builder);
+
+        /**
+         * @brief Computes the bounding sphere and the normal cone of the triangles of a meshlet.
+         * @param vertices : The vertices of the mesh.
+         * @param indices : The indices of the mesh.
+         * @param meshlet : The meshlet, its firstIndex and indexCount must be set.
+        */
+        static void computeBounds(const std::vector<LveModel::Vertex>& vertices, const std::vector<uint32_t>& indices, LveModel::Meshlet& meshlet);
+    };
+}  // namespace lve
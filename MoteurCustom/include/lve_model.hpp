@@ -1,11 +1,13 @@
 #pragma once
 #include "lve_device.hpp"
-#include "lve_buffer.hpp"
+#include "lve_geometry_pool.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 
 #include "glm/glm.hpp"
+#include "glm/gtc/type_precision.hpp"
+#include "AABB.hpp"
 
 //std
 #include <memory>
@@ -17,6 +19,14 @@ namespace lve {
     */
     class LveModel {
     public:
+        /**
+         * @brief Layout of the vertex buffer of a model.
+        */
+        enum class VertexFormat {
+            Float, /** @brief Vertex : 44 bytes of floats, read by simple_shader.vert. */
+            Compact /** @brief CompactVertex : 20 bytes of quantized attributes, decoded by simple_shader_compact.vert. */
+        };
+
         /**
          * @brief Represents a vertex in the model.
         */
@@ -48,15 +58,79 @@ namespace lve {
             }
         };
 
+        /**
+         * @brief Quantized vertex of VertexFormat::Compact (see LveVertexQuantizer for the encoding).
+        */
+        struct CompactVertex {
+            glm::u16vec4 position; /** @brief Position relative to the mesh bounds, unorm 16 bits (w is padding, 3 component 16 bits formats are rarely supported for vertex buffers). */
+            uint32_t normal; /** @brief Octahedral normal, 2 snorm 16 bits. */
+            uint32_t color; /** @brief Color, 4 unorm 8 bits (alpha unused). */
+            uint32_t uv; /** @brief UV coordinates, 2 half floats. */
+
+            /**
+             * @brief Gets the binding descriptions for Vulkan vertex input.
+             * @return A vector of VkVertexInputBindingDescription.
+            */
+            static std::vector<VkVertexInputBindingDescription>getBindingDescriptions();
+
+            /**
+             * @brief Gets the attribute descriptions for Vulkan vertex input (same locations as Vertex).
+             * @return A vector of VkVertexInputAttributeDescription.
+            */
+            static std::vector<VkVertexInputAttributeDescription>getAttributeDescriptions();
+        };
+
+        /**
+         * @brief Push constants turning the unorm positions of a CompactVertex back into model space.
+        */
+        struct VertexDecode {
+            glm::vec4 positionOffset{ 0.f }; /** @brief Model space position of the unorm value 0 (the minimum of the mesh bounds). */
+            glm::vec4 positionScale{ 1.f }; /** @brief Model space size of the unorm range (the extent of the mesh bounds). */
+        };
+
+        /**
+         * @brief Cluster of neighbouring triangles, contiguous in the index buffer, with the bounds used to cull it (see LveMeshletBuilder).
+        */
+        struct Meshlet {
+            glm::vec3 center; /** @brief Center of the bounding sphere, in model space. */
+            float radius; /** @brief Radius of the bounding sphere. */
+            glm::vec3 coneApex; /** @brief Apex of the normal cone, every triangle faces away from the positions behind it along coneAxis. */
+            float coneCutoff; /** @brief Sine of the half angle of the normal cone, above 1 when the triangles face too many directions to be culled together. */
+            glm::vec3 coneAxis; /** @brief Average direction of the normals of the triangles. */
+            uint32_t firstIndex; /** @brief First index of the meshlet in the index buffer of the model. */
+            uint32_t indexCount; /** @brief Number of indices of the meshlet (3 per triangle). */
+
+            /**
+             * @brief Checks if every triangle of the meshlet faces away from a position.
+             * @param cameraPosition : The position of the camera, in model space.
+             * @return True if the meshlet can be skipped when back faces are not seen.
+            */
+            bool isBackFacing(const glm::vec3& cameraPosition) const {
+                return glm::dot(glm::normalize(coneApex - cameraPosition), coneAxis) >= coneCutoff;
+            }
+        };
+
+        /**
+         * @brief Level of detail : a range of the index buffer drawing the whole model with fewer triangles (see LveMeshSimplifier).
+         * Every level reads the same vertices, level 0 is the full mesh.
+        */
+        struct Lod {
+            uint32_t firstIndex; /** @brief First index of the level in the index buffer of the model. */
+            uint32_t indexCount; /** @brief Number of indices of the level. */
+            float error; /** @brief Estimated distance between the level and the full mesh, in model units (0 for level 0). */
+        };
+
         /**
          * @brief Represents a builder for creating a model.
         */
         struct Builder {
             std::vector<Vertex> vertices{}; /** @brief Vector of vertices. */
             std::vector<uint32_t> indices{}; /** @brief Vector of indices. */
+            std::vector<Meshlet> meshlets{}; /** @brief Meshlets covering the indices of level 0 (empty if the mesh is not split). */
+            std::vector<Lod> lods{}; /** @brief Levels of detail, ranges of indices (empty if the indices are only the full mesh). */
 
             /**
-             * @brief Loads a model from a file.
+             * @brief Loads a model from an OBJ file, on several threads (see LveObjLoader).
              * @param filepath : The path to the model file.
             */
             void loadModel(const std::string& filepath);
@@ -66,11 +140,29 @@ namespace lve {
          * @brief Constructs an LveModel object.
          * @param device : The Vulkan device.
          * @param builder : The model builder.
+         * @param vertexFormat : The layout of the vertex buffer.
+        */
+        LveModel(LveDevice& device, const LveModel::Builder& builder, VertexFormat vertexFormat = VertexFormat::Float);
+
+        /**
+         * @brief Constructs an LveModel object from vertex and index arrays (the arrays are copied into the staging ring, they may be released on return).
+         * @param device : The Vulkan device.
+         * @param vertices : The vertices.
+         * @param vertexCount : The number of vertices.
+         * @param indices : The indices of every level of detail (may be nullptr if indexCount is 0).
+         * @param indexCount : The number of indices.
+         * @param meshlets : The meshlets covering the indices of level 0 (may be nullptr if meshletCount is 0).
+         * @param meshletCount : The number of meshlets.
+         * @param lods : The levels of detail (may be nullptr if lodCount is 0, all the indices are then level 0).
+         * @param lodCount : The number of levels of detail.
+         * @param vertexFormat : The layout of the vertex buffer (the vertices are quantized for VertexFormat::Compact).
+         * Throws std::runtime_error if there are less than 3 vertices.
         */
-        LveModel(LveDevice& device, const LveModel::Builder& builder);
+        LveModel(LveDevice& device, const Vertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount,
+            const Meshlet* meshlets, uint32_t meshletCount, const Lod* lods, uint32_t lodCount, VertexFormat vertexFormat = VertexFormat::Float);
 
         /**
-         * @brief Destroys the LveModel object.
+         * @brief Destroys the LveModel object, after the end of its upload (its ranges of the geometry pool are released).
         */
         ~LveModel();
 
@@ -78,47 +170,137 @@ namespace lve {
         LveModel& operator=(const LveModel&) = delete;
 
         /**
-         * @brief Creates a model from a file.
+         * @brief Creates a model from a file, through its LveMeshCache when it is up to date (the cache is written otherwise).
          * @param device : The Vulkan device.
          * @param filePath : The path to the model file.
+         * @param optimize : Reorder the triangles and vertices with LveMeshOptimizer and split large meshes into meshlets when the file is imported (the cache keeps the result).
+         * The levels of detail are built in both cases.
+         * @param vertexFormat : The layout of the vertex buffer (the cache always keeps the float vertices).
          * @return A unique pointer to the created LveModel.
         */
-        static std::unique_ptr <LveModel> createModelFromFile(LveDevice& device, const std::string& filePath);
+        static std::unique_ptr <LveModel> createModelFromFile(LveDevice& device, const std::string& filePath, bool optimize = true, VertexFormat vertexFormat = VertexFormat::Float);
         
         /**
-         * @brief Binds the model to a Vulkan command buffer.
+         * @brief Binds the geometry block of the model to a Vulkan command buffer, as vertex buffer and index buffer.
+         * Models of the same block and index type can be drawn one after the other without binding again.
          * @param commandBuffer : The Vulkan command buffer.
         */
         void bind(VkCommandBuffer commandBuffer);
 
         /**
-         * @brief Draws the model using a Vulkan command buffer.
+         * @brief Draws the model at full detail using a Vulkan command buffer.
+         * @param commandBuffer : The Vulkan command buffer.
+         * @param instanceCount : The number of instances to draw.
+         * @param firstInstance : The index of the first instance (offset in the per-instance vertex buffers).
+        */
+        void draw(VkCommandBuffer commandBuffer, uint32_t instanceCount = 1, uint32_t firstInstance = 0);
+
+        /**
+         * @brief Draws a range of the indices of the model, such as a run of meshlets (the model must have an index buffer).
+         * @param commandBuffer : The Vulkan command buffer.
+         * @param firstIndex : The first index of the range, in the indices of the model.
+         * @param indexCount : The number of indices of the range.
+         * @param instanceCount : The number of instances to draw.
+         * @param firstInstance : The index of the first instance (offset in the per-instance vertex buffers).
+        */
+        void drawRange(VkCommandBuffer commandBuffer, uint32_t firstIndex, uint32_t indexCount, uint32_t instanceCount, uint32_t firstInstance);
+
+        /**
+         * @brief Draws the model with the parameters read from a buffer filled on the GPU (the model must have an index buffer).
          * @param commandBuffer : The Vulkan command buffer.
+         * @param buffer : The buffer holding a VkDrawIndexedIndirectCommand (its firstIndex and vertexOffset must come from getGeometryRange).
+         * @param offset : The offset of the command in the buffer.
+        */
+        void drawIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset);
+
+        /**
+         * @brief Gets the number of indices drawn by the model at full detail.
+         * @return The index count of level 0 (0 if the model has no index buffer).
+        */
+        uint32_t getIndexCount() const { return hasIndexBuffer ? indexCount : 0; }
+
+        /**
+         * @brief Gets the width of the indices stored in the index buffer.
+         * @return VK_INDEX_TYPE_UINT16 for meshes of at most 65536 vertices, VK_INDEX_TYPE_UINT32 otherwise.
+        */
+        VkIndexType getIndexType() const { return indexType; }
+
+        /**
+         * @brief Gets the place of the vertices and indices of the model in the geometry pool, it does not change between two beginFrame of the pool.
+         * @return The block, the first vertex and the first index of the model.
+        */
+        LveGeometryPool::MeshRange getGeometryRange() const { return lveDevice.getGeometryPool().getRange(mesh); }
+
+        /**
+         * @brief Gets the box enclosing every vertex of the model.
+         * @return The bounding box in model space.
+        */
+        const AABB& getBoundingBox() const { return boundingBox; }
+
+        /**
+         * @brief Gets the meshlets of the model, contiguous runs of its index buffer that can be culled one by one.
+         * @return The meshlets in index order (empty if the model is not split).
+        */
+        const std::vector<Meshlet>& getMeshlets() const { return meshlets; }
+
+        /**
+         * @brief Gets the levels of detail of the model, from the full mesh to the coarsest one.
+         * @return The levels (level 0 only if the model was not simplified, empty if it has no index buffer).
+        */
+        const std::vector<Lod>& getLods() const { return lods; }
+
+        /**
+         * @brief Gets the layout of the vertex buffer, the pipeline drawing the model must match it.
+         * @return The vertex format.
+        */
+        VertexFormat getVertexFormat() const { return vertexFormat; }
+
+        /**
+         * @brief Gets the push constants decoding the positions of a VertexFormat::Compact model.
+         * @return The position offset and scale.
+        */
+        const VertexDecode& getVertexDecode() const { return vertexDecode; }
+
+        /**
+         * @brief Checks if the vertex and index buffers have been uploaded, without waiting.
+         * @return True if the model can be drawn.
         */
-        void draw(VkCommandBuffer commandBuffer);
+        bool isReady();
 
 
     private:
         /**
-         * @brief Creates the vertex buffers for the model.
-         * @param vertices : The vector of vertices.
+         * @brief Places the vertices and indices of the model in the geometry pool and uploads them, in its vertex format (the bounding box must be computed first).
+         * The indices are stored on 16 bits when every vertex can be addressed with them.
+         * @param vertices : The vertices.
+         * @param vertexCount : The number of vertices.
+         * @param indices : The indices.
+         * @param indexCount : The number of indices.
         */
-        void createVertexBuffers(const std::vector<Vertex>& vertices);
+        void createGeometry(const Vertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount);
 
         /**
-         * @brief Creates the index buffers for the model.
-         * @param indices : The vector of indices.
+         * @brief Computes the box enclosing the vertices of the model.
+         * @param vertices : The vertices.
+         * @param count : The number of vertices (at least 1, checked by the constructor).
         */
-        void createIndexBuffers(const std::vector<uint32_t>& indices);
+        void computeBoundingBox(const Vertex* vertices, uint32_t count);
 
 
 
         // ----------------- Variable -----------------
         LveDevice& lveDevice; /** @brief Vulkan device. */
-        std::unique_ptr<LveBuffer> vertexBuffer; /** @brief Vertex buffer. */
+        uint32_t mesh = LveGeometryPool::INVALID_MESH; /** @brief Handle of the vertices and indices in the geometry pool. */
         uint32_t vertexCount; /** @brief Number of vertices. */
-        bool hasIndexBuffer = false; /** @brief Flag indicating the presence of an index buffer. */
-        std::unique_ptr<LveBuffer> indexBuffer; /** @brief Index buffer. */
-        uint32_t indexCount; /** @brief Number of indices. */
+        bool hasIndexBuffer = false; /** @brief Flag indicating the presence of indices. */
+        uint32_t indexCount; /** @brief Number of indices of level 0. */
+        VkIndexType indexType = VK_INDEX_TYPE_UINT32; /** @brief Width of the indices in the geometry pool. */
+        AABB boundingBox{}; /** @brief Box enclosing every vertex, in model space. */
+        std::vector<Meshlet> meshlets; /** @brief Meshlets covering the indices of level 0, in index order. */
+        std::vector<Lod> lods; /** @brief Levels of detail, level 0 first. */
+        VertexFormat vertexFormat; /** @brief Layout of the vertex buffer. */
+        VertexDecode vertexDecode{}; /** @brief Decoding of the quantized positions (identity for VertexFormat::Float). */
+        uint64_t uploadTicket = 0; /** @brief Ticket of the upload of the geometry in the LveUploadQueue. */
+        bool uploaded = false; /** @brief True once the upload is known to be complete. */
     };
 }
\ No newline at end of file
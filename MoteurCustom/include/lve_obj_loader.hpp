@@ -0,0 +1,58 @@
+#pragma once
+
+#include "lve_model.hpp"
+
+//libs
+#include "tiny_obj_loader.h"
+
+//std
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lve {
+    /**
+     * @brief Multithreaded import of OBJ files into LveModel vertices and indices.
+     * tinyobj parses the text, then the corners of every face are built on several threads (the shapes are split in equal ranges of corners, whatever their size)
+     * and deduplicated with open addressing hash tables, one per partition of the hash values, each filled by its own thread.
+     * The vertices come out in the order of their first corner, exactly as with a single std::unordered_map.
+    */
+    class LveObjLoader {
+    public:
+        /**
+         * @brief Loads an OBJ file.
+         * @param filepath : The path to the OBJ file.
+         * @param vertices : Receives the unique vertices.
+         * @param indices : Receives one index per corner.
+         * @param threadCount : The number of threads (0 for one per hardware thread).
+        */
+        static void load(const std::string& filepath, std::vector<LveModel::Vertex>& vertices, std::vector<uint32_t>& indices, uint32_t threadCount = 0);
+
+        /**
+         * @brief Builds the vertex of every corner of the parsed shapes, and its hash.
+         * @param attrib : The attributes parsed by tinyobj.
+         * @param shapes : The shapes parsed by tinyobj.
+         * @param corners : Receives the vertex of each corner, shape after shape.
+         * @param hashes : Receives the hash of each corner (equal vertices have equal hashes).
+         * @param threadCount : The number of threads (0 for one per hardware thread).
+        */
+        static void buildCorners(const tinyobj::attrib_t& attrib, const std::vector<tinyobj::shape_t>& shapes, std::vector<LveModel::Vertex>& corners, std::vector<uint64_t>& hashes, uint32_t threadCount = 0);
+
+        /**
+         * @brief Merges the equal corners into unique vertices.
+         * @param corners : The vertex of each corner.
+         * @param hashes : The hash of each corner, from buildCorners.
+         * @param vertices : Receives the unique vertices, in the order of their first corner.
+         * @param indices : Receives the index of the vertex of each corner.
+         * @param threadCount : The number of threads (0 for one per hardware thread).
+        */
+        static void deduplicate(const std::vector<LveModel::Vertex>& corners, const std::vector<uint64_t>& hashes, std::vector<LveModel::Vertex>& vertices, std::vector<uint32_t>& indices, uint32_t threadCount = 0);
+
+        /**
+         * @brief Hashes a vertex (-0 and +0 hash the same, as they compare equal).
+         * @param vertex : The vertex.
+         * @return The hash.
+        */
+        static uint64_t hashVertex(const LveModel::Vertex& vertex);
+    };
+}  // namespace lve
@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 namespace lve {
+    class LvePipelineRegistry;
+
     /**
      * @brief Configuration structure for Vulkan pipeline settings.
     */
@@ -31,16 +33,18 @@ namespace lve {
     };
 
     /**
-     * @brief Represents a Vulkan graphics pipeline.
+     * @brief Represents a Vulkan graphics pipeline, created and shared by LvePipelineRegistry (see LveDevice::getPipelineRegistry).
+     * It keeps its shader paths and a copy of its configuration, so that the registry can build it again when a shader changes
+     * and swap the new Vulkan pipeline in between two frames.
     */
     class LvePipeline {
     public:
         /**
-         * @brief Constructs an LvePipeline.
+         * @brief Constructs an LvePipeline without Vulkan pipeline, LvePipelineRegistry builds it.
          * @param device : The LveDevice reference.
          * @param vertFilePath : The path to the vertex shader file.
          * @param fragFilePath : The path to the fragment shader file.
-         * @param configInfo : The pipeline configuration information.
+         * @param configInfo : The pipeline configuration information, copied.
         */
         LvePipeline(LveDevice& device, const std::string& vertFilePath, const std::string& fragFilePath, const PipeLineConfigInfo& configInfo);
         
@@ -51,7 +55,30 @@ namespace lve {
 
         LvePipeline(const LvePipeline&) = delete;
         LvePipeline& operator=(const LvePipeline&) = delete;
-        LvePipeline() = default;
+
+        /**
+         * @brief Gets the path of the vertex shader.
+         * @return The path.
+        */
+        const std::string& getVertFilePath() const { return vertFilePath; }
+
+        /**
+         * @brief Gets the path of the fragment shader.
+         * @return The path.
+        */
+        const std::string& getFragFilePath() const { return fragFilePath; }
+
+        /**
+         * @brief Gets the configuration the pipeline was created with.
+         * @return The configuration.
+        */
+        const PipeLineConfigInfo& getConfigInfo() const { return configInfo; }
+
+        /**
+         * @brief Checks that the Vulkan pipeline has been compiled, a pipeline requested from the registry is bound once ready.
+         * @return True if the pipeline can be bound.
+        */
+        bool isReady() const { return graphicsPipeline != VK_NULL_HANDLE; }
 
         /**
          * @brief Binds the graphics pipeline to the specified Vulkan command buffer.
@@ -71,7 +98,21 @@ namespace lve {
         */
         static void enableAlphaBlending(PipeLineConfigInfo& configInfo);
 
-    private:
+        /**
+         * @brief Copies a configuration, the internal pointers of the copy point to its own members.
+         * @param source : The configuration to copy.
+         * @param destination : Receives the copy.
+        */
+        static void copyPipeLineConfigInfo(const PipeLineConfigInfo& source, PipeLineConfigInfo& destination);
+
+        /**
+         * @brief Creates a Vulkan shader module from SPIR-V code.
+         * @param device : The LveDevice reference.
+         * @param code : The SPIR-V code.
+         * @return The shader module.
+        */
+        static VkShaderModule createShaderModule(LveDevice& device, const std::vector<char>& code);
+
         /**
          * @brief Reads the content of a file and returns it as a vector of characters.
          * @param filepath : The path to the file.
@@ -79,27 +120,32 @@ namespace lve {
         */
         static std::vector<char> readFile(const std::string& filepath);
 
+
+    private:
+        friend class LvePipelineRegistry; /** @brief Friend class building the pipelines and swapping them on reload. */
+
         /**
-         * @brief Creates the Vulkan graphics pipeline using specified shader files and configuration.
-         * @param vertFilepath : The path to the vertex shader file.
-         * @param fragFilepath : The path to the fragment shader file.
-         * @param configInfo : The pipeline configuration information.
+         * @brief Creates a Vulkan graphics pipeline from the configuration of this pipeline and shader modules (thread safe).
+         * @param vertShaderModule : The vertex shader module.
+         * @param fragShaderModule : The fragment shader module.
+         * @return The Vulkan pipeline.
         */
-        void createGraphicsPipeline(const std::string& vertFilepath, const std::string& fragFilepath, const PipeLineConfigInfo& configInfo);
-        
+        VkPipeline createGraphicsPipeline(VkShaderModule vertShaderModule, VkShaderModule fragShaderModule) const;
+
         /**
-         * @brief Creates a Vulkan shader module from the provided shader code.
-         * @param code : The shader code.
-         * @param shaderModule : Pointer to store the created shader module.
+         * @brief Replaces the Vulkan pipeline bound by bind.
+         * @param pipeline : The new Vulkan pipeline.
+         * @return The previous Vulkan pipeline, to destroy once no frame in flight uses it.
         */
-        void createShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule);
+        VkPipeline setGraphicsPipeline(VkPipeline pipeline);
 
 
 
         // ----------------- Variable -----------------
         LveDevice& lveDevice; /** @brief Reference to the LveDevice. */
-        VkPipeline graphicsPipeline; /** @brief Vulkan graphics pipeline. */
-        VkShaderModule vertShaderModule; /** @brief Vertex shader module. */
-        VkShaderModule fragShaderModule; /** @brief Fragment shader module. */
+        VkPipeline graphicsPipeline = VK_NULL_HANDLE; /** @brief Vulkan graphics pipeline. */
+        std::string vertFilePath; /** @brief Path of the vertex shader. */
+        std::string fragFilePath; /** @brief Path of the fragment shader. */
+        PipeLineConfigInfo configInfo{}; /** @brief Copy of the configuration, to build the pipeline again. */
     };
 }
\ No newline at end of file
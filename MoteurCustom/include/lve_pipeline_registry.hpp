@@ -0,0 +1,257 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_pipeline.hpp"
+
+//std
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+    /**
+     * @brief Content of the pipeline registry.
+    */
+    struct LvePipelineRegistryStats {
+        uint32_t pipelineCount = 0; /** @brief Number of live pipelines. */
+        uint32_t shaderModuleCount = 0; /** @brief Number of live shader modules. */
+        uint32_t sharedRequestCount = 0; /** @brief Number of getPipeline calls answered with an existing pipeline. */
+        uint32_t reloadCount = 0; /** @brief Number of pipelines rebuilt after a shader change. */
+        uint32_t pendingBuildCount = 0; /** @brief Number of requested pipelines not compiled yet. */
+    };
+
+    /**
+     * @brief Creates the graphics pipelines and shares them : a pipeline is identified by its shader paths and its configuration (render pass and layout included),
+     * so that asking twice for the same one gives the same LvePipeline, and a shader module is created once per SPIR-V file for every pipeline using it.
+     * With the hot reload, a thread watches the modification time of the SPIR-V files of the live pipelines and, once a file has stopped changing,
+     * creates its new shader module and builds the pipelines using it again (with the pipeline cache), without blocking the frames.
+     * The rebuilt pipelines are swapped in by beginFrame, and their old Vulkan pipelines are destroyed MAX_FRAMES_IN_FLIGHT frames later.
+     * A file that cannot be read or compiled keeps the previous pipelines.
+     * The pipelines asked with requestPipeline are compiled by a pool of threads (vkCreateGraphicsPipelines may run on several threads with the same pipeline cache),
+     * so that the render systems can describe all their pipelines up front without waiting for each one : they are made ready by beginFrame like the rebuilt ones.
+    */
+    class LvePipelineRegistry {
+    public:
+        static constexpr std::chrono::milliseconds WATCH_INTERVAL{ 250 }; /** @brief Time between two checks of the SPIR-V files. */
+        static constexpr uint32_t MAX_COMPILER_THREADS = 8; /** @brief Largest number of threads compiling the requested pipelines. */
+
+        /**
+         * @brief Constructor, the hot reload is disabled.
+         * @param device : The LveDevice reference.
+        */
+        LvePipelineRegistry(LveDevice& device);
+
+        /**
+         * @brief Destructor stopping the watcher and the compiler threads, every pipeline must have been released.
+        */
+        ~LvePipelineRegistry();
+
+        LvePipelineRegistry(const LvePipelineRegistry&) = delete;
+        LvePipelineRegistry& operator=(const LvePipelineRegistry&) = delete;
+
+        /**
+         * @brief Gets the pipeline of shaders and a configuration, creating it if no live pipeline matches (thread safe).
+         * The pipeline lives as long as a shared pointer to it, its layout must stay valid until then.
+         * A pipeline given by requestPipeline and not compiled yet is returned as it is, not ready.
+         * @param vertFilePath : The path to the vertex shader file.
+         * @param fragFilePath : The path to the fragment shader file.
+         * @param configInfo : The pipeline configuration information.
+         * @return The shared pipeline.
+        */
+        std::shared_ptr<LvePipeline> getPipeline(const std::string& vertFilePath, const std::string& fragFilePath, const PipeLineConfigInfo& configInfo);
+
+        /**
+         * @brief Gets the pipeline of shaders and a configuration like getPipeline, but a new pipeline is compiled by the compiler threads (thread safe).
+         * The shader modules are created before returning, the pipeline cannot be bound until LvePipeline::isReady, which a beginFrame after its compilation makes true.
+         * A compilation error is thrown by that beginFrame.
+         * @param vertFilePath : The path to the vertex shader file.
+         * @param fragFilePath : The path to the fragment shader file.
+         * @param configInfo : The pipeline configuration information.
+         * @return The shared pipeline, ready or not.
+        */
+        std::shared_ptr<LvePipeline> requestPipeline(const std::string& vertFilePath, const std::string& fragFilePath, const PipeLineConfigInfo& configInfo);
+
+        /**
+         * @brief Waits until every requested pipeline has been compiled, the next beginFrame makes them ready.
+        */
+        void waitForPipelines();
+
+        /**
+         * @brief Starts or stops the thread rebuilding the pipelines whose SPIR-V files change.
+         * @param enabled : True to watch the files.
+        */
+        void setHotReload(bool enabled);
+
+        /**
+         * @brief Waits for the compiler threads, then stops the hot reload and the creation of pipelines until the returned lock is released (thread safe).
+         * Held while the swap chain is recreated, so that no pipeline is built with a render pass being replaced.
+         * @return The lock of the builds.
+        */
+        std::unique_lock<std::mutex> pauseBuilds();
+
+        /**
+         * @brief Starts a frame (thread safe) : the compiled and rebuilt pipelines replace the old ones, and the pipelines replaced MAX_FRAMES_IN_FLIGHT frames ago are destroyed.
+         * Must be called after the fence of the frame has been waited on, before recording it.
+        */
+        void beginFrame();
+
+        /**
+         * @brief Gets the content of the registry (thread safe).
+         * @return The statistics.
+        */
+        LvePipelineRegistryStats getStats() const;
+
+
+    private:
+        /**
+         * @brief Identity of a pipeline.
+        */
+        struct Key {
+            std::string vertFilePath; /** @brief Path of the vertex shader. */
+            std::string fragFilePath; /** @brief Path of the fragment shader. */
+            std::vector<uint32_t> config; /** @brief Every field of the configuration read by the pipeline creation, as words. */
+
+            bool operator==(const Key& other) const { return vertFilePath == other.vertFilePath && fragFilePath == other.fragFilePath && config == other.config; }
+        };
+
+        /**
+         * @brief Hash of a pipeline key.
+        */
+        struct KeyHash {
+            std::size_t operator()(const Key& key) const;
+        };
+
+        /**
+         * @brief A live pipeline of the registry.
+        */
+        struct Entry {
+            std::weak_ptr<LvePipeline> pipeline; /** @brief The pipeline, expired while its last owner releases it. */
+            LvePipeline* rawPipeline = nullptr; /** @brief The pipeline, valid until releasePipeline removes the entry. */
+        };
+
+        /**
+         * @brief A SPIR-V file and its shader module.
+        */
+        struct ShaderModule {
+            VkShaderModule module = VK_NULL_HANDLE; /** @brief Shader module of the file content. */
+            std::filesystem::file_time_type writeTime{}; /** @brief Modification time of the file when the module was created. */
+            std::filesystem::file_time_type changedWriteTime{}; /** @brief Modification time seen by the last check, the file is reloaded when it stays the same for a check. */
+            uint32_t pipelineCount = 0; /** @brief Number of live pipelines using the module. */
+        };
+
+        /**
+         * @brief A compiled or rebuilt Vulkan pipeline waiting for beginFrame.
+        */
+        struct PendingSwap {
+            LvePipeline* pipeline = nullptr; /** @brief Pipeline receiving the new Vulkan pipeline. */
+            VkPipeline graphicsPipeline = VK_NULL_HANDLE; /** @brief New Vulkan pipeline. */
+        };
+
+        /**
+         * @brief A replaced Vulkan pipeline waiting for the frames in flight.
+        */
+        struct RetiredPipeline {
+            VkPipeline graphicsPipeline = VK_NULL_HANDLE; /** @brief Old Vulkan pipeline. */
+            uint64_t frame = 0; /** @brief Frame during which it was replaced. */
+        };
+
+        /**
+         * @brief Builds the key of a pipeline.
+         * @param vertFilePath : The path to the vertex shader file.
+         * @param fragFilePath : The path to the fragment shader file.
+         * @param configInfo : The pipeline configuration information.
+         * @return The key.
+        */
+        static Key makeKey(const std::string& vertFilePath, const std::string& fragFilePath, const PipeLineConfigInfo& configInfo);
+
+        /**
+         * @brief Finds the live pipeline of a key and counts a shared request (the build mutex must be locked).
+         * @param key : The key of the pipeline.
+         * @return The shared pipeline, or nullptr if there is none.
+        */
+        std::shared_ptr<LvePipeline> findPipeline(const Key& key);
+
+        /**
+         * @brief Adds a pipeline whose shader modules have been acquired, releasePipeline is called with its last shared pointer (the build mutex must be locked).
+         * @param key : The key of the pipeline.
+         * @param pipeline : The new pipeline, owned by the returned pointer.
+         * @return The shared pipeline.
+        */
+        std::shared_ptr<LvePipeline> addPipeline(Key key, LvePipeline* pipeline);
+
+        /**
+         * @brief Acquires the shader modules of a pipeline, both or none (the build mutex must be locked).
+         * @param vertFilePath : The path to the vertex shader file.
+         * @param fragFilePath : The path to the fragment shader file.
+        */
+        void acquireShaderModules(const std::string& vertFilePath, const std::string& fragFilePath);
+
+        /**
+         * @brief Gets the shader module of a file, creating it on first use, and counts one more pipeline using it (the build mutex must be locked).
+         * @param filePath : The path to the SPIR-V file.
+         * @return The shader module.
+        */
+        VkShaderModule acquireShaderModule(const std::string& filePath);
+
+        /**
+         * @brief Counts one less pipeline using a shader module, destroying it when none is left (the build mutex must be locked).
+         * @param filePath : The path to the SPIR-V file.
+        */
+        void releaseShaderModule(const std::string& filePath);
+
+        /**
+         * @brief Removes a pipeline whose last shared pointer was released and destroys it, once a compiler thread building it has finished.
+         * @param pipeline : The pipeline.
+        */
+        void releasePipeline(LvePipeline* pipeline);
+
+        /**
+         * @brief Body of a compiler thread : compiles the requested pipelines one after the other, without the build mutex so that the requests and the other threads go on.
+        */
+        void compilePipelines();
+
+        /**
+         * @brief Body of the watcher thread.
+        */
+        void watchShaders();
+
+        /**
+         * @brief Reloads the SPIR-V files that changed and builds the pipelines using them again (watcher thread).
+        */
+        void reloadChangedShaders();
+
+
+
+        // ----------------- Variable -----------------
+        LveDevice& lveDevice; /** @brief Reference to the LveDevice. */
+        std::unordered_map<Key, Entry, KeyHash> pipelines; /** @brief Live pipelines, owned by their shared pointers. */
+        std::unordered_map<std::string, ShaderModule> shaderModules; /** @brief Shader modules of the live pipelines, by path. */
+        std::vector<PendingSwap> pendingSwaps; /** @brief Pipelines compiled by the compiler threads or rebuilt by the watcher. */
+        std::deque<LvePipeline*> buildQueue; /** @brief Requested pipelines waiting for a compiler thread. */
+        std::vector<LvePipeline*> compilingPipelines; /** @brief Pipelines being compiled by the compiler threads. */
+        std::exception_ptr buildError; /** @brief First compilation error of the compiler threads, thrown by beginFrame. */
+        std::vector<RetiredPipeline> retiredPipelines; /** @brief Replaced pipelines, oldest first. */
+        uint64_t frameCount = 0; /** @brief Number of beginFrame calls. */
+        uint32_t sharedRequestCount = 0; /** @brief Number of getPipeline calls answered with an existing pipeline. */
+        uint32_t reloadCount = 0; /** @brief Number of pipelines rebuilt after a shader change. */
+
+        mutable std::mutex mutex; /** @brief Protects the maps and the lists, held briefly. */
+        std::mutex buildMutex; /** @brief Held while shader modules and pipelines are created or destroyed, taken before mutex (the compiler threads only take mutex). */
+        std::vector<std::thread> compilers; /** @brief Compiler threads, started by the first requestPipeline. */
+        std::condition_variable buildCondition; /** @brief Wakes the compiler threads up for a request or to stop them, and waitForPipelines when a compilation ends. */
+        bool stopCompilers = false; /** @brief Asks the compiler threads to stop. */
+        std::thread watcher; /** @brief Thread of the hot reload. */
+        std::condition_variable watcherCondition; /** @brief Wakes the watcher up to stop it. */
+        std::mutex watcherMutex; /** @brief Protects stopWatcher. */
+        bool stopWatcher = false; /** @brief Asks the watcher to stop. */
+    };
+}  // namespace lve
@@ -43,6 +43,12 @@ namespace lve {
         */
         float getAspectRatio() const { return lveSwapChain->extentAspectRatio(); }
 
+        /**
+         * @brief Gets the size of the swap chain images.
+         * @return The extent of the swap chain.
+        */
+        VkExtent2D getSwapChainExtent() const { return lveSwapChain->getSwapChainExtent(); }
+
         /**
          * @brief Checks if a frame is currently in progress.
          * @return True if a frame is in progress, false otherwise.
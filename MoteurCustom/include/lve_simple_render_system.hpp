@@ -5,12 +5,52 @@
 #include "lve_pipeline.hpp"
 #include "lve_game_object.hpp"
 #include "lve_frame_info.hpp"
+#include "lve_buffer.hpp"
+#include "lve_transform_batch.hpp"
+#include "lve_frustum.hpp"
+#include "lve_gpu_culling.hpp"
+#include "lve_utils.hpp"
 
 //std
+#include <array>
 #include <memory>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace lve {
+    /**
+     * @brief Per-instance data read by the simple shader through a vertex buffer bound with an instance input rate.
+    */
+    struct SimpleInstanceData {
+        glm::mat4 modelMatrix{ 1.f }; /** @brief Model (object to world) matrix. */
+        glm::mat4 normalMatrix{ 1.f }; /** @brief Normal matrix (only the upper 3x3 part is used). */
+
+        /**
+         * @brief Gets the binding descriptions for the per-instance vertex input (binding 1).
+         * @return A vector of VkVertexInputBindingDescription.
+        */
+        static std::vector<VkVertexInputBindingDescription> getBindingDescriptions();
+
+        /**
+         * @brief Gets the attribute descriptions for the per-instance vertex input (locations 4 to 11).
+         * @return A vector of VkVertexInputAttributeDescription.
+        */
+        static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions();
+    };
+
+    /**
+     * @brief Counters of the last frame rendered by the simple render system.
+    */
+    struct RenderStats {
+        uint32_t objectCount = 0; /** @brief Number of objects with a model. */
+        uint32_t visibleCount = 0; /** @brief Number of objects that passed the frustum culling. */
+        uint32_t drawCount = 0; /** @brief Number of draw calls recorded. */
+        uint32_t meshletCount = 0; /** @brief Number of meshlets of the visible objects drawn meshlet by meshlet. */
+        uint32_t visibleMeshletCount = 0; /** @brief Number of those meshlets that passed the frustum and normal cone culling. */
+        uint32_t simplifiedCount = 0; /** @brief Number of visible objects drawn with a level of detail other than the full mesh. */
+    };
+
     /**
      * @brief Represents a simple rendering system using Vulkan.
     */
@@ -21,8 +61,9 @@ namespace lve {
          * @param device : The LveDevice reference.
          * @param renderPass : The Vulkan render pass.
          * @param globalSetLayout : The Vulkan descriptor set layout.
+         * @param vertexFormat : The vertex format of the loaded models, its pipeline is requested up front (the other one when a model uses it).
         */
-        SimpleRenderSystem(LveDevice& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout);
+        SimpleRenderSystem(LveDevice& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout, LveModel::VertexFormat vertexFormat = LveModel::VertexFormat::Float);
         
         /**
          * @brief Destructor to release associated resources.
@@ -34,12 +75,102 @@ namespace lve {
 
         /**
          * @brief Renders game objects using the provided frame information.
+         * Objects sharing the same model are drawn with a single instanced draw call.
+         * The matrices of the transforms that changed are rebuilt in one batched pass before being copied to the instance buffer.
+         * Objects whose transformed model box is outside the camera frustum are skipped.
+         * With the GPU-driven path, only the indirect draws filled by cullGameObjects are recorded.
+         * Each model is drawn with the pipeline of its vertex format.
+         * Each object is drawn with the coarsest level of detail of its model whose error stays under LOD_SCREEN_ERROR on screen,
+         * so the batches group the objects by model and level.
          * @param frameInfo : The frame information.
         */
         void renderGameObjects(FrameInfo& frameInfo);
 
+        /**
+         * @brief Records the compute culling of the GPU-driven path (does nothing when the CPU path is used).
+         * Must be called before the render pass begins.
+         * @param frameInfo : The frame information.
+        */
+        void cullGameObjects(FrameInfo& frameInfo);
+
+        /**
+         * @brief Switches between the CPU path and the GPU-driven path (compute culling and indirect draws).
+         * @param enabled : True to cull and fill the draws on the GPU, false to do it on the CPU.
+        */
+        void setGpuDriven(bool enabled);
+
+        /**
+         * @brief Checks if the GPU-driven path is used.
+         * @return True if the objects are culled on the GPU, false otherwise.
+        */
+        bool isGpuDriven() const { return gpuDriven; }
+
+        /**
+         * @brief Enables or disables the frustum culling.
+         * @param enabled : True to skip the objects outside the camera frustum, false to draw everything.
+        */
+        void setFrustumCulling(bool enabled) { frustumCulling = enabled; }
+
+        /**
+         * @brief Enables or disables the culling of the meshlets of the models split by LveMeshletBuilder (CPU path only).
+         * @param enabled : True to test the meshlets of each visible object against the frustum and, when the pipelines cull the back faces, their normal cone, false to draw the models whole.
+        */
+        void setClusterCulling(bool enabled) { clusterCulling = enabled; }
+
+        /**
+         * @brief Enables or disables the selection of the levels of detail (CPU path only).
+         * @param enabled : True to draw each object with the level matching its size on screen, false to always draw the full meshes.
+        */
+        void setLodSelection(bool enabled) { lodSelection = enabled; }
+
+        /**
+         * @brief Gets the counters of the last rendered frame.
+         * @return The render statistics.
+        */
+        const RenderStats& getStats() const { return stats; }
+
 
     private:
+        static constexpr float LOD_SCREEN_ERROR = 0.001f; /** @brief Largest error of a level of detail on screen, as a fraction of the viewport height (about a pixel at 1080p). */
+
+        /**
+         * @brief Range of the instance buffer drawn with one level of detail of a model.
+        */
+        struct InstanceBatch {
+            LveModel* model; /** @brief Model shared by every instance of the batch. */
+            uint32_t lod; /** @brief Level of detail of the model drawn by the batch. */
+            uint32_t firstInstance; /** @brief Index of the first instance in the instance buffer. */
+            uint32_t instanceCount; /** @brief Number of instances in the batch. */
+        };
+
+        /**
+         * @brief Hash of a (model, level of detail) batch key.
+        */
+        struct BatchKeyHash {
+            std::size_t operator()(const std::pair<LveModel*, uint32_t>& key) const {
+                std::size_t seed = 0;
+                hashCombine(seed, key.first, key.second);
+                return seed;
+            }
+        };
+
+        /**
+         * @brief Picks the level of detail of an object from the error of the levels projected at the point of its bounding sphere nearest to the camera.
+         * @param camera : The camera.
+         * @param model : The model of the object.
+         * @param transform : The transform of the object.
+         * @return The index of the level (0 when the selection is disabled or the camera is inside the sphere).
+        */
+        uint32_t selectLod(const LveCamera& camera, const LveModel& model, TransformComponent& transform) const;
+
+        /**
+         * @brief Gets the instance buffer of a frame, growing it if it cannot hold enough instances.
+         * @param frameIndex : The index of the frame in flight.
+         * @param instanceCount : The number of instances that must fit in the buffer.
+         * @return The mapped instance buffer.
+        */
+        LveBuffer& getInstanceBuffer(int frameIndex, uint32_t instanceCount);
+
         /**
          * @brief Gets the current time in seconds.
          * @return The current time.
@@ -53,16 +184,58 @@ namespace lve {
         void createPipelineLayout(VkDescriptorSetLayout globalSetLayout);
 
         /**
-         * @brief Creates the Vulkan pipeline for rendering.
-         * @param renderPass : The Vulkan render pass.
+         * @brief Requests the pipeline drawing the models of a vertex format, compiled in the background by the registry.
+         * @param vertexFormat : The vertex format of the models.
         */
-        void createPipeline(VkRenderPass renderPass);
+        void createPipeline(LveModel::VertexFormat vertexFormat);
+
+        /**
+         * @brief Binds the pipeline of the vertex format of a model and its geometry block if others are bound, then the push constants of the model.
+         * @param commandBuffer : The Vulkan command buffer.
+         * @param model : The model about to be drawn.
+         * @return False if the pipeline is still compiling (or was just requested), the model is not drawn this frame.
+        */
+        bool bindModel(VkCommandBuffer commandBuffer, LveModel& model);
+
+        /**
+         * @brief Draws the meshlets of one instance that are inside the frustum and not facing away from the camera, one draw per run of consecutive meshlets.
+         * The frustum and the camera are brought into model space, so the meshlet bounds are used as they are.
+         * @param frameInfo : The frame information.
+         * @param model : The model of the instance (bound, with meshlets).
+         * @param transform : The transform of the instance.
+         * @param instance : The index of the instance in the instance buffer.
+        */
+        void drawMeshlets(FrameInfo& frameInfo, LveModel& model, TransformComponent& transform, uint32_t instance);
 
 
 
         // ----------------- Variable -----------------
         LveDevice& lveDevice; /** @brief Reference to the LveDevice. */
-        std::unique_ptr<LvePipeline> lvePipeline; /** @brief Unique pointer to LvePipeline. */
-        VkPipelineLayout pipelineLayout; /** @brief Vulkan pipeline layout. */
+        VkRenderPass renderPass; /** @brief Render pass of the pipelines. */
+        std::array<std::shared_ptr<LvePipeline>, 2> lvePipelines; /** @brief Pipeline of each LveModel::VertexFormat from the registry of the device, requested by the constructor or when first used. */
+        LvePipeline* boundPipeline = nullptr; /** @brief Pipeline bound in the command buffer being recorded. */
+        uint32_t boundBlock = UINT32_MAX; /** @brief Geometry block bound in the command buffer being recorded. */
+        VkIndexType boundIndexType = VK_INDEX_TYPE_UINT32; /** @brief Index type of the bound geometry block. */
+        VkPipelineLayout pipelineLayout; /** @brief Vulkan pipeline layout, shared by the pipelines. */
+        bool backFaceCulling = false; /** @brief True if the pipelines discard the back faces, the normal cones may then skip whole meshlets. */
+
+        std::vector<std::unique_ptr<LveBuffer>> instanceBuffers; /** @brief Per-frame host visible instance buffers. */
+        std::vector<InstanceBatch> batches; /** @brief Instanced draws of the current frame (reused between frames). */
+        std::unordered_map<std::pair<LveModel*, uint32_t>, uint32_t, BatchKeyHash> batchLookup; /** @brief Index of the batch of each model and level of detail (reused between frames). */
+        std::vector<uint32_t> objectBatches; /** @brief Batch of each drawn object, in iteration order (reused between frames). */
+        std::vector<TransformComponent*> visibleTransforms; /** @brief Transform of each drawn object, in iteration order (reused between frames). */
+        std::vector<TransformComponent*> instanceTransforms; /** @brief Transform of each instance, in instance buffer order (reused between frames). */
+
+        LveTransformBatch transformBatch; /** @brief Dirty transforms of the current frame, rebuilt together by the SIMD kernel. */
+        std::vector<TransformComponent*> dirtyTransforms; /** @brief Components receiving the matrices of transformBatch (reused between frames). */
+        std::vector<glm::mat4> batchModelMatrices; /** @brief Model matrices computed by transformBatch (reused between frames). */
+        std::vector<glm::mat3> batchNormalMatrices; /** @brief Normal matrices computed by transformBatch (reused between frames). */
+
+        std::unique_ptr<LveGpuCulling> gpuCulling; /** @brief Compute culling of the GPU-driven path, created when it is first enabled. */
+        bool gpuDriven = false; /** @brief Cull and fill the draws on the GPU instead of the CPU. */
+        bool frustumCulling = true; /** @brief Skip the objects outside the camera frustum. */
+        bool clusterCulling = true; /** @brief Draw the models with meshlets meshlet by meshlet, skipping the hidden ones. */
+        bool lodSelection = true; /** @brief Draw each object with the level of detail matching its size on screen. */
+        RenderStats stats{}; /** @brief Counters of the last rendered frame. */
     };
 }
\ No newline at end of file
@@ -13,6 +13,8 @@
 namespace lve {
     /**
      * @brief Represents a Vulkan swap chain for handling image presentation.
+     * When the device is headless, the swap chain images are replaced by a ring of offscreen color images
+     * that are rendered into but never presented.
     */
     class LveSwapChain {
     public:
@@ -50,7 +52,7 @@ namespace lve {
         VkFramebuffer getFrameBuffer(int index) { return swapChainFramebuffers[index]; }
 
         /**
-         * @brief Gets the Vulkan render pass.
+         * @brief Gets the Vulkan render pass, the same one while the swap chain is recreated with the same formats.
          * @return The Vulkan render pass.
         */
         VkRenderPass getRenderPass() { return renderPass; }
@@ -138,6 +140,11 @@ namespace lve {
         */
         void createSwapChain();
 
+        /**
+         * @brief Creates the offscreen color images used instead of the swap chain images when headless.
+        */
+        void createOffscreenImages();
+
         /**
          * @brief Creates image views for each image in the swap chain.
         */
@@ -149,7 +156,7 @@ namespace lve {
         void createDepthResources();
 
         /**
-         * @brief Creates the Vulkan render pass.
+         * @brief Creates the Vulkan render pass, or takes the one of the previous swap chain if the formats did not change.
         */
         void createRenderPass();
 
@@ -192,18 +199,19 @@ namespace lve {
         VkExtent2D swapChainExtent; /** @brief The extent of the swap chain. */
 
         std::vector<VkFramebuffer> swapChainFramebuffers; /** @brief Frame buffers for the swap chain images. */
-        VkRenderPass renderPass; /** @brief Vulkan render pass. */
+        VkRenderPass renderPass = VK_NULL_HANDLE; /** @brief Vulkan render pass, handed over to the next swap chain. */
 
         std::vector<VkImage> depthImages; /** @brief Depth images for each swap chain image. */
-        std::vector<VkDeviceMemory> depthImageMemorys; /** @brief Memory for depth images. */
+        std::vector<LveAllocation> depthImageMemorys; /** @brief Memory for depth images. */
         std::vector<VkImageView> depthImageViews; /** @brief Image views for depth images. */
         std::vector<VkImage> swapChainImages; /** @brief Images in the swap chain. */
+        std::vector<LveAllocation> offscreenImageMemorys; /** @brief Memory for the offscreen color images (headless only). */
         std::vector<VkImageView> swapChainImageViews; /** @brief Image views for swap chain images. */
 
         LveDevice& device; /** @brief Reference to the LveDevice. */
         VkExtent2D windowExtent; /** @brief The extent of the window. */
 
-        VkSwapchainKHR swapChain; /** @brief Vulkan swap chain. */
+        VkSwapchainKHR swapChain = VK_NULL_HANDLE; /** @brief Vulkan swap chain (VK_NULL_HANDLE when headless). */
         std::shared_ptr<LveSwapChain>oldSwapChain; /** @brief The previous swap chain. */
 
         std::vector<VkSemaphore> imageAvailableSemaphores; /** @brief Semaphores for image availability. */
@@ -0,0 +1,79 @@
+#pragma once
+
+//libs
+#include <glm/glm.hpp>
+
+//std
+#include <cstddef>
+#include <vector>
+
+namespace lve {
+    /**
+     * @brief Computes the model and normal matrices of one transform (YXZ Tait-Bryan rotation).
+     * This is the scalar reference used by TransformComponent and by the tail of the batched kernel.
+     * @param translation : The translation vector.
+     * @param rotation : The rotation angles.
+     * @param scale : The scale vector.
+     * @param modelMatrix : Receives the transformation matrix.
+     * @param normalMatrix : Receives the normal matrix.
+    */
+    void computeTransformMatrices(const glm::vec3& translation, const glm::vec3& rotation, const glm::vec3& scale, glm::mat4& modelMatrix, glm::mat3& normalMatrix);
+
+    /**
+     * @brief Batch of transforms stored as structure of arrays, so that the matrices of 4 objects are built at once with SSE2.
+    */
+    class LveTransformBatch {
+    public:
+        /**
+         * @brief Removes all the transforms from the batch (keeps the allocated memory).
+        */
+        void clear();
+
+        /**
+         * @brief Reserves memory for a number of transforms.
+         * @param count : The number of transforms.
+        */
+        void reserve(size_t count);
+
+        /**
+         * @brief Adds a transform to the batch.
+         * @param translation : The translation vector.
+         * @param rotation : The rotation angles.
+         * @param scale : The scale vector.
+        */
+        void add(const glm::vec3& translation, const glm::vec3& rotation, const glm::vec3& scale);
+
+        /**
+         * @brief Gets the number of transforms in the batch.
+         * @return The number of transforms.
+        */
+        size_t size() const { return translationX.size(); }
+
+        /**
+         * @brief Computes the matrices of every transform with the SIMD kernel (falls back to the scalar path without SSE2).
+         * @param modelMatrices : Receives size() transformation matrices.
+         * @param normalMatrices : Receives size() normal matrices.
+        */
+        void computeMatrices(glm::mat4* modelMatrices, glm::mat3* normalMatrices) const;
+
+        /**
+         * @brief Computes the matrices of every transform one at a time, used as reference.
+         * @param modelMatrices : Receives size() transformation matrices.
+         * @param normalMatrices : Receives size() normal matrices.
+        */
+        void computeMatricesScalar(glm::mat4* modelMatrices, glm::mat3* normalMatrices) const;
+
+
+    private:
+        // ----------------- Variable -----------------
+        std::vector<float> translationX{}; /** @brief X components of the translations. */
+        std::vector<float> translationY{}; /** @brief Y components of the translations. */
+        std::vector<float> translationZ{}; /** @brief Z components of the translations. */
+        std::vector<float> rotationX{}; /** @brief X angles of the rotations. */
+        std::vector<float> rotationY{}; /** @brief Y angles of the rotations. */
+        std::vector<float> rotationZ{}; /** @brief Z angles of the rotations. */
+        std::vector<float> scaleX{}; /** @brief X components of the scales. */
+        std::vector<float> scaleY{}; /** @brief Y components of the scales. */
+        std::vector<float> scaleZ{}; /** @brief Z components of the scales. */
+    };
+}  // namespace lve
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_buffer.hpp"
+
+//std
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lve {
+    /**
+     * @brief Uploads data to device local buffers without waiting for the queue.
+     * The data is copied into a persistent staging ring, the copies are recorded in one command buffer per batch and a batch is submitted on the transfer queue with a fence.
+     * An upload returns the ticket of its batch : the destination buffer may be used once isComplete(ticket) returns true.
+     * Staging ranges are reused when the fence of their batch has signaled, an upload only waits when the ring is full.
+    */
+    class LveUploadQueue {
+    public:
+        static constexpr VkDeviceSize RING_SIZE = 32 * 1024 * 1024; /** @brief Size of the staging ring (larger uploads get their own staging buffer). */
+        static constexpr VkDeviceSize STAGING_ALIGNMENT = 16; /** @brief Alignment of the staging ranges in the ring. */
+
+        /**
+         * @brief Constructor.
+         * @param device : The LveDevice reference (its transfer queue receives the batches).
+        */
+        LveUploadQueue(LveDevice& device);
+
+        /**
+         * @brief Destructor, waits for every batch.
+        */
+        ~LveUploadQueue();
+
+        LveUploadQueue(const LveUploadQueue&) = delete;
+        LveUploadQueue& operator=(const LveUploadQueue&) = delete;
+
+        /**
+         * @brief Copies data into the staging ring and records its copy into a buffer (thread safe).
+         * @param data : The data to upload.
+         * @param size : The size of the data.
+         * @param dstBuffer : The destination buffer (created with VK_BUFFER_USAGE_TRANSFER_DST_BIT).
+         * @param dstOffset : The offset of the data in the destination buffer.
+         * @return The ticket of the upload, to give to isComplete or wait (0 if there is nothing to copy).
+        */
+        uint64_t upload(const void* data, VkDeviceSize size, VkBuffer dstBuffer, VkDeviceSize dstOffset = 0);
+
+        /**
+         * @brief Records a copy between two device buffers, after every copy recorded before it (thread safe).
+         * @param srcBuffer : The source buffer (created with VK_BUFFER_USAGE_TRANSFER_SRC_BIT).
+         * @param srcOffset : The offset of the data in the source buffer.
+         * @param dstBuffer : The destination buffer (created with VK_BUFFER_USAGE_TRANSFER_DST_BIT).
+         * @param dstOffset : The offset of the data in the destination buffer.
+         * @param size : The size of the data.
+         * @return The ticket of the copy, to give to isComplete or wait.
+        */
+        uint64_t copy(VkBuffer srcBuffer, VkDeviceSize srcOffset, VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize size);
+
+        /**
+         * @brief Submits the copies recorded since the last submission (thread safe).
+        */
+        void submit();
+
+        /**
+         * @brief Checks if an upload has reached its destination, without waiting (thread safe).
+         * The batch of the ticket is submitted if it is still being recorded.
+         * @param ticket : The ticket returned by upload.
+         * @return True if the destination buffer can be used.
+        */
+        bool isComplete(uint64_t ticket);
+
+        /**
+         * @brief Waits until an upload has reached its destination (thread safe).
+         * @param ticket : The ticket returned by upload.
+        */
+        void wait(uint64_t ticket);
+
+        /**
+         * @brief Submits the recorded copies and waits for every batch (thread safe).
+        */
+        void waitIdle();
+
+        /**
+         * @brief Gets the number of batches submitted since the creation of the queue.
+         * @return The number of submitted batches.
+        */
+        uint64_t getSubmittedBatchCount() const { return submittedBatchCount.load(); }
+
+
+    private:
+        /**
+         * @brief Copies recorded into one command buffer and submitted together.
+        */
+        struct Batch {
+            uint64_t id = 0; /** @brief Ticket of the uploads of the batch (0 when the batch is not recording). */
+            VkCommandBuffer commandBuffer = VK_NULL_HANDLE; /** @brief Command buffer holding the copies. */
+            VkFence fence = VK_NULL_HANDLE; /** @brief Fence signaled when the copies are done. */
+            VkDeviceSize ringEnd = 0; /** @brief Position of the ring after the last staging range of the batch. */
+            std::vector<std::unique_ptr<LveBuffer>> stagingBuffers; /** @brief Staging buffers of the uploads larger than the ring. */
+        };
+
+        /**
+         * @brief Starts recording a batch if none is recording (the mutex must be locked).
+        */
+        void beginBatch();
+
+        /**
+         * @brief Submits the recording batch, if any (the mutex must be locked).
+        */
+        void submitBatch();
+
+        /**
+         * @brief Releases the staging ranges of the finished batches (the mutex must be locked).
+         * @param waitId : The batches up to this ticket are waited on, the later ones are only polled.
+        */
+        void retireBatches(uint64_t waitId);
+
+        /**
+         * @brief Reserves a staging range in the ring (the mutex must be locked).
+         * @param size : The size of the range (at most RING_SIZE).
+         * @param offset : Receives the offset of the range in the ring buffer.
+         * @return False if the ring has no room left until a batch finishes.
+        */
+        bool allocateStaging(VkDeviceSize size, VkDeviceSize& offset);
+
+
+
+        // ----------------- Variable -----------------
+        LveDevice& lveDevice; /** @brief Reference to the LveDevice. */
+        VkCommandPool commandPool = VK_NULL_HANDLE; /** @brief Command pool of the transfer queue family. */
+        std::unique_ptr<LveBuffer> stagingRing; /** @brief Persistently mapped staging ring. */
+        VkDeviceSize ringHead = 0; /** @brief Position of the next staging range (grows forever, the offset in the ring is ringHead % RING_SIZE). */
+        VkDeviceSize ringTail = 0; /** @brief Position of the oldest staging range still read by a batch. */
+        Batch recordingBatch; /** @brief Batch receiving the copies. */
+        std::deque<Batch> inFlightBatches; /** @brief Submitted batches not known to be finished, oldest first. */
+        std::vector<Batch> freeBatches; /** @brief Finished batches whose command buffer and fence can be reused. */
+        uint64_t nextBatchId = 1; /** @brief Ticket of the next batch. */
+        std::atomic<uint64_t> completedBatchId{ 0 }; /** @brief Ticket of the last finished batch (batches finish in order). */
+        std::atomic<uint64_t> submittedBatchCount{ 0 }; /** @brief Number of submitted batches. */
+        std::mutex mutex; /** @brief Protects the ring and the batches, so that models can be loaded from several threads. */
+    };
+}  // namespace lve
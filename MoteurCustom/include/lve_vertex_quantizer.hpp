@@ -0,0 +1,57 @@
+#pragma once
+
+#include "lve_model.hpp"
+
+//std
+#include <cstdint>
+
+namespace lve {
+    /**
+     * @brief Encoding of LveModel::CompactVertex, 20 bytes instead of the 44 of LveModel::Vertex.
+     * - position : unorm 16 bits per axis relative to the mesh bounds, the shader rebuilds it from the VertexDecode push constants.
+     * - normal : octahedral projection stored in 2 snorm 16 bits (the lower hemisphere is folded over the diagonals).
+     * - color : 4 unorm 8 bits.
+     * - uv : 2 half floats.
+     * dequantize does on the CPU what simple_shader_compact.vert does on the GPU.
+    */
+    class LveVertexQuantizer {
+    public:
+        /**
+         * @brief Gets the decoding of the positions of a mesh.
+         * @param bounds : The box enclosing the vertices of the mesh.
+         * @return The offset and scale mapping [0, 1] onto the bounds (a flat axis gets a scale of 0).
+        */
+        static LveModel::VertexDecode getDecode(const AABB& bounds);
+
+        /**
+         * @brief Quantizes vertices.
+         * @param vertices : The float vertices.
+         * @param count : The number of vertices.
+         * @param decode : The decoding of the positions, from getDecode.
+         * @param compactVertices : Receives count quantized vertices.
+        */
+        static void quantize(const LveModel::Vertex* vertices, uint32_t count, const LveModel::VertexDecode& decode, LveModel::CompactVertex* compactVertices);
+
+        /**
+         * @brief Decodes a quantized vertex, as the compact vertex shader does.
+         * @param compactVertex : The quantized vertex.
+         * @param decode : The decoding of the positions.
+         * @return The float vertex (with a normalized normal).
+        */
+        static LveModel::Vertex dequantize(const LveModel::CompactVertex& compactVertex, const LveModel::VertexDecode& decode);
+
+        /**
+         * @brief Projects a direction on the octahedron and unfolds it on a square.
+         * @param normal : The direction (needs not be normalized, a null vector gives +Z).
+         * @return The coordinates on the square, in [-1, 1].
+        */
+        static glm::vec2 encodeOctahedral(const glm::vec3& normal);
+
+        /**
+         * @brief Rebuilds a direction from its octahedral coordinates.
+         * @param encoded : The coordinates on the square, in [-1, 1].
+         * @return The normalized direction.
+        */
+        static glm::vec3 decodeOctahedral(const glm::vec2& encoded);
+    };
+}  // namespace lve
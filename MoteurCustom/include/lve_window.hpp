@@ -16,8 +16,9 @@ namespace lve {
          * @param w : The width of the window.
          * @param h : The height of the window.
          * @param name : The name of the window.
+         * @param headless : If true, no GLFW window is created and rendering goes to offscreen images.
         */
-        LveWindow(int w, int h, std::string name);
+        LveWindow(int w, int h, std::string name, bool headless = false);
 
         /**
          * @brief Destructor for LveWindow.
@@ -31,7 +32,13 @@ namespace lve {
          * @brief Checks if the window should close.
          * @return True if the window should close, false otherwise.
         */
-        bool shouldClose() { return glfwWindowShouldClose(window); }
+        bool shouldClose() { return !headless && glfwWindowShouldClose(window); }
+
+        /**
+         * @brief Checks if the window runs without a display (no GLFW window nor surface).
+         * @return True if the window is headless, false otherwise.
+        */
+        bool isHeadless() const { return headless; }
 
         /**
          * @brief Gets the extent of the window.
@@ -84,8 +91,9 @@ namespace lve {
         int width;/** @brief Width of the window. */
         int height;/** @brief Height of the window. */
         bool frambufferResized = false;/** @brief Flag indicating whether the window was resized. */
+        bool headless = false;/** @brief Flag indicating whether the window runs without a display. */
 
         std::string windowName;/** @brief Name of the window. */
-        GLFWwindow* window;/** @brief Pointer to the GLFW window. */
+        GLFWwindow* window = nullptr;/** @brief Pointer to the GLFW window (nullptr when headless). */
     };
 } //name space lve
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "lve_buffer.hpp"
 #include "lve_camera.hpp"
 #include "lve_device.hpp"
 #include "lve_frame_info.hpp"
@@ -13,6 +14,26 @@
 
 
 namespace lve {
+    /**
+     * @brief Per-instance data of a light billboard, read by point_light.vert through a vertex buffer bound with an instance input rate.
+    */
+    struct PointLightInstanceData {
+        glm::vec4 position{}; /** @brief Position of the light (w component is the billboard radius). */
+        glm::vec4 color{}; /** @brief Color of the light (w component is intensity). */
+
+        /**
+         * @brief Gets the binding descriptions for the per-instance vertex input (binding 0).
+         * @return A vector of VkVertexInputBindingDescription.
+        */
+        static std::vector<VkVertexInputBindingDescription> getBindingDescriptions();
+
+        /**
+         * @brief Gets the attribute descriptions for the per-instance vertex input (locations 0 and 1).
+         * @return A vector of VkVertexInputAttributeDescription.
+        */
+        static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions();
+    };
+
     /**
      * @brief Class representing a Point Light System in a Vulkan application.
      * This class manages the rendering and updating of point lights in the application.
@@ -36,20 +57,35 @@ namespace lve {
         PointLightSystem& operator=(const PointLightSystem&) = delete;
 
         /**
-         * @brief Update function to be called per frame for updating point light information.
+         * @brief Turns the lights around the vertical axis, called at each simulation step.
+         * @param registry : The registry owning the lights.
+         * @param dt : The duration of the step, in seconds.
+        */
+        void rotateLights(LveRegistry& registry, float dt);
+
+        /**
+         * @brief Update function to be called per frame for updating point light information, at their interpolated positions.
          * @param frameInfo : Information about the current frame.
-         * @param ubo : The global uniform buffer object.
+         * @param lights : Receives the point lights of the scene, with their range (sent to LveLightClusters).
         */
-        void update(FrameInfo& frameInfo, GlobalUbo& ubo);
+        void update(FrameInfo& frameInfo, std::vector<PointLight>& lights);
 
         /**
-         * @brief Render function to render point lights.
+         * @brief Render function to render point lights, sorted back to front in a single instanced draw (nothing until the pipeline is compiled).
          * @param frameInfo : Information about the current frame.
         */
         void render(FrameInfo& frameInfo);
 
 
     private:
+        /**
+         * @brief Sort key of a light.
+        */
+        struct LightSortKey {
+            float distanceSquared; /** @brief Squared distance to the camera. */
+            uint32_t index; /** @brief Index of the light in lightInstances. */
+        };
+
         /**
          * @brief Get the current time.
          * @return The current time.
@@ -63,16 +99,27 @@ namespace lve {
         void createPipelineLayout(VkDescriptorSetLayout globalSetLayout);
 
         /**
-         * @brief Create the pipeline for rendering point lights.
+         * @brief Requests the pipeline for rendering point lights, compiled in the background by the registry.
          * @param renderPass : The Vulkan render pass.
         */
         void createPipeline(VkRenderPass renderPass);
 
+        /**
+         * @brief Gets the instance buffer of a frame, growing it if it is too small.
+         * @param frameIndex : The index of the frame in flight.
+         * @param instanceCount : The number of instances to write.
+         * @return The instance buffer (mapped).
+        */
+        LveBuffer& getInstanceBuffer(int frameIndex, uint32_t instanceCount);
+
 
 
         // ----------------- Variable -----------------
         LveDevice& lveDevice; /** @brief Reference to the logical device. */
-        std::unique_ptr<LvePipeline> lvePipeline; /** @brief Unique pointer to the pipeline. */
+        std::shared_ptr<LvePipeline> lvePipeline; /** @brief Pipeline from the registry of the device. */
         VkPipelineLayout pipelineLayout; /** @brief Vulkan pipeline layout. */
+        std::vector<std::unique_ptr<LveBuffer>> instanceBuffers; /** @brief Per-frame host visible instance buffers. */
+        std::vector<PointLightInstanceData> lightInstances; /** @brief Lights of the current frame, in iteration order (reused between frames). */
+        std::vector<LightSortKey> sortKeys; /** @brief Lights of the current frame sorted back to front (reused between frames). */
     };
 }
\ No newline at end of file
@@ -1,18 +1,70 @@
 #include "firstapp.hpp"
+#include "lve_benchmark.hpp"
 
 #include <cstdlib>
 #include <iostream>
 #include <stdexcept>
+#include <string>
 
 /**
  * @brief Main function to execute the application.
+ * Options :
+ * - --headless : render into offscreen images without opening a window (runs 1000 frames unless --frames is given).
+ * - --frames N : render N frames, print the frame time statistics and exit.
+ * - --no-culling : draw every object, even outside the camera frustum.
+ * - --gpu-culling : cull the objects in a compute shader and draw them with indirect draws (can be switched in the inspector).
+ * - --no-mesh-optimization : import the OBJ files without reordering them (see lve::LveMeshOptimizer).
+ * - --compact-vertices : store the vertices of the models quantized to 20 bytes instead of 44 (see lve::LveVertexQuantizer).
+ * - --bench NAME : run a CPU micro-benchmark (see lve::runBenchmark) instead of the application.
+ * - --count N : number of elements processed by the benchmark.
+ * @param argc : Number of command line arguments.
+ * @param argv : Command line arguments.
  * @return EXIT_SUCCESS if the application runs successfully, EXIT_FAILURE otherwise.
 */
-int main() {
+int main(int argc, char* argv[]) {
     // Changer "lve_swap_chain.cpp" --> "chooseSwapSurfaceFormat()" en "..._SRGB" ou "..._UNORM"
-    lve::FirstApp app{};
+    lve::AppConfig config{};
+    std::string benchmark{};
+    size_t benchmarkCount = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--headless") {
+            config.headless = true;
+        } else if (arg == "--frames" && i + 1 < argc) {
+            config.frameCount = std::atoi(argv[++i]);
+        } else if (arg == "--no-culling") {
+            config.frustumCulling = false;
+        } else if (arg == "--gpu-culling") {
+            config.gpuCulling = true;
+        } else if (arg == "--no-mesh-optimization") {
+            config.optimizeMeshes = false;
+        } else if (arg == "--no-cluster-culling") {
+            config.clusterCulling = false;
+        } else if (arg == "--no-lod") {
+            config.lodSelection = false;
+        } else if (arg == "--no-shader-reload") {
+            config.shaderHotReload = false;
+        } else if (arg == "--compact-vertices") {
+            config.vertexFormat = lve::LveModel::VertexFormat::Compact;
+        } else if (arg == "--bench" && i + 1 < argc) {
+            benchmark = argv[++i];
+        } else if (arg == "--count" && i + 1 < argc) {
+            benchmarkCount = static_cast<size_t>(std::atoll(argv[++i]));
+        } else {
+            std::cerr << "Unknown option: " << arg << '\n';
+            std::cerr << "Usage: " << argv[0] << " [--headless] [--frames N] [--no-culling] [--gpu-culling] [--no-mesh-optimization] [--no-cluster-culling] [--no-lod] [--no-shader-reload] [--compact-vertices] [--bench NAME [--count N]]\n";
+            return EXIT_FAILURE;
+        }
+    }
+    if (!benchmark.empty()) {
+        return lve::runBenchmark(benchmark, benchmarkCount);
+    }
+    if (config.headless && config.frameCount <= 0) {
+        config.frameCount = 1000;
+    }
 
     try {
+        lve::FirstApp app{ config };
         app.run();
     } catch (const std::exception& e) {
         std::cerr << e.what() << '\n';
@@ -1,6 +1,8 @@
 echo Compile Shader
 C:\VulkanSDK\1.3.268.0\Bin\glslc.exe .\shaders\simple_shader.vert -o .\shaders\SPIR-V\simple_shader.vert.spv
+C:\VulkanSDK\1.3.268.0\Bin\glslc.exe .\shaders\simple_shader_compact.vert -o .\shaders\SPIR-V\simple_shader_compact.vert.spv
 C:\VulkanSDK\1.3.268.0\Bin\glslc.exe .\shaders\simple_shader.frag -o .\shaders\SPIR-V\simple_shader.frag.spv
 C:\VulkanSDK\1.3.268.0\Bin\glslc.exe .\shaders\point_light.vert -o .\shaders\SPIR-V\point_light.vert.spv
 C:\VulkanSDK\1.3.268.0\Bin\glslc.exe .\shaders\point_light.frag -o .\shaders\SPIR-V\point_light.frag.spv
+C:\VulkanSDK\1.3.268.0\Bin\glslc.exe .\shaders\cull.comp -o .\shaders\SPIR-V\cull.comp.spv
 pause
\ No newline at end of file
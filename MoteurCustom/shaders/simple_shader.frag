@@ -7,7 +7,7 @@ layout (location = 2) in vec3 fragNormalWorld;
 layout (location = 0) out vec4 outColor;
 
 struct PointLight {
-  vec4 position; // ignore w
+  vec4 position; // w is range
   vec4 color; // w is intensity
 };
 
@@ -16,14 +16,23 @@ layout(set = 0, binding = 0) uniform GlobalUbo {
   mat4 view;
   mat4 invView;
   vec4 ambientLightColor; // w is intensity
-  PointLight pointLights[10];
+  vec4 clusterParams; // xy tile size in pixels, z and w depth slice scale and bias
+  uvec4 clusterGrid; // tiles on x and y, depth slices in z
   int numLights;
 } ubo;
 
-layout(push_constant) uniform Push {
-  mat4 modelMatrix;
-  mat4 normalMatrix;
-} push;
+// clustered forward lighting (see LveClusterGrid)
+layout(std430, set = 0, binding = 1) readonly buffer LightBuffer {
+  PointLight lights[];
+} lightBuffer;
+
+layout(std430, set = 0, binding = 2) readonly buffer ClusterBuffer {
+  uvec2 clusters[]; // x offset in the light index list, y light count
+} clusterBuffer;
+
+layout(std430, set = 0, binding = 3) readonly buffer LightIndexBuffer {
+  uint indices[];
+} lightIndexBuffer;
 
 void main() {
   vec3 diffuseLight = ubo.ambientLightColor.xyz * ubo.ambientLightColor.w;
@@ -32,10 +41,20 @@ void main() {
 
   vec3 cameraPosWorld = ubo.invView[3].xyz;
   vec3 viewDirection = normalize(cameraPosWorld - fragPosWorld);
-  for (int i = 0; i < ubo.numLights; i++) {
-    PointLight light = ubo.pointLights[i];
+
+  // cluster of the fragment : screen tile and exponential depth slice
+  float viewDepth = (ubo.view * vec4(fragPosWorld, 1.0)).z;
+  uvec2 tile = min(uvec2(gl_FragCoord.xy / ubo.clusterParams.xy), ubo.clusterGrid.xy - 1u);
+  uint slice = uint(clamp(log(viewDepth) * ubo.clusterParams.z + ubo.clusterParams.w, 0.0, float(ubo.clusterGrid.z - 1u)));
+  uvec2 cluster = clusterBuffer.clusters[(slice * ubo.clusterGrid.y + tile.y) * ubo.clusterGrid.x + tile.x];
+
+  for (uint i = 0; i < cluster.y; i++) {
+    PointLight light = lightBuffer.lights[lightIndexBuffer.indices[cluster.x + i]];
     vec3 directionToLight = light.position.xyz - fragPosWorld;
-    float attenuation = 1.0 / dot(directionToLight, directionToLight); // distance squared
+    float distanceSquared = dot(directionToLight, directionToLight);
+    // the light fades to zero at its range, outside of which it is not listed in the clusters
+    float window = clamp(1.0 - distanceSquared / (light.position.w * light.position.w), 0.0, 1.0);
+    float attenuation = window * window / distanceSquared;
     directionToLight = normalize(directionToLight);
 
     float cosAngIncidence = max(dot(surfaceNormal, directionToLight), 0);
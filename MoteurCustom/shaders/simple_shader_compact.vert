@@ -0,0 +1,48 @@
+#version 450
+
+// LveModel::CompactVertex, see LveVertexQuantizer
+layout(location = 0) in vec4 position; // unorm 16 bits, relative to the mesh bounds
+layout(location = 1) in vec4 color; // unorm 8 bits
+layout(location = 2) in vec2 normal; // octahedral, snorm 16 bits
+layout(location = 3) in vec2 uv; // half floats
+
+// per-instance data (binding 1, instance input rate)
+layout(location = 4) in mat4 modelMatrix;
+layout(location = 8) in mat4 normalMatrix;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec3 fragPosWorld;
+layout(location = 2) out vec3 fragNormalWorld;
+
+layout(set = 0, binding = 0) uniform GlobalUbo {
+  mat4 projection;
+  mat4 view;
+  mat4 invView;
+  vec4 ambientLightColor; // w is intensity
+  vec4 clusterParams; // xy tile size in pixels, z and w depth slice scale and bias
+  uvec4 clusterGrid; // tiles on x and y, depth slices in z
+  int numLights;
+} ubo;
+
+// LveModel::VertexDecode
+layout(push_constant) uniform Push {
+  vec4 positionOffset;
+  vec4 positionScale;
+} push;
+
+vec3 decodeOctahedral(vec2 encoded) {
+  vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+  float fold = max(-n.z, 0.0);
+  n.x += n.x >= 0.0 ? -fold : fold;
+  n.y += n.y >= 0.0 ? -fold : fold;
+  return normalize(n);
+}
+
+void main() {
+  vec3 positionModel = push.positionOffset.xyz + position.xyz * push.positionScale.xyz;
+  vec4 positionWorld = modelMatrix * vec4(positionModel, 1.0);
+  gl_Position = ubo.projection * ubo.view * positionWorld;
+  fragNormalWorld = normalize(mat3(normalMatrix) * decodeOctahedral(normal));
+  fragPosWorld = positionWorld.xyz;
+  fragColor = color.rgb;
+}
@@ -1,9 +1,13 @@
 #include "firstapp.hpp"
 #include "lve_simple_render_system.hpp"
 #include "point_light_system.hpp"
+#include "lve_light_clusters.hpp"
 #include "lve_camera.hpp"
 #include "Keyboard_movement_controller.hpp"
 #include "lve_buffer.hpp"
+#include "lve_upload_queue.hpp"
+#include "lve_geometry_pool.hpp"
+#include "lve_pipeline_registry.hpp"
 #include "Colision.hpp"
 
 //std
@@ -12,9 +16,11 @@
 #include <iostream>
 #include <ctime>
 #include <chrono>
+#include <cmath>
 #include <vector>
 #include <numeric>
 #include <iostream>
+#include <algorithm>
 
 #include "glm/glm.hpp"
 #include "glm/gtc/constants.hpp"
@@ -30,11 +36,14 @@
 #define SECOND 1.0
 
 namespace lve {
-    FirstApp::FirstApp() {
+    FirstApp::FirstApp(const AppConfig& config) : config{ config }, lveWindow{ WIDTH, HEIGHT, "GG ENGINE", config.headless } {
         globalPool = LveDescriptorPool::Builder(lveDevice).setMaxSets(LveSwapChain::MAX_FRAMES_IN_FLIGHT)
             .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, LveSwapChain::MAX_FRAMES_IN_FLIGHT)
+            .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3 * LveSwapChain::MAX_FRAMES_IN_FLIGHT)
             .build();
         loadGameObjects();
+        // the copies of every model leave in one batch, the render loop draws each model once its batch is done
+        lveDevice.getUploadQueue().submit();
     }
 
     FirstApp::~FirstApp() {}
@@ -46,6 +55,9 @@ namespace lve {
             uboBuffers[i]->map();
         }
         auto globalSetLayout = LveDescriptorSetLayout::Builder(lveDevice).addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_ALL_GRAPHICS)
+            .addBinding(LveLightClusters::LIGHT_BINDING, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT)
+            .addBinding(LveLightClusters::CLUSTER_BINDING, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT)
+            .addBinding(LveLightClusters::INDEX_BINDING, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT)
             .build();
 
         std::vector<VkDescriptorSet> globalDescriptorSets(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
@@ -58,55 +70,50 @@ namespace lve {
 
         //SimpleRenderSystem simpleRenderSystem{ lveDevice, lveRenderer.getSwapChainRenderPass(), globalSetLayout->getDescriptorSetLayout() };
 
-        SimpleRenderSystem simpleRenderSystem{ lveDevice, lveRenderer.getSwapChainRenderPass(),globalSetLayout->getDescriptorSetLayout() };
+        SimpleRenderSystem simpleRenderSystem{ lveDevice, lveRenderer.getSwapChainRenderPass(),globalSetLayout->getDescriptorSetLayout(), config.vertexFormat };
+        simpleRenderSystem.setFrustumCulling(config.frustumCulling);
+        simpleRenderSystem.setClusterCulling(config.clusterCulling);
+        simpleRenderSystem.setLodSelection(config.lodSelection);
+        lveImgui.setGpuCulling(config.gpuCulling);
         PointLightSystem pointLightSystem{ lveDevice, lveRenderer.getSwapChainRenderPass(),globalSetLayout->getDescriptorSetLayout() };
+        lveDevice.getPipelineRegistry().setHotReload(config.shaderHotReload);
+        if (lveWindow.isHeadless()) {
+            // the pipelines compile in the background, the measured frames must draw everything
+            lveDevice.getPipelineRegistry().waitForPipelines();
+        }
+        LveLightClusters lightClusters{ lveDevice, *globalSetLayout, *globalPool };
+        std::vector<PointLight> pointLights{};
         LveCamera camera{};
 
-        auto viewerObject = LveGameObject::createGameObject();
-        viewerObject.transform.translation.z = -5.5f;
-        viewerObject.transform.translation.y = -3.5f;
-        viewerObject.transform.rotation.x = -0.5f;
+        auto viewerObject = LveGameObject::createGameObject(registry);
+        viewerObject.transform().setTranslation({ 0.f, -3.5f, -5.5f });
+        viewerObject.transform().setRotation({ -0.5f, 0.f, 0.f });
         KeyboardMovementController cameraController{};
 
 
         double lag = 0.0, previous = getCurrentTime(), current = 0.0, secondeCount = 0.0f;
         float gameObjectsIncrement = 1.0f;
         int etatClavier = 0;
-        auto cubeMovement = gameObjects.find(0);
-        cubeMovement->second.transform.vitesse = { 0.016f, 0.016f, 0.f };
-        cubeMovement->second.transform.friction = 0.94f;
-        while (!lveWindow.shouldClose()) {
+        int etatSouris = GLFW_RELEASE;
+        LveGameObject cubeMovement{ registry, 0 };
+        LveGameObject inspectedObject{ registry, 5 };
+        cubeMovement.transform().vitesse = { 0.016f, 0.016f, 0.f };
+        cubeMovement.transform().friction = 0.94f;
+
+        std::vector<double> frameTimes{};
+        frameTimes.reserve(config.frameCount);
+        double lastFrameEnd = getCurrentTime();
+        bool frameLimitReached = false;
+        // the objects start at rest, the first frame draws them where they are
+        registry.each<TransformComponent>([](LveGameObject::id_t, TransformComponent& transform) { transform.storePreviousState(); });
+        while (!lveWindow.shouldClose() && !frameLimitReached) {
             current = getCurrentTime();
-            lag += current - previous;
+            // fixed simulated time so that headless runs are reproducible and not capped by the wall clock
+            double frameTime = lveWindow.isHeadless() ? MS_PER_UPDATE : current - previous;
             previous = current;
+            lag += frameTime;
 
-            while (lag >= MS_PER_UPDATE) {
-                cameraController.moveInPanelXZ(lveWindow.getGLFWwindow(), (float)lag, viewerObject);
-                camera.setViewYXZ(viewerObject.transform.translation, viewerObject.transform.rotation);
-
-
-                gameObjects.find(5)->second.transform.translation = {lveImgui.getPositionSliderValue(0), lveImgui.getPositionSliderValue(1), lveImgui.getPositionSliderValue(2)};
-                gameObjects.find(5)->second.transform.rotation = {lveImgui.getRotationSliderValue(0), lveImgui.getRotationSliderValue(1), lveImgui.getRotationSliderValue(2)};
-                gameObjects.find(5)->second.transform.scale = {lveImgui.getScaleSliderValue(0), lveImgui.getScaleSliderValue(1), lveImgui.getScaleSliderValue(2)};
-               
-
-                //petit test des colisions sur des cubes
-                for (auto items = gameObjects.find(1); items != gameObjects.cend(); items++) {
-                    if (cubeMovement->second.transform.colisionBox.isIntersectAABB(items->second.transform.colisionBox)) {
-                        cubeMovement->second.transform.bouncingAABB(items->second.transform.colisionBox);
-                        cubeMovement->second.transform.updateAcceleration();
-                    }
-                }
-
-                //Appelle de la fonction de dclaration sur le cube en mouvement toute les secondes
-                if (secondeCount >= 1) {
-                    cubeMovement->second.transform.updateAcceleration();
-                    secondeCount = 0.0f;
-                }
-
-                //Fonction qui update les dplacement du cube
-                cubeMovement->second.transform.update();
-                
+            if (!lveWindow.isHeadless()) {
                 glfwPollEvents();
 
                 //Relance du cube lorsque l'on apuis sur la touche espace
@@ -117,43 +124,154 @@ namespace lve {
                 }
 
                 if ((etatClavier = glfwGetKey(lveWindow.getGLFWwindow(), GLFW_KEY_SPACE)) == GLFW_PRESS) {
-                    cubeMovement->second.transform.setTranslation({ 0.01f * gameObjectsIncrement,  0.499f * gameObjectsIncrement, 2.5f });
-                    cubeMovement->second.transform.vitesse = { 0.016f,  0.016f , 0.0f };
+                    cubeMovement.transform().setTranslation({ 0.01f * gameObjectsIncrement,  0.499f * gameObjectsIncrement, 2.5f });
+                    cubeMovement.transform().vitesse = { 0.016f,  0.016f , 0.0f };
+                    // teleport: no interpolation from the previous position
+                    cubeMovement.transform().storePreviousState();
                 }
 
-                float aspect = lveRenderer.getAspectRatio();
-                //camera.setOrthographicProjection(-aspect, aspect, -1, 1, -1, 1);
-                camera.setPerspectiveProjection(glm::radians(50.f), aspect, 0.1f, 100.f);
-                if (auto commandBuffer = lveRenderer.beginFrame()) {
-                    int frameIndex = lveRenderer.getFrameIndex();
-                    FrameInfo frameInfo{ frameIndex, static_cast<float>(lag), commandBuffer, camera, globalDescriptorSets[frameIndex], gameObjects };
-
-                    //update
-                    GlobalUbo ubo{};
-                    ubo.projection = camera.getProjection();
-                    ubo.view = camera.getView();
-                    ubo.inverseView = camera.getInverseView();
-                    pointLightSystem.update(frameInfo, ubo);
-                    uboBuffers[frameIndex]->writeToBuffer(&ubo);
-                    uboBuffers[frameIndex]->flush();
-
-                    //render
-                    lveRenderer.beginSwapChainRenderPass(commandBuffer);
-
-                    // order matters
-                    simpleRenderSystem.renderGameObjects(frameInfo);
-                    pointLightSystem.render(frameInfo);
-                    lveImgui.renderImGui(commandBuffer);
-
-                    lveRenderer.endSwapChainRenderPass(commandBuffer);
-                    lveRenderer.endFrame();
+                //Slection de l'objet inspect au clic gauche (hors fentres ImGui)
+                int clicSouris = glfwGetMouseButton(lveWindow.getGLFWwindow(), GLFW_MOUSE_BUTTON_LEFT);
+                if (clicSouris == GLFW_PRESS && etatSouris == GLFW_RELEASE && !lveImgui.wantsMouse()) {
+                    LveGameObject::id_t picked;
+                    if (pickObject(camera, picked)) {
+                        inspectedObject = LveGameObject{ registry, picked };
+                        auto& transform = inspectedObject.transform();
+                        lveImgui.setInspectedObject(picked, transform.getTranslation(), transform.getRotation(), transform.getScale());
+                    }
+                }
+                etatSouris = clicSouris;
+            }
+
+            // simulation at a fixed step, a frame too long to catch up with slows the simulation down instead of piling up steps
+            int stepCount = 0;
+            while (lag >= MS_PER_UPDATE && stepCount < MAX_STEPS_PER_FRAME) {
+                registry.each<TransformComponent>([](LveGameObject::id_t, TransformComponent& transform) { transform.storePreviousState(); });
+                if (!lveWindow.isHeadless()) {
+                    cameraController.moveInPanelXZ(lveWindow.getGLFWwindow(), static_cast<float>(MS_PER_UPDATE), viewerObject);
                 }
-               /* secondeCount += lag;*/
+
+                inspectedObject.transform().setTranslation({lveImgui.getPositionSliderValue(0), lveImgui.getPositionSliderValue(1), lveImgui.getPositionSliderValue(2)});
+                inspectedObject.transform().setRotation({lveImgui.getRotationSliderValue(0), lveImgui.getRotationSliderValue(1), lveImgui.getRotationSliderValue(2)});
+                inspectedObject.transform().setScale({lveImgui.getScaleSliderValue(0), lveImgui.getScaleSliderValue(1), lveImgui.getScaleSliderValue(2)});
+
+                //colisions entre tous les objets (broad phase puis rebond)
+                updateCollisions();
+
+                //Appelle de la fonction de dclaration sur le cube en mouvement toute les secondes
+                if (secondeCount >= 1) {
+                    cubeMovement.transform().updateAcceleration();
+                    secondeCount = 0.0f;
+                }
+
+                //Fonction qui update les dplacement du cube
+                cubeMovement.transform().update();
+                pointLightSystem.rotateLights(registry, static_cast<float>(MS_PER_UPDATE));
+
+               /* secondeCount += MS_PER_UPDATE;*/
                 lag -= MS_PER_UPDATE;
+                stepCount++;
+            }
+            if (stepCount == MAX_STEPS_PER_FRAME) {
+                lag = std::fmod(lag, MS_PER_UPDATE);
             }
 
+            // one render per frame, the objects are drawn between the last two steps
+            float alpha = static_cast<float>(lag / MS_PER_UPDATE);
+            registry.each<TransformComponent>([alpha](LveGameObject::id_t, TransformComponent& transform) { transform.setInterpolation(alpha); });
+            camera.setViewYXZ(viewerObject.transform().getInterpolatedTranslation(), viewerObject.transform().getInterpolatedRotation());
+
+            float aspect = lveRenderer.getAspectRatio();
+            //camera.setOrthographicProjection(-aspect, aspect, -1, 1, -1, 1);
+            camera.setPerspectiveProjection(glm::radians(50.f), aspect, 0.1f, 100.f);
+            if (auto commandBuffer = lveRenderer.beginFrame()) {
+                // the fence of the frame has been waited on, the geometry it read can be reused
+                lveDevice.getGeometryPool().beginFrame();
+                lveDevice.getPipelineRegistry().beginFrame();
+                int frameIndex = lveRenderer.getFrameIndex();
+                FrameInfo frameInfo{ frameIndex, static_cast<float>(frameTime), commandBuffer, camera, globalDescriptorSets[frameIndex], registry };
+
+                //update
+                GlobalUbo ubo{};
+                ubo.projection = camera.getProjection();
+                ubo.view = camera.getView();
+                ubo.inverseView = camera.getInverseView();
+                pointLightSystem.update(frameInfo, pointLights);
+                lightClusters.update(frameInfo, ubo, pointLights, lveRenderer.getSwapChainExtent());
+                uboBuffers[frameIndex]->writeToBuffer(&ubo);
+                uboBuffers[frameIndex]->flush();
+
+                //culling (compute, outside of the render pass)
+                simpleRenderSystem.setGpuDriven(lveImgui.isGpuCullingEnabled());
+                simpleRenderSystem.cullGameObjects(frameInfo);
+
+                //render
+                lveRenderer.beginSwapChainRenderPass(commandBuffer);
+
+                // order matters
+                simpleRenderSystem.renderGameObjects(frameInfo);
+                pointLightSystem.render(frameInfo);
+                const RenderStats& renderStats = simpleRenderSystem.getStats();
+                lveImgui.setRenderStats(renderStats.visibleCount, renderStats.objectCount, renderStats.drawCount);
+                lveImgui.renderImGui(commandBuffer);
+
+                lveRenderer.endSwapChainRenderPass(commandBuffer);
+                lveRenderer.endFrame();
+
+                double frameEnd = getCurrentTime();
+                frameTimes.push_back(frameEnd - lastFrameEnd);
+                lastFrameEnd = frameEnd;
+                frameLimitReached = config.frameCount > 0 && frameTimes.size() >= static_cast<size_t>(config.frameCount);
+            }
+        }
+        lveDevice.waitIdle();
+        printFrameStats(frameTimes, simpleRenderSystem.getStats(), simpleRenderSystem.isGpuDriven());
+        printMemoryStats();
+    }
+
+    void FirstApp::printFrameStats(std::vector<double>& frameTimes, const RenderStats& renderStats, bool gpuDriven) {
+        if (frameTimes.empty()) {
+            return;
+        }
+        double total = std::accumulate(frameTimes.begin(), frameTimes.end(), 0.0);
+        std::sort(frameTimes.begin(), frameTimes.end());
+        size_t p99 = std::min(frameTimes.size() - 1, frameTimes.size() * 99 / 100);
+
+        std::cout << "Frames rendered: " << frameTimes.size() << "\n";
+        std::cout << "Frame time (ms): avg " << 1000.0 * total / frameTimes.size()
+            << " | min " << 1000.0 * frameTimes.front()
+            << " | p99 " << 1000.0 * frameTimes[p99]
+            << " | max " << 1000.0 * frameTimes.back() << "\n";
+        std::cout << "Objects drawn (last frame): " << renderStats.visibleCount << " / " << renderStats.objectCount
+            << " in " << renderStats.drawCount << " draw calls" << (config.frustumCulling ? "" : " (culling disabled)") << (gpuDriven ? " (GPU culling)" : "") << "\n";
+        if (renderStats.meshletCount > 0) {
+            std::cout << "Meshlets drawn (last frame): " << renderStats.visibleMeshletCount << " / " << renderStats.meshletCount << "\n";
         }
-        vkDeviceWaitIdle(lveDevice.getDevice());
+        if (renderStats.simplifiedCount > 0) {
+            std::cout << "Objects at a reduced level of detail (last frame): " << renderStats.simplifiedCount << "\n";
+        }
+    }
+
+    void FirstApp::printMemoryStats() {
+        std::vector<LveMemoryHeapStats> heapStats = lveDevice.getAllocator().getHeapStats();
+        for (size_t heap = 0; heap < heapStats.size(); heap++) {
+            const LveMemoryHeapStats& stats = heapStats[heap];
+            if (stats.blockCount == 0) {
+                continue;
+            }
+            std::cout << "Device memory heap " << heap << ": " << stats.allocationCount << " allocations in " << stats.blockCount << " blocks"
+                << " | used " << stats.usedBytes / (1024.0 * 1024.0) << " / " << stats.blockBytes / (1024.0 * 1024.0) << " MiB"
+                << " | fragmentation " << 100.f * stats.fragmentation << " %\n";
+        }
+
+        LveGeometryPoolStats geometryStats = lveDevice.getGeometryPool().getStats();
+        std::cout << "Geometry pool: " << geometryStats.meshCount << " meshes in " << geometryStats.blockCount << " blocks"
+            << " | used " << geometryStats.usedBytes / (1024.0 * 1024.0) << " / " << geometryStats.blockBytes / (1024.0 * 1024.0) << " MiB"
+            << " | largest free range " << geometryStats.largestFreeRange / (1024.0 * 1024.0) << " MiB\n";
+
+        LvePipelineRegistryStats pipelineStats = lveDevice.getPipelineRegistry().getStats();
+        std::cout << "Pipeline registry: " << pipelineStats.pipelineCount << " pipelines, " << pipelineStats.shaderModuleCount << " shader modules"
+            << " | " << pipelineStats.sharedRequestCount << " shared requests | " << pipelineStats.reloadCount << " reloads\n";
     }
 
     double FirstApp::getCurrentTime() {
@@ -162,7 +280,7 @@ namespace lve {
         return duration_in_seconds.count();
     }
 
-    std::unique_ptr<LveModel> createCubeModel(LveDevice& device, glm::vec3 offset) {
+    std::unique_ptr<LveModel> createCubeModel(LveDevice& device, glm::vec3 offset, LveModel::VertexFormat vertexFormat) {
         LveModel::Builder modelBuilder{};
         modelBuilder.vertices = {
             // left face (white)
@@ -204,26 +322,22 @@ namespace lve {
         modelBuilder.indices = { 0,  1,  2,  0,  3,  1,  4,  5,  6,  4,  7,  5,  8,  9,  10, 8,  11, 9,
                                 12, 13, 14, 12, 15, 13, 16, 17, 18, 16, 19, 17, 20, 21, 22, 20, 23, 21 };
 
-        return std::make_unique<LveModel>(device, modelBuilder);
+        return std::make_unique<LveModel>(device, modelBuilder, vertexFormat);
     }
 
     void FirstApp::loadGameObjects() {
         loadCubesCollision();
 
-        std::shared_ptr<LveModel> lveModel = LveModel::createModelFromFile(lveDevice, "models/NOEL1.obj");
-        auto gameObject = LveGameObject::createGameObject();
-        gameObject.model = lveModel;
-        gameObject.transform.translation = { .0f,1.5f,.0f };
-        gameObject.transform.scale = { 0.5f,.5f,0.5f };
-
-        gameObjects.emplace(gameObject.getId(), std::move(gameObject));
+        std::shared_ptr<LveModel> lveModel = LveModel::createModelFromFile(lveDevice, "models/NOEL1.obj", config.optimizeMeshes, config.vertexFormat);
+        auto gameObject = LveGameObject::createGameObject(registry);
+        gameObject.setModel(lveModel);
+        gameObject.transform().setTransform({ .0f,1.5f,.0f }, { 0.5f,.5f,0.5f });
+        addCollider(gameObject);
 
-        lveModel = LveModel::createModelFromFile(lveDevice, "models/quad_model.obj");
-        auto floor = LveGameObject::createGameObject();
-        floor.model = lveModel;
-        floor.transform.translation = { 0.f, .5f, 0.f };
-        floor.transform.scale = { 3.f, 3.f, 3.f };
-        gameObjects.emplace(floor.getId(), std::move(floor));
+        lveModel = LveModel::createModelFromFile(lveDevice, "models/quad_model.obj", config.optimizeMeshes, config.vertexFormat);
+        auto floor = LveGameObject::createGameObject(registry);
+        floor.setModel(lveModel);
+        floor.transform().setTransform({ 0.f, .5f, 0.f }, { 3.f, 3.f, 3.f });
 
         // cercle de lumire
         std::vector<glm::vec3> lightColors{
@@ -236,45 +350,106 @@ namespace lve {
         };
 
        for (int i = 0; i < lightColors.size(); i++) {
-            auto pointLight = LveGameObject::makePointLight(0.2f);
-            pointLight.color = lightColors[i];
+            auto pointLight = LveGameObject::makePointLight(registry, 0.2f, 0.1f, lightColors[i]);
             auto rotateLight = glm::rotate(glm::mat4(1.f), (i * glm::two_pi<float>()) / lightColors.size(), { 0.f, -1.f, 0.f });
-            pointLight.transform.translation = glm::vec3(rotateLight * glm::vec4(-1.f, -.5f, -1.f, 1.f));
-            gameObjects.emplace(pointLight.getId(), std::move(pointLight));
+            pointLight.transform().setTranslation(glm::vec3(rotateLight * glm::vec4(-1.f, -.5f, -1.f, 1.f)));
         }
     }
 
     void FirstApp::loadCubesCollision() {
-        std::shared_ptr<LveModel> lveModel = createCubeModel(lveDevice, { .0f, -4.f, -5.f });
+        std::shared_ptr<LveModel> lveModel = createCubeModel(lveDevice, { .0f, -4.f, -5.f }, config.vertexFormat);
 
         //cube au centre de l'crant
-        auto cube = LveGameObject::createGameObject();
-        cube.model = lveModel;
-        cube.transform.setTransform({ 0.0f,0.5f,2.5f }, { .5f,.5f,.5f });
-        gameObjects.emplace(cube.getId(), std::move(cube));
+        auto cube = LveGameObject::createGameObject(registry);
+        cube.setModel(lveModel);
+        cube.transform().setTransform({ 0.0f,0.5f,2.5f }, { .5f,.5f,.5f });
+        addCollider(cube);
 
         //cube de gauche
-        auto cube2 = LveGameObject::createGameObject();
-        cube2.model = lveModel;
-        cube2.transform.setTransform({ -1.0f,.0f,2.5f }, { .5f,.5f,.5f });
-        gameObjects.emplace(cube2.getId(), std::move(cube2));
+        auto cube2 = LveGameObject::createGameObject(registry);
+        cube2.setModel(lveModel);
+        cube2.transform().setTransform({ -1.0f,.0f,2.5f }, { .5f,.5f,.5f });
+        addCollider(cube2);
 
         //cube du haut
-        auto cube3 = LveGameObject::createGameObject();
-        cube3.model = lveModel;
-        cube3.transform.setTransform({ 0.0f,-1.0f,2.5f }, { .5f,.5f,.5f });
-        gameObjects.emplace(cube3.getId(), std::move(cube3));
+        auto cube3 = LveGameObject::createGameObject(registry);
+        cube3.setModel(lveModel);
+        cube3.transform().setTransform({ 0.0f,-1.0f,2.5f }, { .5f,.5f,.5f });
+        addCollider(cube3);
 
         //cube de droite
-        auto cube4 = LveGameObject::createGameObject();
-        cube4.model = lveModel;
-        cube4.transform.setTransform({ 1.0f,.0f,2.5f }, { .5f,.5f,.5f });
-        gameObjects.emplace(cube4.getId(), std::move(cube4));
+        auto cube4 = LveGameObject::createGameObject(registry);
+        cube4.setModel(lveModel);
+        cube4.transform().setTransform({ 1.0f,.0f,2.5f }, { .5f,.5f,.5f });
+        addCollider(cube4);
 
         //Cube du bas
-        auto cube5 = LveGameObject::createGameObject();
-        cube5.model = lveModel;
-        cube5.transform.setTransform({ 0.0f,1.0f,2.5f }, { .5f,.5f,.5f });
-        gameObjects.emplace(cube5.getId(), std::move(cube5));
+        auto cube5 = LveGameObject::createGameObject(registry);
+        cube5.setModel(lveModel);
+        cube5.transform().setTransform({ 0.0f,1.0f,2.5f }, { .5f,.5f,.5f });
+        addCollider(cube5);
+    }
+
+    void FirstApp::addCollider(LveGameObject& gameObject) {
+        uint32_t proxy = broadPhase.insert(gameObject.transform().colisionBox, gameObject.getId());
+        int32_t treeProxy = aabbTree.createProxy(gameObject.transform().colisionBox, gameObject.getId());
+        gameObject.addComponent<ColliderComponent>(proxy, treeProxy);
+    }
+
+    void FirstApp::updateCollisions() {
+        registry.each<ColliderComponent, TransformComponent>([&](LveGameObject::id_t, ColliderComponent& collider, TransformComponent& transform) {
+            broadPhase.update(collider.proxy, transform.colisionBox);
+            aabbTree.moveProxy(collider.treeProxy, transform.colisionBox);
+        });
+
+        // narrow phase : each moving object of the pair bounces off the box of the other one
+        broadPhase.findPairs([&](uint32_t idA, uint32_t idB) {
+            auto& transformA = registry.get<TransformComponent>(idA);
+            auto& transformB = registry.get<TransformComponent>(idB);
+
+            AABB boxA = transformA.colisionBox;
+            AABB boxB = transformB.colisionBox;
+            if (transformA.vitesse != glm::vec3(0.0f)) {
+                transformA.bouncingAABB(boxB);
+                transformA.updateAcceleration();
+            }
+            if (transformB.vitesse != glm::vec3(0.0f)) {
+                transformB.bouncingAABB(boxA);
+                transformB.updateAcceleration();
+            }
+        });
+    }
+
+    bool FirstApp::pickObject(const LveCamera& camera, LveGameObject::id_t& picked) {
+        double mouseX, mouseY;
+        int width, height;
+        glfwGetCursorPos(lveWindow.getGLFWwindow(), &mouseX, &mouseY);
+        glfwGetWindowSize(lveWindow.getGLFWwindow(), &width, &height);
+        if (width == 0 || height == 0) {
+            return false;
+        }
+
+        // cursor to normalized device coordinates (y points down in Vulkan), then back to world space on the near and far planes
+        glm::vec2 ndc{ 2.f * static_cast<float>(mouseX) / width - 1.f, 2.f * static_cast<float>(mouseY) / height - 1.f };
+        glm::mat4 inverseViewProjection = camera.getInverseView() * glm::inverse(camera.getProjection());
+        glm::vec4 nearPoint = inverseViewProjection * glm::vec4(ndc, 0.f, 1.f);
+        glm::vec4 farPoint = inverseViewProjection * glm::vec4(ndc, 1.f, 1.f);
+        glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+        glm::vec3 direction = glm::vec3(farPoint) / farPoint.w - origin;
+        float length = glm::length(direction);
+        direction /= length;
+
+        bool hit = false;
+        aabbTree.raycast(origin, direction, length, [&](int32_t proxy, float maxDistance) {
+            LveGameObject::id_t id = aabbTree.getUserData(proxy);
+            float distance;
+            if (!LveAabbTree::intersectRay(registry.get<TransformComponent>(id).colisionBox, origin, direction, maxDistance, distance)) {
+                return maxDistance;
+            }
+            picked = id;
+            hit = true;
+            return distance;
+        });
+        return hit;
     }
 }
\ No newline at end of file
@@ -0,0 +1,426 @@
+#include "lve_aabb_tree.hpp"
+#include "Colision.hpp"
+
+//std
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace lve {
+    namespace {
+        /**
+         * @brief Computes the smallest box enclosing two boxes.
+         * @param a : The first box.
+         * @param b : The second box.
+         * @return The union of the boxes.
+        */
+        AABB combine(const AABB& a, const AABB& b) {
+            return AABB(std::min(a.minX, b.minX), std::max(a.maxX, b.maxX),
+                        std::min(a.minY, b.minY), std::max(a.maxY, b.maxY),
+                        std::min(a.minZ, b.minZ), std::max(a.maxZ, b.maxZ));
+        }
+
+        /**
+         * @brief Computes the surface area of a box, the cost used by the insertion heuristic.
+         * @param box : The box.
+         * @return The surface area.
+        */
+        float surfaceArea(const AABB& box) {
+            float dx = box.maxX - box.minX;
+            float dy = box.maxY - box.minY;
+            float dz = box.maxZ - box.minZ;
+            return 2.f * (dx * dy + dy * dz + dz * dx);
+        }
+
+        /**
+         * @brief Checks if a box contains another one.
+         * @param outer : The enclosing box.
+         * @param inner : The enclosed box.
+         * @return True if inner is inside outer, false otherwise.
+        */
+        bool contains(const AABB& outer, const AABB& inner) {
+            return outer.minX <= inner.minX && outer.minY <= inner.minY && outer.minZ <= inner.minZ &&
+                   outer.maxX >= inner.maxX && outer.maxY >= inner.maxY && outer.maxZ >= inner.maxZ;
+        }
+
+        /**
+         * @brief Checks if two boxes overlap.
+         * @param a : The first box.
+         * @param b : The second box.
+         * @return True if the boxes overlap, false otherwise.
+        */
+        bool overlaps(const AABB& a, const AABB& b) {
+            return a.minX <= b.maxX && a.maxX >= b.minX &&
+                   a.minY <= b.maxY && a.maxY >= b.minY &&
+                   a.minZ <= b.maxZ && a.maxZ >= b.minZ;
+        }
+    }
+
+    int32_t LveAabbTree::allocateNode() {
+        if (freeList == NULL_NODE) {
+            nodes.push_back(Node{});
+            return static_cast<int32_t>(nodes.size() - 1);
+        }
+        int32_t node = freeList;
+        freeList = nodes[node].parent;
+        nodes[node] = Node{};
+        return node;
+    }
+
+    void LveAabbTree::freeNode(int32_t node) {
+        nodes[node].parent = freeList;
+        nodes[node].height = -1;
+        freeList = node;
+    }
+
+    int32_t LveAabbTree::createProxy(const AABB& box, uint32_t userData) {
+        int32_t proxy = allocateNode();
+        nodes[proxy].box = AABB(box.minX - margin, box.maxX + margin, box.minY - margin, box.maxY + margin, box.minZ - margin, box.maxZ + margin);
+        nodes[proxy].userData = userData;
+        nodes[proxy].height = 0;
+        insertLeaf(proxy);
+        proxyCount++;
+        return proxy;
+    }
+
+    void LveAabbTree::destroyProxy(int32_t proxy) {
+        assert(proxy >= 0 && proxy < static_cast<int32_t>(nodes.size()) && nodes[proxy].isLeaf() && "Invalid proxy");
+        removeLeaf(proxy);
+        freeNode(proxy);
+        proxyCount--;
+    }
+
+    bool LveAabbTree::moveProxy(int32_t proxy, const AABB& box) {
+        assert(proxy >= 0 && proxy < static_cast<int32_t>(nodes.size()) && nodes[proxy].isLeaf() && "Invalid proxy");
+        if (contains(nodes[proxy].box, box)) {
+            return false;
+        }
+        removeLeaf(proxy);
+        nodes[proxy].box = AABB(box.minX - margin, box.maxX + margin, box.minY - margin, box.maxY + margin, box.minZ - margin, box.maxZ + margin);
+        insertLeaf(proxy);
+        return true;
+    }
+
+    void LveAabbTree::insertLeaf(int32_t leaf) {
+        if (root == NULL_NODE) {
+            root = leaf;
+            nodes[root].parent = NULL_NODE;
+            return;
+        }
+
+        // descend towards the sibling with the lowest cost (surface area added to the tree)
+        AABB leafBox = nodes[leaf].box;
+        int32_t index = root;
+        while (!nodes[index].isLeaf()) {
+            int32_t child1 = nodes[index].child1;
+            int32_t child2 = nodes[index].child2;
+
+            float area = surfaceArea(nodes[index].box);
+            float combinedArea = surfaceArea(combine(nodes[index].box, leafBox));
+            // cost of a new parent for this node and the leaf
+            float cost = 2.f * combinedArea;
+            // minimum cost of pushing the leaf further down
+            float inheritanceCost = 2.f * (combinedArea - area);
+
+            auto descendCost = [&](int32_t child) {
+                float childArea = surfaceArea(combine(leafBox, nodes[child].box));
+                if (nodes[child].isLeaf()) {
+                    return childArea + inheritanceCost;
+                }
+                return childArea - surfaceArea(nodes[child].box) + inheritanceCost;
+            };
+            float cost1 = descendCost(child1);
+            float cost2 = descendCost(child2);
+
+            if (cost < cost1 && cost < cost2) {
+                break;
+            }
+            index = cost1 < cost2 ? child1 : child2;
+        }
+        int32_t sibling = index;
+
+        // new parent for the sibling and the leaf
+        int32_t oldParent = nodes[sibling].parent;
+        int32_t newParent = allocateNode();
+        nodes[newParent].parent = oldParent;
+        nodes[newParent].box = combine(leafBox, nodes[sibling].box);
+        nodes[newParent].height = nodes[sibling].height + 1;
+        nodes[newParent].child1 = sibling;
+        nodes[newParent].child2 = leaf;
+        nodes[sibling].parent = newParent;
+        nodes[leaf].parent = newParent;
+
+        if (oldParent != NULL_NODE) {
+            if (nodes[oldParent].child1 == sibling) {
+                nodes[oldParent].child1 = newParent;
+            }
+            else {
+                nodes[oldParent].child2 = newParent;
+            }
+        }
+        else {
+            root = newParent;
+        }
+
+        refitAncestors(nodes[leaf].parent);
+    }
+
+    void LveAabbTree::removeLeaf(int32_t leaf) {
+        if (leaf == root) {
+            root = NULL_NODE;
+            return;
+        }
+
+        int32_t parent = nodes[leaf].parent;
+        int32_t grandParent = nodes[parent].parent;
+        int32_t sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+        // the sibling takes the place of the parent
+        if (grandParent != NULL_NODE) {
+            if (nodes[grandParent].child1 == parent) {
+                nodes[grandParent].child1 = sibling;
+            }
+            else {
+                nodes[grandParent].child2 = sibling;
+            }
+            nodes[sibling].parent = grandParent;
+            freeNode(parent);
+            refitAncestors(grandParent);
+        }
+        else {
+            root = sibling;
+            nodes[sibling].parent = NULL_NODE;
+            freeNode(parent);
+        }
+    }
+
+    void LveAabbTree::refitAncestors(int32_t index) {
+        while (index != NULL_NODE) {
+            index = balance(index);
+
+            int32_t child1 = nodes[index].child1;
+            int32_t child2 = nodes[index].child2;
+            nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+            nodes[index].box = combine(nodes[child1].box, nodes[child2].box);
+
+            index = nodes[index].parent;
+        }
+    }
+
+    int32_t LveAabbTree::balance(int32_t iA) {
+        Node& a = nodes[iA];
+        if (a.isLeaf() || a.height < 2) {
+            return iA;
+        }
+
+        int32_t iB = a.child1;
+        int32_t iC = a.child2;
+        Node& b = nodes[iB];
+        Node& c = nodes[iC];
+        int32_t heightDifference = c.height - b.height;
+
+        // C is too high : rotate C up
+        if (heightDifference > 1) {
+            int32_t iF = c.child1;
+            int32_t iG = c.child2;
+            Node& f = nodes[iF];
+            Node& g = nodes[iG];
+
+            c.child1 = iA;
+            c.parent = a.parent;
+            a.parent = iC;
+            if (c.parent != NULL_NODE) {
+                if (nodes[c.parent].child1 == iA) {
+                    nodes[c.parent].child1 = iC;
+                }
+                else {
+                    nodes[c.parent].child2 = iC;
+                }
+            }
+            else {
+                root = iC;
+            }
+
+            // the higher child of C stays under C, the other one replaces C under A
+            if (f.height > g.height) {
+                c.child2 = iF;
+                a.child2 = iG;
+                g.parent = iA;
+                a.box = combine(b.box, g.box);
+                c.box = combine(a.box, f.box);
+                a.height = 1 + std::max(b.height, g.height);
+                c.height = 1 + std::max(a.height, f.height);
+            }
+            else {
+                c.child2 = iG;
+                a.child2 = iF;
+                f.parent = iA;
+                a.box = combine(b.box, f.box);
+                c.box = combine(a.box, g.box);
+                a.height = 1 + std::max(b.height, f.height);
+                c.height = 1 + std::max(a.height, g.height);
+            }
+            return iC;
+        }
+
+        // B is too high : rotate B up
+        if (heightDifference < -1) {
+            int32_t iD = b.child1;
+            int32_t iE = b.child2;
+            Node& d = nodes[iD];
+            Node& e = nodes[iE];
+
+            b.child1 = iA;
+            b.parent = a.parent;
+            a.parent = iB;
+            if (b.parent != NULL_NODE) {
+                if (nodes[b.parent].child1 == iA) {
+                    nodes[b.parent].child1 = iB;
+                }
+                else {
+                    nodes[b.parent].child2 = iB;
+                }
+            }
+            else {
+                root = iB;
+            }
+
+            if (d.height > e.height) {
+                b.child2 = iD;
+                a.child1 = iE;
+                e.parent = iA;
+                a.box = combine(c.box, e.box);
+                b.box = combine(a.box, d.box);
+                a.height = 1 + std::max(c.height, e.height);
+                b.height = 1 + std::max(a.height, d.height);
+            }
+            else {
+                b.child2 = iE;
+                a.child1 = iD;
+                d.parent = iA;
+                a.box = combine(c.box, d.box);
+                b.box = combine(a.box, e.box);
+                a.height = 1 + std::max(c.height, d.height);
+                b.height = 1 + std::max(a.height, e.height);
+            }
+            return iB;
+        }
+
+        return iA;
+    }
+
+    void LveAabbTree::query(const AABB& box, const QueryCallback& callback) const {
+        stack.clear();
+        stack.push_back(root);
+        while (!stack.empty()) {
+            int32_t index = stack.back();
+            stack.pop_back();
+            if (index == NULL_NODE || !overlaps(nodes[index].box, box)) {
+                continue;
+            }
+            if (nodes[index].isLeaf()) {
+                if (!callback(index)) {
+                    return;
+                }
+            }
+            else {
+                stack.push_back(nodes[index].child1);
+                stack.push_back(nodes[index].child2);
+            }
+        }
+    }
+
+    void LveAabbTree::querySphere(const Sphere& sphere, const QueryCallback& callback) const {
+        Colision colision{};
+        stack.clear();
+        stack.push_back(root);
+        while (!stack.empty()) {
+            int32_t index = stack.back();
+            stack.pop_back();
+            if (index == NULL_NODE || !colision.isIntersectSphereAABB(sphere, nodes[index].box)) {
+                continue;
+            }
+            if (nodes[index].isLeaf()) {
+                if (!callback(index)) {
+                    return;
+                }
+            }
+            else {
+                stack.push_back(nodes[index].child1);
+                stack.push_back(nodes[index].child2);
+            }
+        }
+    }
+
+    void LveAabbTree::queryFrustum(const LveFrustum& frustum, const QueryCallback& callback) const {
+        stack.clear();
+        stack.push_back(root);
+        while (!stack.empty()) {
+            int32_t index = stack.back();
+            stack.pop_back();
+            if (index == NULL_NODE || !frustum.intersectsAABB(nodes[index].box)) {
+                continue;
+            }
+            if (nodes[index].isLeaf()) {
+                if (!callback(index)) {
+                    return;
+                }
+            }
+            else {
+                stack.push_back(nodes[index].child1);
+                stack.push_back(nodes[index].child2);
+            }
+        }
+    }
+
+    bool LveAabbTree::intersectRay(const AABB& box, const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float& distance) {
+        float tMin = 0.f;
+        float tMax = maxDistance;
+        const float boxMin[3] = { box.minX, box.minY, box.minZ };
+        const float boxMax[3] = { box.maxX, box.maxY, box.maxZ };
+        for (int axis = 0; axis < 3; axis++) {
+            if (std::abs(direction[axis]) < std::numeric_limits<float>::epsilon()) {
+                // parallel to the slab : the origin must be between the planes
+                if (origin[axis] < boxMin[axis] || origin[axis] > boxMax[axis]) {
+                    return false;
+                }
+                continue;
+            }
+            float invDirection = 1.f / direction[axis];
+            float t1 = (boxMin[axis] - origin[axis]) * invDirection;
+            float t2 = (boxMax[axis] - origin[axis]) * invDirection;
+            if (t1 > t2) std::swap(t1, t2);
+            tMin = std::max(tMin, t1);
+            tMax = std::min(tMax, t2);
+            if (tMin > tMax) {
+                return false;
+            }
+        }
+        distance = tMin;
+        return true;
+    }
+
+    void LveAabbTree::raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, const RayCallback& callback) const {
+        stack.clear();
+        stack.push_back(root);
+        while (!stack.empty()) {
+            int32_t index = stack.back();
+            stack.pop_back();
+            float distance;
+            if (index == NULL_NODE || !intersectRay(nodes[index].box, origin, direction, maxDistance, distance)) {
+                continue;
+            }
+            if (nodes[index].isLeaf()) {
+                float hitDistance = callback(index, maxDistance);
+                if (hitDistance < 0.f) {
+                    return;
+                }
+                maxDistance = std::min(maxDistance, hitDistance);
+            }
+            else {
+                stack.push_back(nodes[index].child1);
+                stack.push_back(nodes[index].child2);
+            }
+        }
+    }
+}  // namespace lve
@@ -0,0 +1,910 @@
+#include "lve_benchmark.hpp"
+#include "lve_aabb_tree.hpp"
+#include "lve_broad_phase.hpp"
+#include "lve_camera.hpp"
+#include "lve_cluster_grid.hpp"
+#include "lve_frustum.hpp"
+#include "lve_mesh_optimizer.hpp"
+#include "lve_mesh_simplifier.hpp"
+#include "lve_meshlet_builder.hpp"
+#include "lve_obj_loader.hpp"
+#include "lve_transform_batch.hpp"
+#include "lve_vertex_quantizer.hpp"
+#include "lve_utils.hpp"
+#include "Colision.hpp"
+
+//libs
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+//std
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace std {
+    template<>
+    struct hash<lve::LveModel::Vertex> {
+        size_t operator()(lve::LveModel::Vertex const& vertex) const {
+            size_t seed = 0;
+            lve::hashCombine(seed, vertex.position, vertex.color, vertex.normal, vertex.uv);
+            return seed;
+        }
+    };
+}
+
+namespace lve {
+    namespace {
+        /**
+         * @brief Runs a function several times and keeps the fastest run.
+         * @param iterations : The number of runs.
+         * @param fn : The function to measure.
+         * @return The duration of the fastest run in seconds.
+        */
+        double measureBest(int iterations, const std::function<void()>& fn) {
+            double best = 1e30;
+            for (int i = 0; i < iterations; i++) {
+                auto start = std::chrono::steady_clock::now();
+                fn();
+                auto end = std::chrono::steady_clock::now();
+                best = std::min(best, std::chrono::duration<double>(end - start).count());
+            }
+            return best;
+        }
+
+        /**
+         * @brief Compares the SIMD and scalar matrix kernels of LveTransformBatch.
+         * @param count : The number of transforms.
+         * @return EXIT_SUCCESS.
+        */
+        int benchmarkTransforms(size_t count) {
+            std::mt19937 rng{ 42 };
+            std::uniform_real_distribution<float> position{ -100.f, 100.f };
+            std::uniform_real_distribution<float> angle{ -glm::two_pi<float>(), glm::two_pi<float>() };
+            std::uniform_real_distribution<float> size{ 0.1f, 10.f };
+
+            LveTransformBatch batch{};
+            batch.reserve(count);
+            for (size_t i = 0; i < count; i++) {
+                batch.add({ position(rng), position(rng), position(rng) }, { angle(rng), angle(rng), angle(rng) }, { size(rng), size(rng), size(rng) });
+            }
+
+            std::vector<glm::mat4> scalarModels(count), simdModels(count);
+            std::vector<glm::mat3> scalarNormals(count), simdNormals(count);
+            const int iterations = 20;
+            double scalarTime = measureBest(iterations, [&]() { batch.computeMatricesScalar(scalarModels.data(), scalarNormals.data()); });
+            double simdTime = measureBest(iterations, [&]() { batch.computeMatrices(simdModels.data(), simdNormals.data()); });
+
+            float maxModelError = 0.f;
+            float maxNormalError = 0.f;
+            for (size_t i = 0; i < count; i++) {
+                for (int column = 0; column < 4; column++) {
+                    for (int row = 0; row < 4; row++) {
+                        maxModelError = std::max(maxModelError, std::abs(scalarModels[i][column][row] - simdModels[i][column][row]));
+                    }
+                }
+                for (int column = 0; column < 3; column++) {
+                    for (int row = 0; row < 3; row++) {
+                        maxNormalError = std::max(maxNormalError, std::abs(scalarNormals[i][column][row] - simdNormals[i][column][row]));
+                    }
+                }
+            }
+
+            std::cout << "transforms : " << count << " objects, best of " << iterations << " runs\n";
+            std::cout << "  scalar : " << scalarTime * 1e9 / count << " ns/object (" << scalarTime * 1000.0 << " ms)\n";
+            std::cout << "  simd   : " << simdTime * 1e9 / count << " ns/object (" << simdTime * 1000.0 << " ms)\n";
+            std::cout << "  speedup : x" << scalarTime / simdTime << '\n';
+            std::cout << "  max abs error : model " << maxModelError << ", normal " << maxNormalError << '\n';
+            return EXIT_SUCCESS;
+        }
+
+        /**
+         * @brief Compares the sweep and prune broad phase with the all-pairs test on moving boxes.
+         * @param count : The number of boxes.
+         * @return EXIT_SUCCESS if both methods find the same number of pairs, EXIT_FAILURE otherwise.
+        */
+        int benchmarkBroadPhase(size_t count) {
+            std::mt19937 rng{ 42 };
+            // keeps roughly the same density whatever the number of boxes
+            float worldSize = 2.f * std::cbrt(static_cast<float>(count));
+            std::uniform_real_distribution<float> position{ -worldSize, worldSize };
+            std::uniform_real_distribution<float> velocity{ -0.02f, 0.02f };
+            std::uniform_real_distribution<float> size{ 0.2f, 1.f };
+
+            std::vector<glm::vec3> centers(count), halfSizes(count), velocities(count);
+            for (size_t i = 0; i < count; i++) {
+                centers[i] = { position(rng), position(rng), position(rng) };
+                halfSizes[i] = glm::vec3{ size(rng), size(rng), size(rng) } * 0.5f;
+                velocities[i] = { velocity(rng), velocity(rng), velocity(rng) };
+            }
+            std::vector<AABB> boxes(count);
+            auto moveBoxes = [&]() {
+                for (size_t i = 0; i < count; i++) {
+                    centers[i] += velocities[i];
+                    boxes[i] = AABB(centers[i] - halfSizes[i], centers[i] + halfSizes[i]);
+                }
+            };
+            moveBoxes();
+
+            LveBroadPhase broadPhase{};
+            std::vector<uint32_t> proxies(count);
+            for (size_t i = 0; i < count; i++) {
+                proxies[i] = broadPhase.insert(boxes[i], static_cast<uint32_t>(i));
+            }
+
+            // a few coherent ticks, like the game loop
+            const int ticks = 20;
+            size_t sweepPairs = 0;
+            size_t brutePairs = 0;
+            double sweepTime = 0.0;
+            double bruteTime = 0.0;
+            for (int tick = 0; tick < ticks; tick++) {
+                moveBoxes();
+
+                auto start = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < count; i++) {
+                    broadPhase.update(proxies[i], boxes[i]);
+                }
+                size_t pairs = 0;
+                broadPhase.findPairs([&](uint32_t, uint32_t) { pairs++; });
+                auto end = std::chrono::steady_clock::now();
+                sweepTime += std::chrono::duration<double>(end - start).count();
+                sweepPairs += pairs;
+
+                start = std::chrono::steady_clock::now();
+                pairs = 0;
+                for (size_t i = 0; i < count; i++) {
+                    for (size_t j = i + 1; j < count; j++) {
+                        if (boxes[i].isIntersectAABB(boxes[j])) pairs++;
+                    }
+                }
+                end = std::chrono::steady_clock::now();
+                bruteTime += std::chrono::duration<double>(end - start).count();
+                brutePairs += pairs;
+            }
+
+            std::cout << "broadphase : " << count << " moving boxes, " << ticks << " ticks, " << sweepPairs / ticks << " pairs per tick\n";
+            std::cout << "  all pairs       : " << bruteTime * 1000.0 / ticks << " ms/tick\n";
+            std::cout << "  sweep and prune : " << sweepTime * 1000.0 / ticks << " ms/tick\n";
+            std::cout << "  speedup : x" << bruteTime / sweepTime << '\n';
+            if (sweepPairs != brutePairs) {
+                std::cerr << "  pair count mismatch : " << sweepPairs << " != " << brutePairs << '\n';
+                return EXIT_FAILURE;
+            }
+            return EXIT_SUCCESS;
+        }
+
+        /**
+         * @brief Compares the AABB tree with linear scans for box, sphere, ray and frustum queries.
+         * @param count : The number of boxes.
+         * @return EXIT_SUCCESS if both methods give the same results, EXIT_FAILURE otherwise.
+        */
+        int benchmarkAabbTree(size_t count) {
+            std::mt19937 rng{ 42 };
+            float worldSize = 2.f * std::cbrt(static_cast<float>(count));
+            std::uniform_real_distribution<float> position{ -worldSize, worldSize };
+            std::uniform_real_distribution<float> size{ 0.2f, 1.f };
+            std::uniform_real_distribution<float> offset{ -0.3f, 0.3f };
+            std::uniform_real_distribution<float> unit{ -1.f, 1.f };
+            auto randomBox = [&](glm::vec3 center) {
+                glm::vec3 halfSize = glm::vec3{ size(rng), size(rng), size(rng) } * 0.5f;
+                return AABB(center - halfSize, center + halfSize);
+            };
+
+            std::vector<AABB> boxes(count);
+            std::vector<int32_t> proxies(count);
+            LveAabbTree tree{};
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < count; i++) {
+                boxes[i] = randomBox({ position(rng), position(rng), position(rng) });
+                proxies[i] = tree.createProxy(boxes[i], static_cast<uint32_t>(i));
+            }
+            double buildTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            // move a tenth of the boxes a few times, like objects created and moved at runtime
+            size_t reinserted = 0;
+            start = std::chrono::steady_clock::now();
+            for (int tick = 0; tick < 10; tick++) {
+                for (size_t i = 0; i < count; i += 10) {
+                    glm::vec3 move{ offset(rng), offset(rng), offset(rng) };
+                    boxes[i] = AABB(boxes[i].minX + move.x, boxes[i].maxX + move.x, boxes[i].minY + move.y, boxes[i].maxY + move.y, boxes[i].minZ + move.z, boxes[i].maxZ + move.z);
+                    reinserted += tree.moveProxy(proxies[i], boxes[i]) ? 1 : 0;
+                }
+            }
+            double moveTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            const size_t queryCount = 1000;
+            std::vector<AABB> queryBoxes(queryCount);
+            std::vector<Sphere> querySpheres(queryCount);
+            std::vector<glm::vec3> rayOrigins(queryCount), rayDirections(queryCount);
+            std::vector<LveFrustum> queryFrustums(queryCount);
+            for (size_t q = 0; q < queryCount; q++) {
+                glm::vec3 center{ position(rng), position(rng), position(rng) };
+                queryBoxes[q] = AABB(center - glm::vec3(2.f), center + glm::vec3(2.f));
+                querySpheres[q] = Sphere(center, 2.f);
+                rayOrigins[q] = center;
+                rayDirections[q] = glm::normalize(glm::vec3{ unit(rng), unit(rng), unit(rng) } + glm::vec3(1e-3f));
+                glm::mat4 projection = glm::perspectiveRH_ZO(glm::radians(50.f), 16.f / 9.f, 0.1f, 8.f);
+                queryFrustums[q] = LveFrustum{ projection * glm::lookAtRH(center, center + rayDirections[q], glm::vec3{ 0.f, 1.f, 0.f }) };
+            }
+            const float rayLength = 4.f * worldSize;
+
+            Colision colision{};
+            size_t linearHits = 0, treeHits = 0;
+            double linearRayDistance = 0.0, treeRayDistance = 0.0;
+
+            start = std::chrono::steady_clock::now();
+            for (size_t q = 0; q < queryCount; q++) {
+                for (size_t i = 0; i < count; i++) {
+                    if (boxes[i].isIntersectAABB(queryBoxes[q])) linearHits++;
+                    if (colision.isIntersectSphereAABB(querySpheres[q], boxes[i])) linearHits++;
+                    if (queryFrustums[q].intersectsAABB(boxes[i])) linearHits++;
+                }
+                float closest = rayLength;
+                for (size_t i = 0; i < count; i++) {
+                    float distance;
+                    if (LveAabbTree::intersectRay(boxes[i], rayOrigins[q], rayDirections[q], closest, distance)) closest = distance;
+                }
+                linearRayDistance += closest;
+            }
+            double linearTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            start = std::chrono::steady_clock::now();
+            for (size_t q = 0; q < queryCount; q++) {
+                // the tree stores fat boxes, the exact box is tested in the callback (narrow phase)
+                tree.query(queryBoxes[q], [&](int32_t proxy) {
+                    if (boxes[tree.getUserData(proxy)].isIntersectAABB(queryBoxes[q])) treeHits++;
+                    return true;
+                });
+                tree.querySphere(querySpheres[q], [&](int32_t proxy) {
+                    if (colision.isIntersectSphereAABB(querySpheres[q], boxes[tree.getUserData(proxy)])) treeHits++;
+                    return true;
+                });
+                tree.queryFrustum(queryFrustums[q], [&](int32_t proxy) {
+                    if (queryFrustums[q].intersectsAABB(boxes[tree.getUserData(proxy)])) treeHits++;
+                    return true;
+                });
+                float closest = rayLength;
+                tree.raycast(rayOrigins[q], rayDirections[q], rayLength, [&](int32_t proxy, float maxDistance) {
+                    float distance;
+                    if (LveAabbTree::intersectRay(boxes[tree.getUserData(proxy)], rayOrigins[q], rayDirections[q], maxDistance, distance)) {
+                        closest = std::min(closest, distance);
+                        return distance;
+                    }
+                    return maxDistance;
+                });
+                treeRayDistance += closest;
+            }
+            double treeTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            std::cout << "aabbtree : " << count << " boxes, tree height " << tree.getHeight() << '\n';
+            std::cout << "  build : " << buildTime * 1000.0 << " ms, " << count << " moves : " << moveTime * 1000.0 << " ms (" << reinserted << " reinsertions)\n";
+            std::cout << "  " << queryCount << " box + sphere + ray + frustum queries\n";
+            std::cout << "  linear scan : " << linearTime * 1e6 / queryCount << " us/query set\n";
+            std::cout << "  tree        : " << treeTime * 1e6 / queryCount << " us/query set\n";
+            std::cout << "  speedup : x" << linearTime / treeTime << '\n';
+            if (linearHits != treeHits || std::abs(linearRayDistance - treeRayDistance) > 1e-3) {
+                std::cerr << "  result mismatch : " << linearHits << " != " << treeHits << " hits, ray distances " << linearRayDistance << " != " << treeRayDistance << '\n';
+                return EXIT_FAILURE;
+            }
+            return EXIT_SUCCESS;
+        }
+        /**
+         * @brief Measures the light assignment of LveClusterGrid for a growing number of lights and compares the lights shaded per fragment with the old loop over every light.
+         * @param maxCount : The largest number of lights.
+         * @return EXIT_SUCCESS if every light touching a sample point is listed in its cluster, EXIT_FAILURE otherwise.
+        */
+        int benchmarkLights(size_t maxCount) {
+            std::mt19937 rng{ 42 };
+            // same camera as the application
+            LveCamera camera{};
+            camera.setPerspectiveProjection(glm::radians(50.f), 16.f / 9.f, 0.1f, 100.f);
+            camera.setViewYXZ({ 0.f, -3.5f, -5.5f }, { -0.5f, 0.f, 0.f });
+            const glm::mat4& projection = camera.getProjection();
+
+            std::uniform_real_distribution<float> positionX{ -40.f, 40.f };
+            std::uniform_real_distribution<float> positionY{ -10.f, 2.f };
+            std::uniform_real_distribution<float> positionZ{ 0.f, 80.f };
+            std::uniform_real_distribution<float> unit{ 0.f, 1.f };
+            std::uniform_real_distribution<float> intensity{ 0.05f, 0.5f };
+
+            // sample fragments spread over the screen and the visible depth range
+            const size_t sampleCount = 2000;
+            std::vector<glm::uvec3> sampleClusters(sampleCount);
+            std::vector<glm::vec3> samplePositions(sampleCount);
+            LveClusterGrid grid{};
+            grid.build(camera.getView(), projection, {});
+            for (size_t i = 0; i < sampleCount; i++) {
+                glm::vec2 ndc{ unit(rng) * 2.f - 1.f, unit(rng) * 2.f - 1.f };
+                float depth = 0.1f * std::pow(400.f, unit(rng));
+                glm::vec3 viewPosition{ (ndc.x - projection[2][0]) * depth / projection[0][0], (ndc.y - projection[2][1]) * depth / projection[1][1], depth };
+                samplePositions[i] = glm::vec3(camera.getInverseView() * glm::vec4(viewPosition, 1.f));
+                sampleClusters[i] = {
+                    std::min(static_cast<uint32_t>((ndc.x + 1.f) * 0.5f * LveClusterGrid::TILES_X), LveClusterGrid::TILES_X - 1),
+                    std::min(static_cast<uint32_t>((ndc.y + 1.f) * 0.5f * LveClusterGrid::TILES_Y), LveClusterGrid::TILES_Y - 1),
+                    grid.getSlice(depth) };
+            }
+
+            std::cout << "lights : " << LveClusterGrid::TILES_X << "x" << LveClusterGrid::TILES_Y << "x" << LveClusterGrid::SLICES << " clusters, " << sampleCount << " sample fragments\n";
+            bool missing = false;
+            const int iterations = 10;
+            for (size_t count = 64; count <= maxCount; count *= 4) {
+                std::vector<PointLight> lights(count);
+                for (auto& light : lights) {
+                    light.color = { unit(rng), unit(rng), unit(rng), intensity(rng) };
+                    light.position = { positionX(rng), positionY(rng), positionZ(rng), LveClusterGrid::computeLightRange(light.color) };
+                }
+                double buildTime = measureBest(iterations, [&]() { grid.build(camera.getView(), projection, lights); });
+
+                const auto& clusters = grid.getClusters();
+                const auto& lightIndices = grid.getLightIndices();
+                uint32_t maxPerCluster = 0;
+                for (const auto& cluster : clusters) {
+                    maxPerCluster = std::max(maxPerCluster, cluster.y);
+                }
+
+                // every light reaching a sample must be in the cluster of the sample
+                size_t shadedLights = 0;
+                size_t touchingLights = 0;
+                for (size_t i = 0; i < sampleCount; i++) {
+                    const auto& cluster = clusters[LveClusterGrid::getClusterIndex(sampleClusters[i].x, sampleClusters[i].y, sampleClusters[i].z)];
+                    auto first = lightIndices.begin() + cluster.x;
+                    auto last = first + cluster.y;
+                    shadedLights += cluster.y;
+                    for (uint32_t l = 0; l < count; l++) {
+                        glm::vec3 offset = glm::vec3(lights[l].position) - samplePositions[i];
+                        if (glm::dot(offset, offset) >= lights[l].position.w * lights[l].position.w) continue;
+                        touchingLights++;
+                        if (std::find(first, last, l) == last) missing = true;
+                    }
+                }
+
+                std::cout << "  " << count << " lights : assign " << buildTime * 1000.0 << " ms, "
+                    << static_cast<double>(shadedLights) / sampleCount << " lights shaded per fragment instead of " << count
+                    << " (" << static_cast<double>(touchingLights) / sampleCount << " in range, max " << maxPerCluster << " per cluster)\n";
+            }
+            if (missing) {
+                std::cerr << "  a light in range of a sample is missing from its cluster\n";
+                return EXIT_FAILURE;
+            }
+            return EXIT_SUCCESS;
+        }
+
+        /**
+         * @brief Writes an OBJ file holding a wavy grid split in several groups, every inner vertex being shared by six triangles.
+         * @param path : The path of the file.
+         * @param triangleCount : The approximate number of triangles.
+        */
+        void writeGridObj(const std::string& path, size_t triangleCount) {
+            size_t cells = std::max<size_t>(static_cast<size_t>(std::sqrt(static_cast<double>(triangleCount) / 2.0)), 1);
+            size_t side = cells + 1;
+            std::ofstream file{ path };
+            char line[128];
+            for (size_t z = 0; z < side; z++) {
+                for (size_t x = 0; x < side; x++) {
+                    float height = 0.1f * std::sin(0.05f * x) * std::cos(0.05f * z);
+                    std::snprintf(line, sizeof(line), "v %g %g %g\nvt %g %g\n", static_cast<float>(x), height, static_cast<float>(z), static_cast<float>(x) / cells, static_cast<float>(z) / cells);
+                    file << line;
+                }
+            }
+            // one normal per row, so that the normal indices differ from the position indices
+            for (size_t z = 0; z < side; z++) {
+                glm::vec3 normal = glm::normalize(glm::vec3{ 0.f, 1.f, 0.05f * std::sin(0.05f * z) });
+                std::snprintf(line, sizeof(line), "vn %g %g %g\n", normal.x, normal.y, normal.z);
+                file << line;
+            }
+            const size_t groups = 8;
+            for (size_t z = 0; z < cells; z++) {
+                if (z % ((cells + groups - 1) / groups) == 0) {
+                    file << "g part" << z << '\n';
+                }
+                for (size_t x = 0; x < cells; x++) {
+                    size_t a = z * side + x + 1;
+                    size_t b = a + 1;
+                    size_t c = a + side;
+                    size_t d = c + 1;
+                    std::snprintf(line, sizeof(line), "f %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu\n", a, a, z + 1, c, c, z + 2, b, b, z + 1);
+                    file << line;
+                    std::snprintf(line, sizeof(line), "f %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu\n", b, b, z + 1, c, c, z + 2, d, d, z + 2);
+                    file << line;
+                }
+            }
+        }
+
+        /**
+         * @brief Compares the multithreaded OBJ import of LveObjLoader with the single threaded std::unordered_map deduplication it replaced.
+         * @param triangleCount : The approximate number of triangles of the generated OBJ.
+         * @return EXIT_SUCCESS if both imports give the same vertices and indices, EXIT_FAILURE otherwise.
+        */
+        int benchmarkObjImport(size_t triangleCount) {
+            std::string path = (std::filesystem::temp_directory_path() / "lve_benchmark_grid.obj").string();
+            writeGridObj(path, triangleCount);
+
+            // the text is parsed once, both paths start from the tinyobj attributes and shapes
+            tinyobj::attrib_t attrib;
+            std::vector<tinyobj::shape_t> shapes;
+            std::vector<tinyobj::material_t> materials;
+            std::string warn, err;
+            auto start = std::chrono::steady_clock::now();
+            bool parsed = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str());
+            double parseTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::filesystem::remove(path);
+            if (!parsed) {
+                std::cerr << "objimport : " << warn << err << '\n';
+                return EXIT_FAILURE;
+            }
+
+            std::vector<LveModel::Vertex> referenceVertices;
+            std::vector<uint32_t> referenceIndices;
+            const int iterations = 3;
+            double referenceTime = measureBest(iterations, [&]() {
+                referenceVertices.clear();
+                referenceIndices.clear();
+                std::unordered_map<LveModel::Vertex, uint32_t> uniqueVertices{};
+                for (const auto& shape : shapes) {
+                    for (const auto& index : shape.mesh.indices) {
+                        LveModel::Vertex vertex{};
+                        if (index.vertex_index >= 0) {
+                            vertex.position = { attrib.vertices[3 * index.vertex_index + 0], attrib.vertices[3 * index.vertex_index + 1], attrib.vertices[3 * index.vertex_index + 2] };
+                            vertex.color = { attrib.colors[3 * index.vertex_index + 0], attrib.colors[3 * index.vertex_index + 1], attrib.colors[3 * index.vertex_index + 2] };
+                        }
+                        if (index.normal_index >= 0) {
+                            vertex.normal = { attrib.normals[3 * index.normal_index + 0], attrib.normals[3 * index.normal_index + 1], attrib.normals[3 * index.normal_index + 2] };
+                        }
+                        if (index.texcoord_index >= 0) {
+                            vertex.uv = { attrib.texcoords[2 * index.texcoord_index + 0], attrib.texcoords[2 * index.texcoord_index + 1] };
+                        }
+                        if (uniqueVertices.count(vertex) == 0) {
+                            uniqueVertices[vertex] = static_cast<uint32_t>(referenceVertices.size());
+                            referenceVertices.push_back(vertex);
+                        }
+                        referenceIndices.push_back(uniqueVertices[vertex]);
+                    }
+                }
+            });
+
+            std::vector<LveModel::Vertex> corners;
+            std::vector<uint64_t> hashes;
+            std::vector<LveModel::Vertex> singleVertices, parallelVertices;
+            std::vector<uint32_t> singleIndices, parallelIndices;
+            double singleTime = measureBest(iterations, [&]() {
+                LveObjLoader::buildCorners(attrib, shapes, corners, hashes, 1);
+                LveObjLoader::deduplicate(corners, hashes, singleVertices, singleIndices, 1);
+            });
+            double parallelTime = measureBest(iterations, [&]() {
+                LveObjLoader::buildCorners(attrib, shapes, corners, hashes);
+                LveObjLoader::deduplicate(corners, hashes, parallelVertices, parallelIndices);
+            });
+
+            std::cout << "objimport : " << referenceIndices.size() / 3 << " triangles, " << shapes.size() << " shapes, " << referenceVertices.size() << " unique vertices, best of " << iterations << " runs\n";
+            std::cout << "  tinyobj parse (shared) : " << parseTime * 1000.0 << " ms\n";
+            std::cout << "  unordered_map dedup    : " << referenceTime * 1000.0 << " ms\n";
+            std::cout << "  open addressing, 1 thread : " << singleTime * 1000.0 << " ms (x" << referenceTime / singleTime << ")\n";
+            unsigned int threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+            std::cout << "  open addressing, " << threadCount << (threadCount == 1 ? " thread : " : " threads : ") << parallelTime * 1000.0 << " ms (x" << referenceTime / parallelTime << ")\n";
+            std::cout << "  whole import : " << (parseTime + referenceTime) * 1000.0 << " ms -> " << (parseTime + parallelTime) * 1000.0 << " ms\n";
+            if (referenceVertices != singleVertices || referenceVertices != parallelVertices || referenceIndices != singleIndices || referenceIndices != parallelIndices) {
+                std::cerr << "  result mismatch : " << referenceVertices.size() << " reference vertices, " << singleVertices.size() << " single thread, " << parallelVertices.size() << " parallel\n";
+                return EXIT_FAILURE;
+            }
+            return EXIT_SUCCESS;
+        }
+
+        /**
+         * @brief Lists the triangles of a mesh by the original index of their vertices (stored in color.x), rotated so that the smallest comes first and sorted.
+         * @param builder : The mesh.
+         * @return The canonical triangle list.
+        */
+        std::vector<glm::uvec3> getCanonicalTriangles(const LveModel::Builder& builder) {
+            std::vector<glm::uvec3> triangles(builder.indices.size() / 3);
+            for (size_t t = 0; t < triangles.size(); t++) {
+                glm::uvec3 triangle{
+                    static_cast<uint32_t>(builder.vertices[builder.indices[t * 3 + 0]].color.x),
+                    static_cast<uint32_t>(builder.vertices[builder.indices[t * 3 + 1]].color.x),
+                    static_cast<uint32_t>(builder.vertices[builder.indices[t * 3 + 2]].color.x) };
+                // the rotation keeps the winding
+                while (triangle.x > triangle.y || triangle.x > triangle.z) {
+                    triangle = { triangle.y, triangle.z, triangle.x };
+                }
+                triangles[t] = triangle;
+            }
+            std::sort(triangles.begin(), triangles.end(), [](const glm::uvec3& a, const glm::uvec3& b) {
+                return a.x != b.x ? a.x < b.x : a.y != b.y ? a.y < b.y : a.z < b.z;
+            });
+            return triangles;
+        }
+
+        /**
+         * @brief Measures the vertex cache efficiency of a grid mesh given in row order and in random order, before and after LveMeshOptimizer.
+         * @param triangleCount : The approximate number of triangles of the grid.
+         * @return EXIT_SUCCESS if the optimized meshes keep every triangle and its winding, EXIT_FAILURE otherwise.
+        */
+        int benchmarkMeshOptimizer(size_t triangleCount) {
+            size_t cells = std::max<size_t>(static_cast<size_t>(std::sqrt(static_cast<double>(triangleCount) / 2.0)), 1);
+            size_t side = cells + 1;
+            LveModel::Builder rowOrder{};
+            for (size_t z = 0; z < side; z++) {
+                for (size_t x = 0; x < side; x++) {
+                    LveModel::Vertex vertex{};
+                    vertex.position = { static_cast<float>(x), 0.1f * std::sin(0.3f * x) * std::cos(0.3f * z), static_cast<float>(z) };
+                    vertex.normal = { 0.f, 1.f, 0.f };
+                    // the original index identifies the vertex after the reordering
+                    vertex.color = { static_cast<float>(rowOrder.vertices.size()), 0.f, 0.f };
+                    rowOrder.vertices.push_back(vertex);
+                }
+            }
+            for (size_t z = 0; z < cells; z++) {
+                for (size_t x = 0; x < cells; x++) {
+                    uint32_t a = static_cast<uint32_t>(z * side + x);
+                    uint32_t b = a + 1;
+                    uint32_t c = a + static_cast<uint32_t>(side);
+                    uint32_t d = c + 1;
+                    rowOrder.indices.insert(rowOrder.indices.end(), { a, c, b, b, c, d });
+                }
+            }
+
+            // exported meshes often come out in an order unrelated to their topology
+            LveModel::Builder randomOrder = rowOrder;
+            std::vector<uint32_t> triangleOrder(randomOrder.indices.size() / 3);
+            for (uint32_t t = 0; t < triangleOrder.size(); t++) {
+                triangleOrder[t] = t;
+            }
+            std::shuffle(triangleOrder.begin(), triangleOrder.end(), std::mt19937{ 42 });
+            for (size_t t = 0; t < triangleOrder.size(); t++) {
+                std::copy_n(rowOrder.indices.begin() + triangleOrder[t] * 3, 3, randomOrder.indices.begin() + t * 3);
+            }
+            std::shuffle(randomOrder.vertices.begin(), randomOrder.vertices.end(), std::mt19937{ 7 });
+            std::vector<uint32_t> vertexRemap(randomOrder.vertices.size());
+            for (uint32_t v = 0; v < randomOrder.vertices.size(); v++) {
+                vertexRemap[static_cast<uint32_t>(randomOrder.vertices[v].color.x)] = v;
+            }
+            for (auto& index : randomOrder.indices) {
+                index = vertexRemap[index];
+            }
+
+            std::vector<glm::uvec3> referenceTriangles = getCanonicalTriangles(rowOrder);
+            uint32_t vertexCount = static_cast<uint32_t>(rowOrder.vertices.size());
+            std::cout << "meshopt : " << rowOrder.indices.size() / 3 << " triangles, " << vertexCount << " vertices, FIFO cache of " << LveMeshOptimizer::CACHE_SIZE << '\n';
+            bool mismatch = false;
+            for (auto [name, source] : { std::pair{ "row order   ", &rowOrder }, std::pair{ "random order", &randomOrder } }) {
+                LveModel::Builder optimized = *source;
+                LveVertexCacheStats before = LveMeshOptimizer::analyzeVertexCache(optimized.indices, vertexCount);
+                auto start = std::chrono::steady_clock::now();
+                LveMeshOptimizer::optimize(optimized);
+                double optimizeTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                LveVertexCacheStats after = LveMeshOptimizer::analyzeVertexCache(optimized.indices, static_cast<uint32_t>(optimized.vertices.size()));
+
+                std::cout << "  " << name << " : ACMR " << before.acmr << " -> " << after.acmr << ", ATVR " << before.atvr << " -> " << after.atvr
+                    << " (" << optimizeTime * 1000.0 << " ms)\n";
+                mismatch |= getCanonicalTriangles(optimized) != referenceTriangles;
+            }
+            if (mismatch) {
+                std::cerr << "  the optimized mesh lost or flipped triangles\n";
+                return EXIT_FAILURE;
+            }
+            return EXIT_SUCCESS;
+        }
+
+        /**
+         * @brief Builds a UV sphere of radius 1, its vertex normals point outward.
+         * @param triangleCount : The approximate number of triangles.
+         * @return The sphere, each vertex keeps its original index in color.x.
+        */
+        LveModel::Builder createSphere(size_t triangleCount) {
+            uint32_t rings = std::max<uint32_t>(static_cast<uint32_t>(std::sqrt(static_cast<double>(triangleCount) / 4.0)), 2);
+            uint32_t segments = rings * 2;
+            LveModel::Builder sphere{};
+            for (uint32_t ring = 0; ring <= rings; ring++) {
+                float theta = glm::pi<float>() * ring / rings;
+                // exact poles, so that their triangles have no area
+                float sinTheta = ring == rings ? 0.f : std::sin(theta);
+                for (uint32_t segment = 0; segment <= segments; segment++) {
+                    float phi = glm::two_pi<float>() * segment / segments;
+                    LveModel::Vertex vertex{};
+                    vertex.normal = { sinTheta * std::cos(phi), std::cos(theta), sinTheta * std::sin(phi) };
+                    vertex.position = vertex.normal;
+                    // the original index identifies the vertex after the reordering
+                    vertex.color = { static_cast<float>(sphere.vertices.size()), 0.f, 0.f };
+                    sphere.vertices.push_back(vertex);
+                }
+            }
+            for (uint32_t ring = 0; ring < rings; ring++) {
+                for (uint32_t segment = 0; segment < segments; segment++) {
+                    uint32_t a = ring * (segments + 1) + segment;
+                    uint32_t b = a + 1;
+                    uint32_t c = a + segments + 1;
+                    uint32_t d = c + 1;
+                    sphere.indices.insert(sphere.indices.end(), { a, c, b, b, c, d });
+                }
+            }
+            return sphere;
+        }
+
+        /**
+         * @brief Splits a sphere into meshlets and culls them for a camera seeing part of it.
+         * @param triangleCount : The approximate number of triangles of the sphere.
+         * @return EXIT_SUCCESS if the meshlets keep every triangle within their limits and no culled meshlet has a visible triangle, EXIT_FAILURE otherwise.
+        */
+        int benchmarkMeshlets(size_t triangleCount) {
+            LveModel::Builder sphere = createSphere(triangleCount);
+            std::vector<glm::uvec3> referenceTriangles = getCanonicalTriangles(sphere);
+
+            // as at import : the meshlets regroup the optimized triangles
+            LveMeshOptimizer::optimize(sphere);
+            auto start = std::chrono::steady_clock::now();
+            LveMeshletBuilder::build(sphere);
+            double buildTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            bool failed = getCanonicalTriangles(sphere) != referenceTriangles;
+            uint32_t expectedFirstIndex = 0;
+            size_t vertexTotal = 0;
+            std::vector<uint32_t> vertexMarks(sphere.vertices.size(), UINT32_MAX);
+            for (uint32_t m = 0; m < sphere.meshlets.size(); m++) {
+                const LveModel::Meshlet& meshlet = sphere.meshlets[m];
+                uint32_t vertexCount = 0;
+                for (uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.indexCount; i++) {
+                    if (vertexMarks[sphere.indices[i]] != m) {
+                        vertexMarks[sphere.indices[i]] = m;
+                        vertexCount++;
+                    }
+                }
+                vertexTotal += vertexCount;
+                failed |= meshlet.firstIndex != expectedFirstIndex || vertexCount > LveMeshletBuilder::MAX_VERTICES || meshlet.indexCount > LveMeshletBuilder::MAX_TRIANGLES * 3;
+                expectedFirstIndex += meshlet.indexCount;
+            }
+            failed |= expectedFirstIndex != sphere.indices.size();
+
+            // a narrow camera on the edge of the sphere : the frustum keeps a part of the front, the cones remove the back
+            LveCamera camera{};
+            camera.setPerspectiveProjection(glm::radians(30.f), 16.f / 9.f, 0.1f, 100.f);
+            camera.setViewTarget({ 0.f, 0.f, -3.f }, { 0.8f, 0.f, 0.f });
+            glm::mat4 viewProjection = camera.getProjection() * camera.getView();
+            LveFrustum frustum{ viewProjection };
+            glm::vec3 cameraPosition = camera.getPosition();
+
+            std::vector<uint8_t> visible(sphere.meshlets.size());
+            const int iterations = 20;
+            double cullTime = measureBest(iterations, [&]() {
+                for (size_t m = 0; m < sphere.meshlets.size(); m++) {
+                    const LveModel::Meshlet& meshlet = sphere.meshlets[m];
+                    visible[m] = frustum.intersectsSphere(meshlet.center, meshlet.radius) && !meshlet.isBackFacing(cameraPosition) ? 1 : 0;
+                }
+            });
+
+            // a culled meshlet must not have a triangle both facing the camera and inside the frustum
+            uint32_t frustumCount = 0;
+            uint32_t visibleCount = 0;
+            size_t visibleTriangles = 0;
+            for (size_t m = 0; m < sphere.meshlets.size(); m++) {
+                const LveModel::Meshlet& meshlet = sphere.meshlets[m];
+                bool insideFrustum = frustum.intersectsSphere(meshlet.center, meshlet.radius);
+                frustumCount += insideFrustum ? 1 : 0;
+                visibleCount += visible[m];
+                visibleTriangles += visible[m] ? meshlet.indexCount / 3 : 0;
+                for (uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.indexCount; i += 3) {
+                    const LveModel::Vertex& a = sphere.vertices[sphere.indices[i + 0]];
+                    const LveModel::Vertex& b = sphere.vertices[sphere.indices[i + 1]];
+                    const LveModel::Vertex& c = sphere.vertices[sphere.indices[i + 2]];
+                    glm::vec3 normal = glm::cross(b.position - a.position, c.position - a.position);
+                    if (glm::dot(normal, a.normal + b.normal + c.normal) < 0.f) {
+                        normal = -normal;
+                    }
+                    bool facing = glm::dot(cameraPosition - a.position, normal) > 1e-6f;
+                    bool inside = false;
+                    for (const LveModel::Vertex* vertex : { &a, &b, &c }) {
+                        glm::vec4 clip = viewProjection * glm::vec4(vertex->position, 1.f);
+                        inside |= std::abs(clip.x) <= clip.w && std::abs(clip.y) <= clip.w && clip.z >= 0.f && clip.z <= clip.w;
+                    }
+                    if (!insideFrustum && inside) {
+                        failed = true;
+                    }
+                    if (!visible[m] && facing && inside) {
+                        failed = true;
+                    }
+                }
+            }
+
+            size_t meshletCount = sphere.meshlets.size();
+            std::cout << "meshlets : sphere of " << sphere.indices.size() / 3 << " triangles, " << sphere.vertices.size() << " vertices, at most "
+                << LveMeshletBuilder::MAX_VERTICES << " vertices / " << LveMeshletBuilder::MAX_TRIANGLES << " triangles per meshlet\n";
+            std::cout << "  build         : " << buildTime * 1000.0 << " ms, " << meshletCount << " meshlets, "
+                << static_cast<double>(vertexTotal) / meshletCount << " vertices and " << sphere.indices.size() / 3.0 / meshletCount << " triangles on average\n";
+            std::cout << "  cull (best of " << iterations << ") : " << cullTime * 1000.0 << " ms\n";
+            std::cout << "  frustum       : " << frustumCount << " / " << meshletCount << " meshlets\n";
+            std::cout << "  + normal cone : " << visibleCount << " / " << meshletCount << " meshlets, "
+                << 100.0 * visibleTriangles / (sphere.indices.size() / 3) << " % of the triangles drawn\n";
+            if (failed) {
+                std::cerr << "  the meshlets lost triangles, exceed their limits or culled a visible triangle\n";
+                return EXIT_FAILURE;
+            }
+            return EXIT_SUCCESS;
+        }
+
+        /**
+         * @brief Builds the levels of detail of a sphere and picks one for a camera moving away from it.
+         * @param triangleCount : The approximate number of triangles of the sphere.
+         * @return EXIT_SUCCESS if every level keeps the full mesh first, halves its triangles without flipping one and has a growing error, EXIT_FAILURE otherwise.
+        */
+        int benchmarkLod(size_t triangleCount) {
+            LveModel::Builder sphere = createSphere(triangleCount);
+            // as at import : the levels are built from the optimized mesh
+            LveMeshOptimizer::optimize(sphere);
+            std::vector<uint32_t> fullIndices(sphere.indices);
+            auto start = std::chrono::steady_clock::now();
+            LveMeshSimplifier::buildLods(sphere);
+            double buildTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            bool failed = sphere.lods.size() < 2 || !std::equal(fullIndices.begin(), fullIndices.end(), sphere.indices.begin());
+            std::cout << "lod : sphere of " << fullIndices.size() / 3 << " triangles, " << sphere.vertices.size() << " vertices, "
+                << sphere.lods.size() << " levels built in " << buildTime * 1000.0 << " ms\n";
+
+            // the surface is the unit sphere : the centroid and the middle of the edges of a triangle are 1 - |p| away from it
+            float previousError = -1.f;
+            uint32_t previousIndexCount = 0;
+            for (size_t l = 0; l < sphere.lods.size(); l++) {
+                const LveModel::Lod& lod = sphere.lods[l];
+                if (lod.firstIndex + lod.indexCount > sphere.indices.size()) {
+                    failed = true;
+                    break;
+                }
+                float deviation = 0.f;
+                uint32_t flipped = 0;
+                for (uint32_t i = lod.firstIndex; i < lod.firstIndex + lod.indexCount; i += 3) {
+                    const glm::vec3& a = sphere.vertices[sphere.indices[i + 0]].position;
+                    const glm::vec3& b = sphere.vertices[sphere.indices[i + 1]].position;
+                    const glm::vec3& c = sphere.vertices[sphere.indices[i + 2]].position;
+                    glm::vec3 centroid = (a + b + c) / 3.f;
+                    for (const glm::vec3& point : { centroid, (a + b) * 0.5f, (b + c) * 0.5f, (c + a) * 0.5f }) {
+                        deviation = std::max(deviation, 1.f - glm::length(point));
+                    }
+                    glm::vec3 normal = glm::cross(b - a, c - a);
+                    float length = glm::length(normal);
+                    if (length == 0.f) continue;
+
+                    // createSphere winds its triangles inward, the normal of a sliver is left out as it points anywhere
+                    flipped += glm::dot(normal / length, centroid / glm::length(centroid)) > 0.5f ? 1 : 0;
+                }
+                failed |= flipped > 0 || lod.error < previousError || (l > 0 && lod.indexCount > previousIndexCount * 9 / 10);
+                previousError = lod.error;
+                previousIndexCount = lod.indexCount;
+                std::cout << "  level " << l << " : " << lod.indexCount / 3 << " triangles, estimated error " << lod.error
+                    << ", measured deviation " << deviation << (flipped > 0 ? ", flipped triangles: " + std::to_string(flipped) : std::string{}) << "\n";
+            }
+
+            // the same choice as SimpleRenderSystem : the error projected at the nearest point of the sphere must stay under a thousandth of the screen
+            const float maxScreenError = 0.001f;
+            LveCamera camera{};
+            camera.setPerspectiveProjection(glm::radians(50.f), 16.f / 9.f, 0.1f, 1000.f);
+            uint32_t previousLevel = 0;
+            for (float distance : { 2.f, 4.f, 8.f, 16.f, 32.f, 64.f, 128.f, 256.f }) {
+                camera.setViewTarget({ 0.f, 0.f, -distance }, { 0.f, 0.f, 0.f });
+                uint32_t level = LveMeshSimplifier::selectLod(sphere.lods, camera.getProjectedSize(1.f, { 0.f, 0.f, -1.f }), maxScreenError);
+                failed |= level < previousLevel;
+                previousLevel = level;
+                std::cout << "  camera at " << distance << " : level " << level << " (" << sphere.lods[level].indexCount / 3 << " triangles)\n";
+            }
+            if (failed) {
+                std::cerr << "  a level lost the full mesh, flipped a triangle, removed too few triangles or has a smaller error than the previous one\n";
+                return EXIT_FAILURE;
+            }
+            return EXIT_SUCCESS;
+        }
+
+        /**
+         * @brief Measures the quantization of LveVertexQuantizer and the error of the decoded attributes.
+         * @param vertexCount : The number of random vertices.
+         * @return EXIT_SUCCESS if every attribute decodes within the precision of its format, EXIT_FAILURE otherwise.
+        */
+        int benchmarkVertexFormat(size_t vertexCount) {
+            std::mt19937 rng{ 42 };
+            std::uniform_real_distribution<float> unit{ 0.f, 1.f };
+            std::uniform_real_distribution<float> signedUnit{ -1.f, 1.f };
+            std::vector<LveModel::Vertex> vertices(vertexCount);
+            glm::vec3 boundsMin{ -12.f, -0.5f, -3.f };
+            glm::vec3 boundsSize{ 40.f, 7.f, 0.25f };
+            for (auto& vertex : vertices) {
+                vertex.position = boundsMin + glm::vec3(unit(rng), unit(rng), unit(rng)) * boundsSize;
+                vertex.color = { unit(rng), unit(rng), unit(rng) };
+                do {
+                    vertex.normal = { signedUnit(rng), signedUnit(rng), signedUnit(rng) };
+                } while (glm::dot(vertex.normal, vertex.normal) < 1e-4f || glm::dot(vertex.normal, vertex.normal) > 1.f);
+                vertex.normal = glm::normalize(vertex.normal);
+                vertex.uv = { unit(rng) * 4.f, unit(rng) };
+            }
+
+            glm::vec3 minPosition = vertices[0].position;
+            glm::vec3 maxPosition = vertices[0].position;
+            for (auto& vertex : vertices) {
+                minPosition = glm::min(minPosition, vertex.position);
+                maxPosition = glm::max(maxPosition, vertex.position);
+            }
+            LveModel::VertexDecode decode = LveVertexQuantizer::getDecode(AABB(minPosition, maxPosition));
+            std::vector<LveModel::CompactVertex> compactVertices(vertexCount);
+            const int iterations = 10;
+            double quantizeTime = measureBest(iterations, [&]() {
+                LveVertexQuantizer::quantize(vertices.data(), static_cast<uint32_t>(vertexCount), decode, compactVertices.data());
+            });
+
+            glm::vec3 positionError{ 0.f };
+            float normalError = 0.f;
+            float colorError = 0.f;
+            float uvError = 0.f;
+            for (size_t i = 0; i < vertexCount; i++) {
+                LveModel::Vertex decoded = LveVertexQuantizer::dequantize(compactVertices[i], decode);
+                positionError = glm::max(positionError, glm::abs(decoded.position - vertices[i].position));
+                // acos loses too much precision near 1
+                normalError = std::max(normalError, std::atan2(glm::length(glm::cross(decoded.normal, vertices[i].normal)), glm::dot(decoded.normal, vertices[i].normal)));
+                glm::vec3 colorDifference = glm::abs(decoded.color - vertices[i].color);
+                colorError = std::max({ colorError, colorDifference.x, colorDifference.y, colorDifference.z });
+                glm::vec2 uvDifference = glm::abs(decoded.uv - vertices[i].uv);
+                uvError = std::max(uvError, std::max(uvDifference.x, uvDifference.y));
+            }
+            positionError /= glm::vec3(decode.positionScale);
+            normalError = glm::degrees(normalError);
+
+            std::cout << "vertexformat : " << vertexCount << " vertices, " << sizeof(LveModel::Vertex) << " -> " << sizeof(LveModel::CompactVertex) << " bytes per vertex, best of " << iterations << " runs\n";
+            std::cout << "  quantize        : " << quantizeTime * 1000.0 << " ms ("
+                << vertexCount * sizeof(LveModel::Vertex) / (1024.0 * 1024.0) << " MiB -> " << vertexCount * sizeof(LveModel::CompactVertex) / (1024.0 * 1024.0) << " MiB)\n";
+            std::cout << "  position error  : " << std::max({ positionError.x, positionError.y, positionError.z }) * 65535.f << " unorm16 steps of the bounds\n";
+            std::cout << "  normal error    : " << normalError << " degrees\n";
+            std::cout << "  color error     : " << colorError * 255.f << " unorm8 steps\n";
+            std::cout << "  uv error        : " << uvError << " (uv in [0, 4])\n";
+
+            // half a step of rounding for every format (plus the float rounding of the decoded positions), 2^-11 relative for the half floats below 4
+            bool failed = std::max({ positionError.x, positionError.y, positionError.z }) * 65535.f > 0.52f
+                || normalError > 0.01f
+                || colorError * 255.f > 0.501f
+                || uvError > 4.f / 2048.f;
+            if (failed) {
+                std::cerr << "  a decoded attribute is outside the precision of its format\n";
+                return EXIT_FAILURE;
+            }
+            return EXIT_SUCCESS;
+        }
+    }
+
+    int runBenchmark(const std::string& name, size_t count) {
+        if (name == "transforms") {
+            return benchmarkTransforms(count > 0 ? count : 100000);
+        }
+        if (name == "broadphase") {
+            return benchmarkBroadPhase(count > 0 ? count : 5000);
+        }
+        if (name == "aabbtree") {
+            return benchmarkAabbTree(count > 0 ? count : 10000);
+        }
+        if (name == "lights") {
+            return benchmarkLights(count > 0 ? count : 16384);
+        }
+        if (name == "objimport") {
+            return benchmarkObjImport(count > 0 ? count : 2000000);
+        }
+        if (name == "meshopt") {
+            return benchmarkMeshOptimizer(count > 0 ? count : 500000);
+        }
+        if (name == "vertexformat") {
+            return benchmarkVertexFormat(count > 0 ? count : 1000000);
+        }
+        if (name == "meshlets") {
+            return benchmarkMeshlets(count > 0 ? count : 1000000);
+        }
+        if (name == "lod") {
+            return benchmarkLod(count > 0 ? count : 200000);
+        }
+        std::cerr << "Unknown benchmark: " << name << '\n';
+        std::cerr << "Available benchmarks: transforms, broadphase, aabbtree, lights, objimport, meshopt, vertexformat, meshlets, lod\n";
+        return EXIT_FAILURE;
+    }
+}  // namespace lve
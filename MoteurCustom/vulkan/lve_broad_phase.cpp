@@ -0,0 +1,69 @@
+#include "lve_broad_phase.hpp"
+
+//std
+#include <algorithm>
+#include <cassert>
+
+namespace lve {
+    uint32_t LveBroadPhase::insert(const AABB& box, uint32_t userData) {
+        uint32_t proxy;
+        if (!freeProxies.empty()) {
+            proxy = freeProxies.back();
+            freeProxies.pop_back();
+            proxies[proxy] = { box, userData };
+        }
+        else {
+            proxy = static_cast<uint32_t>(proxies.size());
+            proxies.push_back({ box, userData });
+        }
+        // new boxes are appended, the next findPairs sorts them in place
+        sortedProxies.push_back(proxy);
+        return proxy;
+    }
+
+    void LveBroadPhase::remove(uint32_t proxy) {
+        auto it = std::find(sortedProxies.begin(), sortedProxies.end(), proxy);
+        assert(it != sortedProxies.end() && "Proxy is not in the broad phase");
+        sortedProxies.erase(it);
+        freeProxies.push_back(proxy);
+    }
+
+    void LveBroadPhase::update(uint32_t proxy, const AABB& box) {
+        assert(proxy < proxies.size() && "Invalid proxy");
+        proxies[proxy].box = box;
+    }
+
+    void LveBroadPhase::findPairs(const PairCallback& callback) {
+        // insertion sort : the order of the last call is almost right
+        for (size_t i = 1; i < sortedProxies.size(); i++) {
+            uint32_t proxy = sortedProxies[i];
+            float minX = proxies[proxy].box.minX;
+            size_t j = i;
+            while (j > 0 && proxies[sortedProxies[j - 1]].box.minX > minX) {
+                sortedProxies[j] = sortedProxies[j - 1];
+                j--;
+            }
+            sortedProxies[j] = proxy;
+        }
+
+        // sweep : only the boxes still open on X when a box starts can overlap it
+        activeProxies.clear();
+        for (uint32_t proxy : sortedProxies) {
+            const AABB& box = proxies[proxy].box;
+            for (size_t i = 0; i < activeProxies.size();) {
+                const Proxy& other = proxies[activeProxies[i]];
+                if (other.box.maxX < box.minX) {
+                    activeProxies[i] = activeProxies.back();
+                    activeProxies.pop_back();
+                    continue;
+                }
+                if (other.box.minY <= box.maxY && other.box.maxY >= box.minY &&
+                    other.box.minZ <= box.maxZ && other.box.maxZ >= box.minZ) {
+                    callback(other.userData, proxies[proxy].userData);
+                }
+                i++;
+            }
+            activeProxies.push_back(proxy);
+        }
+    }
+}  // namespace lve
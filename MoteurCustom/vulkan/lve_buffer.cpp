@@ -21,27 +21,33 @@ namespace lve {
     LveBuffer::~LveBuffer() {
         unmap();
         vkDestroyBuffer(lveDevice.getDevice(), buffer, nullptr);
-        vkFreeMemory(lveDevice.getDevice(), memory, nullptr);
+        lveDevice.getAllocator().free(memory);
     }
 
     VkResult LveBuffer::map(VkDeviceSize size, VkDeviceSize offset) {
-        assert(buffer && memory && "Called map on buffer before create");
-        return vkMapMemory(lveDevice.getDevice(), memory, offset, size, 0, &mapped);
+        assert(buffer && memory.memory && "Called map on buffer before create");
+        assert(offset <= bufferSize && (size == VK_WHOLE_SIZE || size <= bufferSize - offset) && "Cannot map a range outside of the buffer");
+        // host visible blocks stay mapped, the buffer only points to the range inside its block
+        if (memory.mapped == nullptr) {
+            return VK_ERROR_MEMORY_MAP_FAILED;
+        }
+        mapped = static_cast<char*>(memory.mapped) + offset;
+        mappedSize = size == VK_WHOLE_SIZE ? bufferSize - offset : size;
+        return VK_SUCCESS;
     }
 
     void LveBuffer::unmap() {
-        if (mapped) {
-            vkUnmapMemory(lveDevice.getDevice(), memory);
-            mapped = nullptr;
-        }
+        mapped = nullptr;
+        mappedSize = 0;
     }
 
     void LveBuffer::writeToBuffer(void* data, VkDeviceSize size, VkDeviceSize offset) {
         assert(mapped && "Cannot copy to unmapped buffer");
 
         if (size == VK_WHOLE_SIZE) {
-            memcpy(mapped, data, bufferSize);
+            memcpy(mapped, data, mappedSize);
         } else {
+            assert(offset <= mappedSize && size <= mappedSize - offset && "Cannot copy outside of the mapped range");
             char* memOffset = (char*)mapped;
             memOffset += offset;
             memcpy(memOffset, data, size);
@@ -49,21 +55,11 @@ namespace lve {
     }
 
     VkResult LveBuffer::flush(VkDeviceSize size, VkDeviceSize offset) {
-        VkMappedMemoryRange mappedRange = {};
-        mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-        mappedRange.memory = memory;
-        mappedRange.offset = offset;
-        mappedRange.size = size;
-        return vkFlushMappedMemoryRanges(lveDevice.getDevice(), 1, &mappedRange);
+        return lveDevice.getAllocator().flush(memory, size, offset);
     }
 
     VkResult LveBuffer::invalidate(VkDeviceSize size, VkDeviceSize offset) {
-        VkMappedMemoryRange mappedRange = {};
-        mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-        mappedRange.memory = memory;
-        mappedRange.offset = offset;
-        mappedRange.size = size;
-        return vkInvalidateMappedMemoryRanges(lveDevice.getDevice(), 1, &mappedRange);
+        return lveDevice.getAllocator().invalidate(memory, size, offset);
     }
 
     VkDescriptorBufferInfo LveBuffer::descriptorInfo(VkDeviceSize size, VkDeviceSize offset) {
@@ -25,6 +25,17 @@ namespace lve {
         projectionMatrix[3][2] = -(far * near) / (far - near);
     }
     
+    float LveCamera::getProjectedSize(float size, const glm::vec3& position) const {
+        // clip w is the view depth for the perspective projection and 1 for the orthographic one
+        float viewDepth = glm::dot(glm::vec3(viewMatrix[0][2], viewMatrix[1][2], viewMatrix[2][2]), position) + viewMatrix[3][2];
+        float clipW = projectionMatrix[2][3] * viewDepth + projectionMatrix[3][3];
+        if (clipW <= 0.f) {
+            return std::numeric_limits<float>::max();
+        }
+        // the viewport height spans 2 in normalized device coordinates
+        return size * glm::abs(projectionMatrix[1][1]) * 0.5f / clipW;
+    }
+
     void LveCamera::setViewDirection(glm::vec3 position, glm::vec3 direction, glm::vec3 up) {
         const glm::vec3 w{ glm::normalize(direction) };
         const glm::vec3 u{ glm::normalize(glm::cross(w, up)) };
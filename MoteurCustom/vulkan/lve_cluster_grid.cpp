@@ -0,0 +1,126 @@
+#include "lve_cluster_grid.hpp"
+
+//std
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace lve {
+    namespace {
+        /**
+         * @brief Converts a normalized device coordinate into a tile.
+         * @param ndc : The coordinate, from -1 to 1 on screen.
+         * @param tiles : The number of tiles on this axis.
+         * @return The tile, clamped to the screen.
+        */
+        uint8_t ndcToTile(float ndc, uint32_t tiles) {
+            float tile = std::floor((ndc + 1.f) * 0.5f * static_cast<float>(tiles));
+            return static_cast<uint8_t>(std::clamp(tile, 0.f, static_cast<float>(tiles - 1)));
+        }
+    }
+
+    static_assert(LveClusterGrid::TILES_X <= 256 && LveClusterGrid::TILES_Y <= 256 && LveClusterGrid::SLICES <= 256, "LightBounds stores the cluster ranges on 8 bits");
+
+    float LveClusterGrid::computeLightRange(const glm::vec4& color) {
+        // intensity / distance^2 == LIGHT_CUTOFF
+        float intensity = color.w * std::max({ color.x, color.y, color.z });
+        return std::sqrt(std::max(intensity, 0.f) / LIGHT_CUTOFF);
+    }
+
+    uint32_t LveClusterGrid::getSlice(float viewDepth) const {
+        if (viewDepth <= nearPlane) {
+            return 0;
+        }
+        float slice = std::log(viewDepth) * sliceScale + sliceBias;
+        return static_cast<uint32_t>(std::clamp(slice, 0.f, static_cast<float>(SLICES - 1)));
+    }
+
+    void LveClusterGrid::addLightBounds(const glm::mat4& view, const glm::mat4& projection, uint32_t lightIndex, const PointLight& light) {
+        glm::vec3 center{ view * glm::vec4(glm::vec3(light.position), 1.f) };
+        float radius = light.position.w;
+        float minDepth = center.z - radius;
+        float maxDepth = center.z + radius;
+        if (maxDepth <= nearPlane || minDepth >= farPlane) {
+            return;
+        }
+        uint32_t minSlice = getSlice(std::max(minDepth, nearPlane));
+        uint32_t maxSlice = getSlice(std::min(maxDepth, farPlane));
+
+        for (uint32_t slice = minSlice; slice <= maxSlice; slice++) {
+            // part of the sphere inside the slice : a disc of radius sliceRadius at the depth closest to the center
+            float sliceMinDepth = std::max(minDepth, sliceDepths[slice]);
+            float sliceMaxDepth = std::min(maxDepth, sliceDepths[slice + 1]);
+            float distance = std::max({ sliceMinDepth - center.z, center.z - sliceMaxDepth, 0.f });
+            float sliceRadius = std::sqrt(std::max(radius * radius - distance * distance, 0.f));
+
+            // x / z and y / z are monotonic along each axis, their extremes over the box around the disc are on its corners (the depth is at least the near plane)
+            glm::vec2 minNdc{ 1e30f };
+            glm::vec2 maxNdc{ -1e30f };
+            for (float depth : { sliceMinDepth, sliceMaxDepth }) {
+                for (float offset : { -sliceRadius, sliceRadius }) {
+                    float ndcX = projection[0][0] * (center.x + offset) / depth + projection[2][0];
+                    float ndcY = projection[1][1] * (center.y + offset) / depth + projection[2][1];
+                    minNdc = glm::min(minNdc, glm::vec2{ ndcX, ndcY });
+                    maxNdc = glm::max(maxNdc, glm::vec2{ ndcX, ndcY });
+                }
+            }
+            if (maxNdc.x < -1.f || minNdc.x > 1.f || maxNdc.y < -1.f || minNdc.y > 1.f) {
+                continue;
+            }
+
+            LightBounds bounds{};
+            bounds.light = lightIndex;
+            bounds.slice = static_cast<uint8_t>(slice);
+            bounds.minX = ndcToTile(minNdc.x, TILES_X);
+            bounds.maxX = ndcToTile(maxNdc.x, TILES_X);
+            bounds.minY = ndcToTile(minNdc.y, TILES_Y);
+            bounds.maxY = ndcToTile(maxNdc.y, TILES_Y);
+            lightBounds.push_back(bounds);
+        }
+    }
+
+    void LveClusterGrid::build(const glm::mat4& view, const glm::mat4& projection, const std::vector<PointLight>& lights) {
+        assert(projection[2][3] == 1.f && "Clustered lighting needs a perspective projection");
+        nearPlane = -projection[3][2] / projection[2][2];
+        farPlane = projection[3][2] / (1.f - projection[2][2]);
+        float logRatio = std::log(farPlane / nearPlane);
+        sliceScale = static_cast<float>(SLICES) / logRatio;
+        sliceBias = -static_cast<float>(SLICES) * std::log(nearPlane) / logRatio;
+
+        for (uint32_t slice = 0; slice <= SLICES; slice++) {
+            sliceDepths[slice] = nearPlane * std::pow(farPlane / nearPlane, static_cast<float>(slice) / SLICES);
+        }
+
+        // first pass : number of lights of each cluster
+        lightBounds.clear();
+        for (uint32_t i = 0; i < lights.size(); i++) {
+            addLightBounds(view, projection, i, lights[i]);
+        }
+        std::fill(clusters.begin(), clusters.end(), glm::uvec2{ 0 });
+        for (const auto& bounds : lightBounds) {
+            for (uint32_t y = bounds.minY; y <= bounds.maxY; y++) {
+                for (uint32_t x = bounds.minX; x <= bounds.maxX; x++) {
+                    clusters[getClusterIndex(x, y, bounds.slice)].y++;
+                }
+            }
+        }
+
+        uint32_t offset = 0;
+        for (auto& cluster : clusters) {
+            cluster.x = offset;
+            offset += cluster.y;
+            cluster.y = 0;
+        }
+
+        // second pass : the counts are rebuilt while the lights are written
+        lightIndices.resize(offset);
+        for (const auto& bounds : lightBounds) {
+            for (uint32_t y = bounds.minY; y <= bounds.maxY; y++) {
+                for (uint32_t x = bounds.minX; x <= bounds.maxX; x++) {
+                    auto& cluster = clusters[getClusterIndex(x, y, bounds.slice)];
+                    lightIndices[cluster.x + cluster.y++] = bounds.light;
+                }
+            }
+        }
+    }
+}  // namespace lve
@@ -0,0 +1,42 @@
+#include "lve_compute_pipeline.hpp"
+#include "lve_pipeline.hpp"
+
+//std
+#include <cassert>
+#include <stdexcept>
+
+namespace lve {
+    LveComputePipeline::LveComputePipeline(LveDevice& device, const std::string& compFilePath, VkPipelineLayout pipelineLayout) : lveDevice{ device } {
+        assert(pipelineLayout != VK_NULL_HANDLE && "Cannot create compute pipeline: no pipelineLayout provided");
+
+        auto compCode = LvePipeline::readFile(compFilePath);
+
+        VkShaderModuleCreateInfo moduleInfo{};
+        moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        moduleInfo.codeSize = compCode.size();
+        moduleInfo.pCode = reinterpret_cast<const uint32_t*>(compCode.data());
+        if (vkCreateShaderModule(lveDevice.getDevice(), &moduleInfo, nullptr, &compShaderModule) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create shader module");
+        }
+
+        VkComputePipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInfo.stage.module = compShaderModule;
+        pipelineInfo.stage.pName = "main";
+        pipelineInfo.layout = pipelineLayout;
+        if (vkCreateComputePipelines(lveDevice.getDevice(), lveDevice.getPipelineCache(), 1, &pipelineInfo, nullptr, &computePipeline) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create compute pipeline");
+        }
+    }
+
+    LveComputePipeline::~LveComputePipeline() {
+        vkDestroyShaderModule(lveDevice.getDevice(), compShaderModule, nullptr);
+        vkDestroyPipeline(lveDevice.getDevice(), computePipeline, nullptr);
+    }
+
+    void LveComputePipeline::bind(VkCommandBuffer commandBuffer) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline);
+    }
+}  // namespace lve
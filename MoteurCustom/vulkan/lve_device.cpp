@@ -1,7 +1,12 @@
 #include "lve_device.hpp"
+#include "lve_upload_queue.hpp"
+#include "lve_geometry_pool.hpp"
+#include "lve_pipeline_registry.hpp"
 
 // std headers
 #include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <set>
 #include <unordered_set>
@@ -38,9 +43,24 @@ namespace lve {
         pickPhysicalDevice();
         createLogicalDevice();
         createCommandPool();
+        createPipelineCache();
+        allocator = std::make_unique<LveMemoryAllocator>(device_, physicalDevice);
+        uploadQueue = std::make_unique<LveUploadQueue>(*this);
+        geometryPool = std::make_unique<LveGeometryPool>(*this);
+        pipelineRegistry = std::make_unique<LvePipelineRegistry>(*this);
     }
     
     LveDevice::~LveDevice() {
+        // the upload queue waits for the copies into the geometry blocks
+        uploadQueue.reset();
+        geometryPool.reset();
+        allocator.reset();
+        // the registry destroys the pipelines replaced by its reloads, their code stays in the cache
+        pipelineRegistry.reset();
+        if (!savePipelineCache()) {
+            std::cerr << "failed to write pipeline cache " << PIPELINE_CACHE_PATH << "\n";
+        }
+        vkDestroyPipelineCache(device_, pipelineCache_, nullptr);
         vkDestroyCommandPool(device_, commandPool, nullptr);
         vkDestroyDevice(device_, nullptr);
 
@@ -48,7 +68,9 @@ namespace lve {
             DestroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr);
         }
 
-        vkDestroySurfaceKHR(instance, surface_, nullptr);
+        if (surface_ != VK_NULL_HANDLE) {
+            vkDestroySurfaceKHR(instance, surface_, nullptr);
+        }
         vkDestroyInstance(instance, nullptr);
     }
     
@@ -92,6 +114,77 @@ namespace lve {
         hasGflwRequiredInstanceExtensions();
     }
     
+    void LveDevice::createPipelineCache() {
+        std::vector<char> data{};
+        std::ifstream file{ PIPELINE_CACHE_PATH, std::ios::ate | std::ios::binary };
+        if (file.is_open()) {
+            data.resize(static_cast<size_t>(file.tellg()));
+            file.seekg(0);
+            file.read(data.data(), data.size());
+            if (!file.good() || !isPipelineCacheCompatible(data.data(), data.size())) {
+                // stale or foreign data, the pipelines are compiled again and the file is rewritten on exit
+                data.clear();
+            }
+        }
+
+        VkPipelineCacheCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        createInfo.initialDataSize = data.size();
+        createInfo.pInitialData = data.empty() ? nullptr : data.data();
+        if (vkCreatePipelineCache(device_, &createInfo, nullptr, &pipelineCache_) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create pipeline cache!");
+        }
+        std::cout << "Pipeline cache: " << (data.empty() ? "empty" : std::to_string(data.size()) + " bytes loaded") << std::endl;
+    }
+
+    bool LveDevice::isPipelineCacheCompatible(const char* data, size_t size) const {
+        // VkPipelineCacheHeaderVersionOne : header size, header version, vendor ID, device ID, pipeline cache UUID
+        constexpr size_t HEADER_SIZE = 4 * sizeof(uint32_t) + VK_UUID_SIZE;
+        if (size < HEADER_SIZE) {
+            return false;
+        }
+        uint32_t header[4];
+        std::memcpy(header, data, sizeof(header));
+        return header[0] >= HEADER_SIZE
+            && header[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+            && header[2] == properties.vendorID
+            && header[3] == properties.deviceID
+            && std::memcmp(data + sizeof(header), properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+    }
+
+    bool LveDevice::savePipelineCache() {
+        size_t size = 0;
+        if (vkGetPipelineCacheData(device_, pipelineCache_, &size, nullptr) != VK_SUCCESS || size == 0) {
+            return false;
+        }
+        std::vector<char> data(size);
+        if (vkGetPipelineCacheData(device_, pipelineCache_, &size, data.data()) != VK_SUCCESS) {
+            return false;
+        }
+
+        std::string temporaryPath = std::string{ PIPELINE_CACHE_PATH } + ".tmp";
+        {
+            std::ofstream file{ temporaryPath, std::ios::binary | std::ios::trunc };
+            if (!file.is_open()) {
+                return false;
+            }
+            file.write(data.data(), size);
+            if (!file.good()) {
+                file.close();
+                std::filesystem::remove(temporaryPath);
+                return false;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporaryPath, PIPELINE_CACHE_PATH, error);
+        if (error) {
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+        return true;
+    }
+
     void LveDevice::pickPhysicalDevice() {
         uint32_t deviceCount = 0;
         vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
@@ -121,20 +214,25 @@ namespace lve {
         QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
 
         std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-        std::set<uint32_t> uniqueQueueFamilies = { indices.graphicsFamily, indices.presentFamily };
+        std::set<uint32_t> uniqueQueueFamilies = { indices.graphicsFamily, indices.presentFamily, indices.transferFamily };
 
-        float queuePriority = 1.0f;
+        float queuePriorities[] = { 1.0f, 1.0f };
         for (uint32_t queueFamily : uniqueQueueFamilies) {
             VkDeviceQueueCreateInfo queueCreateInfo = {};
             queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
             queueCreateInfo.queueFamilyIndex = queueFamily;
-            queueCreateInfo.queueCount = 1;
-            queueCreateInfo.pQueuePriorities = &queuePriority;
+            queueCreateInfo.queueCount = queueFamily == indices.transferFamily ? indices.transferQueueIndex + 1 : 1;
+            queueCreateInfo.pQueuePriorities = queuePriorities;
             queueCreateInfos.push_back(queueCreateInfo);
         }
 
+        VkPhysicalDeviceFeatures supportedFeatures;
+        vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+        multiDrawIndirect_ = supportedFeatures.multiDrawIndirect == VK_TRUE;
+
         VkPhysicalDeviceFeatures deviceFeatures = {};
         deviceFeatures.samplerAnisotropy = VK_TRUE;
+        deviceFeatures.multiDrawIndirect = multiDrawIndirect_ ? VK_TRUE : VK_FALSE;
 
         VkDeviceCreateInfo createInfo = {};
         createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -143,8 +241,9 @@ namespace lve {
         createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
         createInfo.pEnabledFeatures = &deviceFeatures;
-        createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-        createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+        auto extensions = getRequiredDeviceExtensions();
+        createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+        createInfo.ppEnabledExtensionNames = extensions.data();
 
         // might not really be necessary anymore because device specific validation layers
         // have been deprecated
@@ -161,6 +260,9 @@ namespace lve {
 
         vkGetDeviceQueue(device_, indices.graphicsFamily, 0, &graphicsQueue_);
         vkGetDeviceQueue(device_, indices.presentFamily, 0, &presentQueue_);
+        vkGetDeviceQueue(device_, indices.transferFamily, indices.transferQueueIndex, &transferQueue_);
+        graphicsFamily_ = indices.graphicsFamily;
+        transferFamily_ = indices.transferFamily;
     }
     
     void LveDevice::createCommandPool() {
@@ -177,6 +279,9 @@ namespace lve {
     }
     
     void LveDevice::createSurface() {
+        if (isHeadless()) {
+            return;
+        }
         window.createWindowSurface(instance, &surface_);
     }
     
@@ -185,8 +290,8 @@ namespace lve {
 
         bool extensionsSupported = checkDeviceExtensionSupport(device);
 
-        bool swapChainAdequate = false;
-        if (extensionsSupported) {
+        bool swapChainAdequate = isHeadless();
+        if (extensionsSupported && !isHeadless()) {
             SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
             swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
         }
@@ -241,11 +346,13 @@ namespace lve {
     }
     
     std::vector<const char*> LveDevice::getRequiredExtensions() {
-        uint32_t glfwExtensionCount = 0;
-        const char** glfwExtensions;
-        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-
-        std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        std::vector<const char*> extensions{};
+        if (!isHeadless()) {
+            uint32_t glfwExtensionCount = 0;
+            const char** glfwExtensions;
+            glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+            extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        }
 
         if (enableValidationLayers) {
             extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -284,6 +391,7 @@ namespace lve {
         std::vector<VkExtensionProperties> availableExtensions(extensionCount);
         vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
 
+        auto deviceExtensions = getRequiredDeviceExtensions();
         std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
 
         for (const auto& extension : availableExtensions) {
@@ -292,6 +400,13 @@ namespace lve {
 
         return requiredExtensions.empty();
     }
+
+    std::vector<const char*> LveDevice::getRequiredDeviceExtensions() {
+        if (isHeadless()) {
+            return {};
+        }
+        return deviceExtensions;
+    }
     
     QueueFamilyIndices LveDevice::findQueueFamilies(VkPhysicalDevice device) {
         QueueFamilyIndices indices;
@@ -309,7 +424,12 @@ namespace lve {
                 indices.graphicsFamilyHasValue = true;
             }
             VkBool32 presentSupport = false;
-            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface_, &presentSupport);
+            if (isHeadless()) {
+                // nothing is presented, the graphics queue doubles as the "present" queue
+                presentSupport = indices.graphicsFamilyHasValue && indices.graphicsFamily == static_cast<uint32_t>(i);
+            } else {
+                vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface_, &presentSupport);
+            }
             if (queueFamily.queueCount > 0 && presentSupport) {
                 indices.presentFamily = i;
                 indices.presentFamilyHasValue = true;
@@ -321,6 +441,21 @@ namespace lve {
             i++;
         }
 
+        // uploads go to a transfer only family (the DMA engines of discrete GPUs), else to a second graphics queue, else to the graphics queue itself
+        indices.transferFamily = indices.graphicsFamily;
+        indices.transferQueueIndex = 0;
+        bool transferOnly = false;
+        for (uint32_t family = 0; family < queueFamilies.size() && !transferOnly; family++) {
+            const auto& queueFamily = queueFamilies[family];
+            transferOnly = queueFamily.queueCount > 0 && (queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) && !(queueFamily.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT));
+            if (transferOnly) {
+                indices.transferFamily = family;
+            }
+        }
+        if (!transferOnly && indices.graphicsFamilyHasValue && queueFamilies[indices.graphicsFamily].queueCount > 1) {
+            indices.transferQueueIndex = 1;
+        }
+
         return indices;
     }
     
@@ -373,13 +508,21 @@ namespace lve {
         throw std::runtime_error("failed to find suitable memory type!");
     }
     
-    void LveDevice::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory) {
+    void LveDevice::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, LveAllocation& bufferMemory) {
         VkBufferCreateInfo bufferInfo{};
         bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
         bufferInfo.size = size;
         bufferInfo.usage = usage;
         bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+        // uploads are copied on the transfer queue and read on the graphics queue, without ownership transfer
+        uint32_t queueFamilies[] = { graphicsFamily_, transferFamily_ };
+        if ((usage & VK_BUFFER_USAGE_TRANSFER_DST_BIT) && graphicsFamily_ != transferFamily_) {
+            bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+            bufferInfo.queueFamilyIndexCount = 2;
+            bufferInfo.pQueueFamilyIndices = queueFamilies;
+        }
+
         if (vkCreateBuffer(device_, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
             throw std::runtime_error("failed to create vertex buffer!");
         }
@@ -387,16 +530,8 @@ namespace lve {
         VkMemoryRequirements memRequirements;
         vkGetBufferMemoryRequirements(device_, buffer, &memRequirements);
 
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-        if (vkAllocateMemory(device_, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
-            throw std::runtime_error("failed to allocate vertex buffer memory!");
-        }
-
-        vkBindBufferMemory(device_, buffer, bufferMemory, 0);
+        bufferMemory = allocator->allocate(memRequirements, findMemoryType(memRequirements.memoryTypeBits, properties), false);
+        vkBindBufferMemory(device_, buffer, bufferMemory.memory, bufferMemory.offset);
     }
     
     VkCommandBuffer LveDevice::beginSingleTimeCommands() {
@@ -417,6 +552,31 @@ namespace lve {
         return commandBuffer;
     }
     
+    std::unique_lock<std::mutex> LveDevice::lockQueue(VkQueue queue) {
+        // a queue equal to the graphics (or present) queue takes its mutex, so that one VkQueue has a single mutex
+        if (queue == graphicsQueue_) {
+            return std::unique_lock<std::mutex>{ queueMutexes_[0] };
+        }
+        if (queue == presentQueue_) {
+            return std::unique_lock<std::mutex>{ queueMutexes_[1] };
+        }
+        return std::unique_lock<std::mutex>{ queueMutexes_[2] };
+    }
+
+    std::array<std::unique_lock<std::mutex>, LveDevice::QUEUE_MUTEX_COUNT> LveDevice::lockQueues() {
+        std::array<std::unique_lock<std::mutex>, QUEUE_MUTEX_COUNT> locks{
+            std::unique_lock<std::mutex>{ queueMutexes_[0], std::defer_lock },
+            std::unique_lock<std::mutex>{ queueMutexes_[1], std::defer_lock },
+            std::unique_lock<std::mutex>{ queueMutexes_[2], std::defer_lock } };
+        std::lock(locks[0], locks[1], locks[2]);
+        return locks;
+    }
+
+    void LveDevice::waitIdle() {
+        auto queueLocks = lockQueues();
+        vkDeviceWaitIdle(device_);
+    }
+
     void LveDevice::endSingleTimeCommands(VkCommandBuffer commandBuffer) {
         vkEndCommandBuffer(commandBuffer);
 
@@ -425,8 +585,11 @@ namespace lve {
         submitInfo.commandBufferCount = 1;
         submitInfo.pCommandBuffers = &commandBuffer;
 
-        vkQueueSubmit(graphicsQueue_, 1, &submitInfo, VK_NULL_HANDLE);
-        vkQueueWaitIdle(graphicsQueue_);
+        {
+            auto queueLock = lockQueue(graphicsQueue_);
+            vkQueueSubmit(graphicsQueue_, 1, &submitInfo, VK_NULL_HANDLE);
+            vkQueueWaitIdle(graphicsQueue_);
+        }
 
         vkFreeCommandBuffers(device_, commandPool, 1, &commandBuffer);
     }
@@ -463,7 +626,7 @@ namespace lve {
         endSingleTimeCommands(commandBuffer);
     }
     
-    void LveDevice::createImageWithInfo(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory) {
+    void LveDevice::createImageWithInfo(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties, VkImage& image, LveAllocation& imageMemory) {
         if (vkCreateImage(device_, &imageInfo, nullptr, &image) != VK_SUCCESS) {
             throw std::runtime_error("failed to create image!");
         }
@@ -471,16 +634,8 @@ namespace lve {
         VkMemoryRequirements memRequirements;
         vkGetImageMemoryRequirements(device_, image, &memRequirements);
 
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-        if (vkAllocateMemory(device_, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS) {
-            throw std::runtime_error("failed to allocate image memory!");
-        }
-
-        if (vkBindImageMemory(device_, image, imageMemory, 0) != VK_SUCCESS) {
+        imageMemory = allocator->allocate(memRequirements, findMemoryType(memRequirements.memoryTypeBits, properties), imageInfo.tiling == VK_IMAGE_TILING_OPTIMAL);
+        if (vkBindImageMemory(device_, image, imageMemory.memory, imageMemory.offset) != VK_SUCCESS) {
             throw std::runtime_error("failed to bind image memory!");
         }
     }
@@ -0,0 +1,63 @@
+#include "lve_frustum.hpp"
+
+//std
+#include <cmath>
+
+namespace lve {
+    LveFrustum::LveFrustum() {
+        planes.fill(glm::vec4{ 0.f, 0.f, 0.f, 1.f });
+    }
+
+    LveFrustum::LveFrustum(const glm::mat4& viewProjection) {
+        // Gribb-Hartmann : each plane is a combination of the rows of the matrix
+        glm::vec4 rows[4];
+        for (int i = 0; i < 4; i++) {
+            rows[i] = { viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i] };
+        }
+        planes[0] = rows[3] + rows[0];
+        planes[1] = rows[3] - rows[0];
+        planes[2] = rows[3] + rows[1];
+        planes[3] = rows[3] - rows[1];
+        planes[4] = rows[2];
+        planes[5] = rows[3] - rows[2];
+        for (auto& plane : planes) {
+            plane /= glm::length(glm::vec3(plane));
+        }
+    }
+
+    bool LveFrustum::intersectsAABB(const AABB& box) const {
+        for (const auto& plane : planes) {
+            // corner of the box the furthest along the normal of the plane
+            glm::vec3 corner{
+                plane.x >= 0.f ? box.maxX : box.minX,
+                plane.y >= 0.f ? box.maxY : box.minY,
+                plane.z >= 0.f ? box.maxZ : box.minZ
+            };
+            if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.f) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool LveFrustum::intersectsSphere(const glm::vec3& center, float radius) const {
+        for (const auto& plane : planes) {
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    AABB LveFrustum::transformAABB(const AABB& box, const glm::mat4& matrix) {
+        // the center is transformed, the half size is projected on each axis by the absolute matrix
+        glm::vec3 center{ (box.minX + box.maxX) * 0.5f, (box.minY + box.maxY) * 0.5f, (box.minZ + box.maxZ) * 0.5f };
+        glm::vec3 halfSize{ (box.maxX - box.minX) * 0.5f, (box.maxY - box.minY) * 0.5f, (box.maxZ - box.minZ) * 0.5f };
+        glm::vec3 newCenter = glm::vec3(matrix * glm::vec4(center, 1.f));
+        glm::vec3 newHalfSize{ 0.f };
+        for (int column = 0; column < 3; column++) {
+            newHalfSize += glm::abs(glm::vec3(matrix[column])) * halfSize[column];
+        }
+        return AABB(newCenter - newHalfSize, newCenter + newHalfSize);
+    }
+}  // namespace lve
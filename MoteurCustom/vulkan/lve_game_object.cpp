@@ -1,77 +1,94 @@
 #include "lve_game_object.hpp"
 
+//libs
+#include "glm/gtc/constants.hpp"
+
 namespace lve {
-    glm::mat4 TransformComponent::mat4() {
-        const float c3 = glm::cos(rotation.z);
-        const float s3 = glm::sin(rotation.z);
-        const float c2 = glm::cos(rotation.x);
-        const float s2 = glm::sin(rotation.x);
-        const float c1 = glm::cos(rotation.y);
-        const float s1 = glm::sin(rotation.y);
-        return glm::mat4{
-            {
-                scale.x * (c1 * c3 + s1 * s2 * s3),
-                scale.x * (c2 * s3),
-                scale.x * (c1 * s2 * s3 - c3 * s1),
-                0.0f,
-            },
-            {
-                scale.y * (c3 * s1 * s2 - c1 * s3),
-                scale.y * (c2 * c3),
-                scale.y * (c1 * c3 * s2 + s1 * s3),
-                0.0f,
-            },
-            {
-                scale.z * (c2 * s1),
-                scale.z * (-s2),
-                scale.z * (c1 * c2),
-                0.0f,
-            },
-            {translation.x, translation.y, translation.z, 1.0f} };
+    const glm::mat4& TransformComponent::mat4() {
+        if (dirty) {
+            updateMatrices();
+        }
+        return modelMatrix;
     }
     
-    glm::mat3 TransformComponent::normalMatrix() {
-        const float c3 = glm::cos(rotation.z);
-        const float s3 = glm::sin(rotation.z);
-        const float c2 = glm::cos(rotation.x);
-        const float s2 = glm::sin(rotation.x);
-        const float c1 = glm::cos(rotation.y);
-        const float s1 = glm::sin(rotation.y);
-        const glm::vec3 invScale = 1.0f / scale;
+    const glm::mat3& TransformComponent::normalMatrix() {
+        if (dirty) {
+            updateMatrices();
+        }
+        return normalMat;
+    }
+
+    void TransformComponent::updateMatrices() {
+        computeTransformMatrices(getInterpolatedTranslation(), getInterpolatedRotation(), getInterpolatedScale(), modelMatrix, normalMat);
+        dirty = false;
+    }
+
+    glm::vec3 TransformComponent::getInterpolatedRotation() const {
+        // an angle wrapped around a turn between the steps must not spin the other way
+        glm::vec3 delta = rotation - previousRotation;
+        delta -= glm::two_pi<float>() * glm::round(delta / glm::two_pi<float>());
+        return previousRotation + delta * interpolation;
+    }
+
+    void TransformComponent::storePreviousState() {
+        bool moved = previousTranslation != translation || previousRotation != rotation || previousScale != scale;
+        if (moved && interpolation != 1.f) {
+            dirty = true;
+        }
+        previousTranslation = translation;
+        previousRotation = rotation;
+        previousScale = scale;
+    }
+
+    void TransformComponent::setInterpolation(float alpha) {
+        if (alpha == interpolation) {
+            return;
+        }
+        if (previousTranslation != translation || previousRotation != rotation || previousScale != scale) {
+            dirty = true;
+        }
+        interpolation = alpha;
+    }
 
-        return glm::mat3{
-            {
-                invScale.x * (c1 * c3 + s1 * s2 * s3),
-                invScale.x * (c2 * s3),
-                invScale.x * (c1 * s2 * s3 - c3 * s1),
-            },
-            {
-                invScale.y * (c3 * s1 * s2 - c1 * s3),
-                invScale.y * (c2 * c3),
-                invScale.y * (c1 * c3 * s2 + s1 * s3),
-            },
-            {
-                invScale.z * (c2 * s1),
-                invScale.z * (-s2),
-                invScale.z * (c1 * c2),
-            }
-        };
+    void TransformComponent::setCachedMatrices(const glm::mat4& modelMatrix, const glm::mat3& normalMatrix) {
+        this->modelMatrix = modelMatrix;
+        this->normalMat = normalMatrix;
+        dirty = false;
     }
     
     void TransformComponent::setTransform(glm::vec3 translation, glm::vec3 scale) {
-        this->translation = translation;
-        this->scale = scale;
-        //Modification de la boite de colision en consequence
-        colisionBox.setBoxPoint({ this->translation.x - this->scale.x / 2,
-                                 this->translation.y - this->scale.y / 2,
-                                 this->translation.z - this->scale.z / 2 },
-                                { this->translation.x + this->scale.x / 2,
-                                 this->translation.y + this->scale.y / 2,
-                                 this->translation.z + this->scale.z / 2 });
+        if (this->translation != translation || this->scale != scale) {
+            this->translation = translation;
+            this->scale = scale;
+            dirty = true;
+        }
+        updateColisionBox();
     }
     
     void TransformComponent::setTranslation(glm::vec3 translation) {
-        this->translation = translation;
+        if (this->translation != translation) {
+            this->translation = translation;
+            dirty = true;
+        }
+        updateColisionBox();
+    }
+
+    void TransformComponent::setRotation(glm::vec3 rotation) {
+        if (this->rotation != rotation) {
+            this->rotation = rotation;
+            dirty = true;
+        }
+    }
+
+    void TransformComponent::setScale(glm::vec3 scale) {
+        if (this->scale != scale) {
+            this->scale = scale;
+            dirty = true;
+        }
+        updateColisionBox();
+    }
+
+    void TransformComponent::updateColisionBox() {
         //Modification de la boite de colision en consequence
         colisionBox.setBoxPoint({ this->translation.x - this->scale.x / 2,
                                  this->translation.y - this->scale.y / 2,
@@ -83,8 +100,7 @@ namespace lve {
     
     void TransformComponent::update() {
         this->vitesse += this->acceleration;
-        this->translation += this->vitesse;
-        setTranslation(this->translation);
+        setTranslation(this->translation + this->vitesse);
     }
     
     void TransformComponent::updateAcceleration() {
@@ -101,12 +117,25 @@ namespace lve {
         this->vitesse *= this->colisionBox.normIntersectAABB(box);
     }
     
-    LveGameObject LveGameObject::makePointLight(float intensity, float radius, glm::vec3 color) {
-        LveGameObject gameObj = LveGameObject::createGameObject();
-        gameObj.color = color;
-        gameObj.transform.scale.x = radius;
-        gameObj.pointLight = std::make_unique<PointLightComponent>();
-        gameObj.pointLight->lightIntensity = intensity;
+    LveGameObject LveGameObject::createGameObject(LveRegistry& registry) {
+        LveGameObject gameObj{ registry, registry.create() };
+        registry.emplace<TransformComponent>(gameObj.getId());
         return gameObj;
     }
+
+    LveGameObject LveGameObject::makePointLight(LveRegistry& registry, float intensity, float radius, glm::vec3 color) {
+        LveGameObject gameObj = LveGameObject::createGameObject(registry);
+        gameObj.transform().setScale({ radius, 1.f, 1.f });
+        gameObj.addComponent<PointLightComponent>(intensity, color);
+        return gameObj;
+    }
+
+    void LveGameObject::setModel(std::shared_ptr<LveModel> model) {
+        if (auto* component = registry->tryGet<ModelComponent>(id)) {
+            component->model = std::move(model);
+        }
+        else {
+            registry->emplace<ModelComponent>(id, std::move(model));
+        }
+    }
 }
\ No newline at end of file
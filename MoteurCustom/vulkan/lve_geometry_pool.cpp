@@ -0,0 +1,337 @@
+#include "lve_geometry_pool.hpp"
+#include "lve_swap_chain.hpp"
+#include "lve_upload_queue.hpp"
+
+//std
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace lve {
+    namespace {
+        constexpr uint32_t NO_BLOCK = UINT32_MAX;
+
+        /**
+         * @brief Rounds a value up to a multiple of an alignment.
+         * @param value : The value.
+         * @param alignment : The alignment (not zero, not necessarily a power of two).
+         * @return The aligned value.
+        */
+        VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+    }
+
+    LveGeometryPool::LveGeometryPool(LveDevice& device) : lveDevice{ device } {}
+
+    LveGeometryPool::~LveGeometryPool() {}
+
+    bool LveGeometryPool::allocateRange(Block& block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset) {
+        auto best = block.freeRanges.end();
+        VkDeviceSize bestStart = 0;
+        VkDeviceSize bestWaste = std::numeric_limits<VkDeviceSize>::max();
+        for (auto it = block.freeRanges.begin(); it != block.freeRanges.end(); ++it) {
+            VkDeviceSize start = alignUp(it->first, alignment);
+            if (start + size > it->first + it->second) {
+                continue;
+            }
+            VkDeviceSize waste = it->second - size;
+            if (waste < bestWaste) {
+                best = it;
+                bestStart = start;
+                bestWaste = waste;
+            }
+        }
+        if (best == block.freeRanges.end()) {
+            return false;
+        }
+
+        // the padding before the range and the rest after it stay free
+        VkDeviceSize rangeOffset = best->first;
+        VkDeviceSize rangeEnd = best->first + best->second;
+        block.freeRanges.erase(best);
+        if (bestStart > rangeOffset) {
+            block.freeRanges[rangeOffset] = bestStart - rangeOffset;
+        }
+        if (bestStart + size < rangeEnd) {
+            block.freeRanges[bestStart + size] = rangeEnd - (bestStart + size);
+        }
+        block.usedBytes += size;
+        offset = bestStart;
+        return true;
+    }
+
+    void LveGeometryPool::freeRange(Block& block, VkDeviceSize offset, VkDeviceSize size) {
+        block.usedBytes -= size;
+        auto next = block.freeRanges.lower_bound(offset);
+        if (next != block.freeRanges.end() && offset + size == next->first) {
+            size += next->second;
+            next = block.freeRanges.erase(next);
+        }
+        if (next != block.freeRanges.begin()) {
+            auto previous = std::prev(next);
+            if (previous->first + previous->second == offset) {
+                previous->second += size;
+                return;
+            }
+        }
+        block.freeRanges[offset] = size;
+    }
+
+    bool LveGeometryPool::place(const Mesh& mesh, uint32_t excludedBlock, bool createBlock, Placement& placement) {
+        VkDeviceSize vertexBytes = static_cast<VkDeviceSize>(mesh.vertexStride) * mesh.vertexCount;
+        VkDeviceSize indexBytes = static_cast<VkDeviceSize>(mesh.indexSize) * mesh.indexCount;
+
+        auto tryBlock = [&](uint32_t b) {
+            Block& block = *blocks[b];
+            VkDeviceSize vertexOffset = 0;
+            VkDeviceSize indexOffset = 0;
+            if (!allocateRange(block, vertexBytes, mesh.vertexStride, vertexOffset)) {
+                return false;
+            }
+            if (indexBytes > 0 && !allocateRange(block, indexBytes, mesh.indexSize, indexOffset)) {
+                freeRange(block, vertexOffset, vertexBytes);
+                return false;
+            }
+            block.meshCount++;
+            placement = { b, vertexOffset, indexOffset };
+            return true;
+        };
+
+        for (uint32_t b = 0; b < blocks.size(); b++) {
+            if (b != excludedBlock && blocks[b] != nullptr && tryBlock(b)) {
+                return true;
+            }
+        }
+        if (!createBlock) {
+            return false;
+        }
+
+        // room for the alignment padding of both ranges
+        auto block = std::make_unique<Block>();
+        block->size = std::max(BLOCK_SIZE, vertexBytes + indexBytes + mesh.vertexStride + mesh.indexSize);
+        block->buffer = std::make_unique<LveBuffer>(lveDevice, block->size, 1,
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        block->freeRanges[0] = block->size;
+
+        auto slot = std::find(blocks.begin(), blocks.end(), nullptr);
+        uint32_t b = static_cast<uint32_t>(slot - blocks.begin());
+        if (slot == blocks.end()) {
+            blocks.push_back(std::move(block));
+        } else {
+            *slot = std::move(block);
+        }
+        bool placed = tryBlock(b);
+        assert(placed && "A new geometry block must hold the mesh it was created for");
+        return placed;
+    }
+
+    void LveGeometryPool::updateRange(Mesh& mesh) {
+        mesh.range.block = mesh.placement.block;
+        mesh.range.vertexOffset = static_cast<int32_t>(mesh.placement.vertexOffset / mesh.vertexStride);
+        mesh.range.firstIndex = mesh.indexCount > 0 ? static_cast<uint32_t>(mesh.placement.indexOffset / mesh.indexSize) : 0;
+    }
+
+    uint32_t LveGeometryPool::allocate(uint32_t vertexStride, uint32_t vertexCount, uint32_t indexSize, uint32_t indexCount) {
+        std::lock_guard<std::mutex> lock{ mutex };
+        // a new block may fail to be created (out of device memory), the handle is only taken once the mesh is placed
+        Mesh mesh{};
+        mesh.vertexStride = vertexStride;
+        mesh.vertexCount = vertexCount;
+        mesh.indexSize = indexSize;
+        mesh.indexCount = indexCount;
+        place(mesh, NO_BLOCK, true, mesh.placement);
+        updateRange(mesh);
+        mesh.live = true;
+
+        uint32_t handle;
+        if (!freeMeshes.empty()) {
+            handle = freeMeshes.back();
+            freeMeshes.pop_back();
+            meshes[handle] = mesh;
+        } else {
+            handle = static_cast<uint32_t>(meshes.size());
+            meshes.push_back(mesh);
+        }
+        return handle;
+    }
+
+    uint64_t LveGeometryPool::upload(uint32_t mesh, const void* vertices, const void* indices) {
+        VkBuffer buffer;
+        Placement placement;
+        VkDeviceSize vertexBytes;
+        VkDeviceSize indexBytes;
+        {
+            std::lock_guard<std::mutex> lock{ mutex };
+            const Mesh& uploaded = meshes[mesh];
+            assert(uploaded.live && uploaded.uploadTicket == 0 && "A mesh is uploaded once");
+            buffer = blocks[uploaded.placement.block]->buffer->getBuffer();
+            placement = uploaded.placement;
+            vertexBytes = static_cast<VkDeviceSize>(uploaded.vertexStride) * uploaded.vertexCount;
+            indexBytes = static_cast<VkDeviceSize>(uploaded.indexSize) * uploaded.indexCount;
+        }
+
+        // the upload may wait for the staging ring, the draws must not wait for it
+        LveUploadQueue& uploadQueue = lveDevice.getUploadQueue();
+        uint64_t ticket = uploadQueue.upload(vertices, vertexBytes, buffer, placement.vertexOffset);
+        if (indexBytes > 0) {
+            // both copies go in the same batch (or a later one), the ticket of the indices covers the vertices too
+            ticket = uploadQueue.upload(indices, indexBytes, buffer, placement.indexOffset);
+        }
+
+        // a move copies the mesh after its upload in the queue
+        std::lock_guard<std::mutex> lock{ mutex };
+        meshes[mesh].uploadTicket = ticket;
+        return ticket;
+    }
+
+    void LveGeometryPool::retirePlacement(const Mesh& mesh, const Placement& placement) {
+        PendingFree pendingFree{};
+        pendingFree.block = placement.block;
+        pendingFree.vertexOffset = placement.vertexOffset;
+        pendingFree.vertexBytes = static_cast<VkDeviceSize>(mesh.vertexStride) * mesh.vertexCount;
+        pendingFree.indexOffset = placement.indexOffset;
+        pendingFree.indexBytes = static_cast<VkDeviceSize>(mesh.indexSize) * mesh.indexCount;
+        pendingFree.frame = frameCount;
+        pendingFrees.push_back(pendingFree);
+    }
+
+    void LveGeometryPool::free(uint32_t mesh) {
+        uint64_t moveTicket;
+        {
+            std::lock_guard<std::mutex> lock{ mutex };
+            moveTicket = meshes[mesh].moveTicket;
+        }
+        // the copy of a move still writes into the new ranges
+        if (moveTicket != 0) {
+            lveDevice.getUploadQueue().wait(moveTicket);
+        }
+
+        std::lock_guard<std::mutex> lock{ mutex };
+        Mesh& released = meshes[mesh];
+        retirePlacement(released, released.placement);
+        if (released.moveTicket != 0) {
+            retirePlacement(released, released.movePlacement);
+            released.moveTicket = 0;
+            movingMeshes.erase(std::find(movingMeshes.begin(), movingMeshes.end(), mesh));
+        }
+        released.live = false;
+        freeMeshes.push_back(mesh);
+        compactionNeeded = true;
+    }
+
+    LveGeometryPool::MeshRange LveGeometryPool::getRange(uint32_t mesh) const {
+        std::lock_guard<std::mutex> lock{ mutex };
+        return meshes[mesh].range;
+    }
+
+    VkBuffer LveGeometryPool::getBuffer(uint32_t block) const {
+        std::lock_guard<std::mutex> lock{ mutex };
+        return blocks[block]->buffer->getBuffer();
+    }
+
+    void LveGeometryPool::beginFrame() {
+        bool compaction = false;
+        {
+            std::lock_guard<std::mutex> lock{ mutex };
+            frameCount++;
+
+            // the fence of the frame that recorded the release has been waited on
+            size_t released = 0;
+            while (released < pendingFrees.size() && pendingFrees[released].frame + LveSwapChain::MAX_FRAMES_IN_FLIGHT <= frameCount) {
+                const PendingFree& pendingFree = pendingFrees[released++];
+                Block& block = *blocks[pendingFree.block];
+                freeRange(block, pendingFree.vertexOffset, pendingFree.vertexBytes);
+                if (pendingFree.indexBytes > 0) {
+                    freeRange(block, pendingFree.indexOffset, pendingFree.indexBytes);
+                }
+                block.meshCount--;
+                if (block.meshCount == 0) {
+                    blocks[pendingFree.block].reset();
+                }
+            }
+            pendingFrees.erase(pendingFrees.begin(), pendingFrees.begin() + released);
+
+            // a move takes effect between two frames, so that the draws of a frame all see the same ranges
+            LveUploadQueue& uploadQueue = lveDevice.getUploadQueue();
+            size_t keptMoves = 0;
+            for (uint32_t handle : movingMeshes) {
+                Mesh& mesh = meshes[handle];
+                if (!uploadQueue.isComplete(mesh.moveTicket)) {
+                    movingMeshes[keptMoves++] = handle;
+                    continue;
+                }
+                retirePlacement(mesh, mesh.placement);
+                mesh.placement = mesh.movePlacement;
+                mesh.moveTicket = 0;
+                updateRange(mesh);
+            }
+            movingMeshes.resize(keptMoves);
+
+            compaction = compactionNeeded;
+            compactionNeeded = false;
+        }
+        if (compaction) {
+            compact();
+        }
+    }
+
+    uint32_t LveGeometryPool::compact() {
+        std::lock_guard<std::mutex> lock{ mutex };
+        if (!movingMeshes.empty()) {
+            return 0;
+        }
+
+        // the least used block, if it is less than half full and there is somewhere else to go
+        uint32_t source = NO_BLOCK;
+        uint32_t liveBlocks = 0;
+        for (uint32_t b = 0; b < blocks.size(); b++) {
+            if (blocks[b] == nullptr) continue;
+            liveBlocks++;
+            if (source == NO_BLOCK || blocks[b]->usedBytes < blocks[source]->usedBytes) {
+                source = b;
+            }
+        }
+        if (liveBlocks < 2 || blocks[source]->usedBytes * 2 > blocks[source]->size) {
+            return 0;
+        }
+
+        LveUploadQueue& uploadQueue = lveDevice.getUploadQueue();
+        VkBuffer sourceBuffer = blocks[source]->buffer->getBuffer();
+        uint32_t movedCount = 0;
+        for (uint32_t handle = 0; handle < meshes.size(); handle++) {
+            Mesh& mesh = meshes[handle];
+            if (!mesh.live || mesh.uploadTicket == 0 || mesh.placement.block != source) continue;
+            if (!place(mesh, source, false, mesh.movePlacement)) continue;
+
+            VkBuffer targetBuffer = blocks[mesh.movePlacement.block]->buffer->getBuffer();
+            mesh.moveTicket = uploadQueue.copy(sourceBuffer, mesh.placement.vertexOffset, targetBuffer, mesh.movePlacement.vertexOffset, static_cast<VkDeviceSize>(mesh.vertexStride) * mesh.vertexCount);
+            if (mesh.indexCount > 0) {
+                mesh.moveTicket = uploadQueue.copy(sourceBuffer, mesh.placement.indexOffset, targetBuffer, mesh.movePlacement.indexOffset, static_cast<VkDeviceSize>(mesh.indexSize) * mesh.indexCount);
+            }
+            movingMeshes.push_back(handle);
+            movedCount++;
+        }
+        if (movedCount > 0) {
+            uploadQueue.submit();
+        }
+        return movedCount;
+    }
+
+    LveGeometryPoolStats LveGeometryPool::getStats() const {
+        std::lock_guard<std::mutex> lock{ mutex };
+        LveGeometryPoolStats stats{};
+        stats.meshCount = static_cast<uint32_t>(meshes.size() - freeMeshes.size());
+        for (const auto& block : blocks) {
+            if (block == nullptr) continue;
+            stats.blockCount++;
+            stats.blockBytes += block->size;
+            stats.usedBytes += block->usedBytes;
+            for (const auto& [offset, size] : block->freeRanges) {
+                stats.largestFreeRange = std::max(stats.largestFreeRange, size);
+            }
+        }
+        return stats;
+    }
+}  // namespace lve
@@ -0,0 +1,339 @@
+#include "lve_gpu_culling.hpp"
+#include "lve_frustum.hpp"
+#include "lve_swap_chain.hpp"
+
+//std
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace lve {
+    struct CullPushConstants {
+        glm::vec4 frustumPlanes[6]{};
+        uint32_t objectCount = 0;
+    };
+
+    static constexpr LveGameObject::id_t NO_ENTITY = std::numeric_limits<LveGameObject::id_t>::max();
+    static constexpr uint8_t ALL_FRAMES = (1u << LveSwapChain::MAX_FRAMES_IN_FLIGHT) - 1;
+    static_assert(LveSwapChain::MAX_FRAMES_IN_FLIGHT <= 8, "pendingFrames holds one bit per frame in flight");
+
+    LveGpuCulling::LveGpuCulling(LveDevice& device) : lveDevice{ device } {
+        createPipelineLayout();
+        computePipeline = std::make_unique<LveComputePipeline>(lveDevice, "./shaders/SPIR-V/cull.comp.spv", pipelineLayout);
+        frames.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
+    }
+
+    LveGpuCulling::~LveGpuCulling() {
+        vkDestroyPipelineLayout(lveDevice.getDevice(), pipelineLayout, nullptr);
+    }
+
+    void LveGpuCulling::createPipelineLayout() {
+        setLayout = LveDescriptorSetLayout::Builder(lveDevice)
+            .addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+            .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+            .addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+            .build();
+        descriptorPool = LveDescriptorPool::Builder(lveDevice).setMaxSets(LveSwapChain::MAX_FRAMES_IN_FLIGHT)
+            .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3 * LveSwapChain::MAX_FRAMES_IN_FLIGHT)
+            .build();
+
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(CullPushConstants);
+
+        VkDescriptorSetLayout descriptorSetLayout = setLayout->getDescriptorSetLayout();
+
+        VkPipelineLayoutCreateInfo pipelineLayoutinfo{};
+        pipelineLayoutinfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutinfo.setLayoutCount = 1;
+        pipelineLayoutinfo.pSetLayouts = &descriptorSetLayout;
+        pipelineLayoutinfo.pushConstantRangeCount = 1;
+        pipelineLayoutinfo.pPushConstantRanges = &pushConstantRange;
+        if (vkCreatePipelineLayout(lveDevice.getDevice(), &pipelineLayoutinfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create pipeline layout!");
+        }
+    }
+
+    uint32_t LveGpuCulling::getDrawIndex(const std::shared_ptr<LveModel>& model) {
+        auto [it, inserted] = drawLookup.try_emplace(model.get(), static_cast<uint32_t>(drawModels.size()));
+        if (inserted) {
+            drawModels.push_back(model);
+            drawObjectCounts.push_back(0);
+        }
+        return it->second;
+    }
+
+    void LveGpuCulling::pruneDraws() {
+        // the remaining draws keep their order, so the models of a block stay next to each other for multi draw
+        drawRemap.resize(drawModels.size());
+        uint32_t keptDraws = 0;
+        for (uint32_t i = 0; i < drawModels.size(); i++) {
+            if (drawObjectCounts[i] == 0) {
+                drawLookup.erase(drawModels[i].get());
+                continue;
+            }
+            drawRemap[i] = keptDraws;
+            drawModels[keptDraws] = std::move(drawModels[i]);
+            drawObjectCounts[keptDraws] = drawObjectCounts[i];
+            keptDraws++;
+        }
+        drawModels.resize(keptDraws);
+        drawObjectCounts.resize(keptDraws);
+        for (auto& entry : drawLookup) {
+            entry.second = drawRemap[entry.second];
+        }
+
+        for (uint32_t slot = 0; slot < objectCount; slot++) {
+            uint32_t drawIndex = drawRemap[slotObjects[slot].drawInfo.x];
+            if (drawIndex != slotObjects[slot].drawInfo.x) {
+                slotObjects[slot].drawInfo.x = drawIndex;
+                markPending(slot);
+            }
+        }
+    }
+
+    void LveGpuCulling::markPending(uint32_t slot) {
+        if (pendingFrames[slot] == 0) {
+            pendingSlots.push_back(slot);
+        }
+        pendingFrames[slot] = ALL_FRAMES;
+    }
+
+    void LveGpuCulling::invalidate() {
+        std::fill(slotEntities.begin(), slotEntities.end(), NO_ENTITY);
+    }
+
+    void LveGpuCulling::reserveFrame(int frameIndex) {
+        auto& frame = frames[frameIndex];
+        bool buffersChanged = false;
+
+        // the fence of this frame has been waited on in beginFrame, the old buffers are no longer in use
+        if (frame.objectBuffer == nullptr || frame.objectBuffer->getInstanceCount() < objectCount) {
+            uint32_t capacity = frame.objectBuffer == nullptr ? 64 : frame.objectBuffer->getInstanceCount();
+            while (capacity < objectCount) {
+                capacity *= 2;
+            }
+            frame.objectBuffer = std::make_unique<LveBuffer>(lveDevice, sizeof(GpuObjectData), capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+            frame.objectBuffer->map();
+            frame.instanceBuffer = std::make_unique<LveBuffer>(lveDevice, INSTANCE_SIZE, capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+            // the new buffer holds none of the objects
+            uint8_t frameBit = static_cast<uint8_t>(1u << frameIndex);
+            for (uint32_t slot = 0; slot < objectCount; slot++) {
+                if (pendingFrames[slot] == 0) {
+                    pendingSlots.push_back(slot);
+                }
+                pendingFrames[slot] |= frameBit;
+            }
+            buffersChanged = true;
+        }
+
+        uint32_t drawCapacityNeeded = static_cast<uint32_t>(drawModels.size());
+        if (frame.drawBuffer == nullptr || frame.drawBuffer->getInstanceCount() < drawCapacityNeeded) {
+            uint32_t capacity = frame.drawBuffer == nullptr ? 16 : frame.drawBuffer->getInstanceCount();
+            while (capacity < drawCapacityNeeded) {
+                capacity *= 2;
+            }
+            frame.drawBuffer = std::make_unique<LveBuffer>(lveDevice, sizeof(GpuDrawCommand), capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+            frame.drawBuffer->map();
+            frame.drawCount = 0;
+            buffersChanged = true;
+        }
+
+        if (buffersChanged) {
+            auto objectInfo = frame.objectBuffer->descriptorInfo();
+            auto drawInfo = frame.drawBuffer->descriptorInfo();
+            auto instanceInfo = frame.instanceBuffer->descriptorInfo();
+            LveDescriptorWriter writer{ *setLayout, *descriptorPool };
+            writer.writeBuffer(0, &objectInfo)
+                .writeBuffer(1, &drawInfo)
+                .writeBuffer(2, &instanceInfo);
+            if (frame.descriptorSet == VK_NULL_HANDLE) {
+                if (!writer.build(frame.descriptorSet)) {
+                    throw std::runtime_error("failed to allocate culling descriptor set!");
+                }
+            } else {
+                writer.overwrite(frame.descriptorSet);
+            }
+        }
+    }
+
+    void LveGpuCulling::cull(FrameInfo& frameInfo, bool frustumCulling) {
+        auto& frame = frames[frameInfo.frameIndex];
+
+        // the draws of this frame were last filled MAX_FRAMES_IN_FLIGHT frames ago and their fence has been waited on
+        if (frame.drawCount > 0) {
+            frame.drawBuffer->invalidate();
+            auto draws = static_cast<const GpuDrawCommand*>(frame.drawBuffer->getMappedMemory());
+            visibleCount = 0;
+            for (uint32_t i = 0; i < frame.drawCount; i++) {
+                visibleCount += draws[i].command.instanceCount;
+            }
+        }
+
+        // compare every object with its slot, only the moved or replaced objects are written again
+        transformBatch.clear();
+        dirtyTransforms.clear();
+        changedSlots.clear();
+        changedTransforms.clear();
+        std::fill(drawObjectCounts.begin(), drawObjectCounts.end(), 0);
+        uint32_t slot = 0;
+        frameInfo.registry.each<ModelComponent, TransformComponent>([&](LveGameObject::id_t id, ModelComponent& model, TransformComponent& transform) {
+            if (model.model == nullptr || model.model->getIndexCount() == 0) return;
+
+            if (slot == slotEntities.size()) {
+                slotEntities.push_back(NO_ENTITY);
+                slotModels.push_back(nullptr);
+                slotObjects.emplace_back();
+                pendingFrames.push_back(0);
+            }
+            if (transform.isDirty()) {
+                transformBatch.add(transform.getInterpolatedTranslation(), transform.getInterpolatedRotation(), transform.getInterpolatedScale());
+                dirtyTransforms.push_back(&transform);
+            }
+            if (transform.isDirty() || slotEntities[slot] != id || slotModels[slot] != model.model.get()) {
+                if (slotModels[slot] != model.model.get()) {
+                    const AABB& box = model.model->getBoundingBox();
+                    slotObjects[slot].boundsMin = { box.minX, box.minY, box.minZ, 1.f };
+                    slotObjects[slot].boundsMax = { box.maxX, box.maxY, box.maxZ, 1.f };
+                    slotObjects[slot].drawInfo.x = getDrawIndex(model.model);
+                }
+                slotEntities[slot] = id;
+                slotModels[slot] = model.model.get();
+                changedSlots.push_back(slot);
+                changedTransforms.push_back(&transform);
+            }
+            drawObjectCounts[slotObjects[slot].drawInfo.x]++;
+            slot++;
+        });
+        objectCount = slot;
+        if (slotEntities.size() > objectCount) {
+            slotEntities.resize(objectCount);
+            slotModels.resize(objectCount);
+            slotObjects.resize(objectCount);
+            pendingFrames.resize(objectCount);
+        }
+
+        // every slot now counts in its draw, a draw left without objects holds a model the scene may have released
+        if (std::find(drawObjectCounts.begin(), drawObjectCounts.end(), 0u) != drawObjectCounts.end()) {
+            pruneDraws();
+        }
+
+        if (!dirtyTransforms.empty()) {
+            batchModelMatrices.resize(dirtyTransforms.size());
+            batchNormalMatrices.resize(dirtyTransforms.size());
+            transformBatch.computeMatrices(batchModelMatrices.data(), batchNormalMatrices.data());
+            for (size_t i = 0; i < dirtyTransforms.size(); i++) {
+                dirtyTransforms[i]->setCachedMatrices(batchModelMatrices[i], batchNormalMatrices[i]);
+            }
+        }
+        for (size_t i = 0; i < changedSlots.size(); i++) {
+            auto& object = slotObjects[changedSlots[i]];
+            object.modelMatrix = changedTransforms[i]->mat4();
+            object.normalMatrix = glm::mat4(changedTransforms[i]->normalMatrix());
+            markPending(changedSlots[i]);
+        }
+
+        reserveFrame(frameInfo.frameIndex);
+
+        // copy the slots this frame does not have yet, the other frames get them when their turn comes
+        uint8_t frameBit = static_cast<uint8_t>(1u << frameInfo.frameIndex);
+        auto objects = static_cast<GpuObjectData*>(frame.objectBuffer->getMappedMemory());
+        size_t keptSlots = 0;
+        for (uint32_t pendingSlot : pendingSlots) {
+            if (pendingSlot >= objectCount) continue;
+
+            if (pendingFrames[pendingSlot] & frameBit) {
+                objects[pendingSlot] = slotObjects[pendingSlot];
+                pendingFrames[pendingSlot] &= ~frameBit;
+            }
+            if (pendingFrames[pendingSlot] != 0) {
+                pendingSlots[keptSlots++] = pendingSlot;
+            }
+        }
+        pendingSlots.resize(keptSlots);
+        frame.objectBuffer->flush();
+
+        // one draw per model, the shader counts the instances from zero in the range reserved for the model
+        auto draws = static_cast<GpuDrawCommand*>(frame.drawBuffer->getMappedMemory());
+        uint32_t instanceBase = 0;
+        for (uint32_t i = 0; i < drawModels.size(); i++) {
+            // a model still uploading draws nothing
+            uint32_t indexCount = drawModels[i]->isReady() ? drawModels[i]->getIndexCount() : 0;
+            LveGeometryPool::MeshRange range{};
+            if (indexCount > 0) {
+                range = drawModels[i]->getGeometryRange();
+            }
+            draws[i].command = { indexCount, 0, range.firstIndex, range.vertexOffset, instanceBase };
+            draws[i].instanceBase = instanceBase;
+            instanceBase += drawObjectCounts[i];
+        }
+        frame.drawCount = static_cast<uint32_t>(drawModels.size());
+        frame.drawBuffer->flush();
+
+        if (objectCount == 0) {
+            return;
+        }
+
+        computePipeline->bind(frameInfo.commandBuffer);
+        vkCmdBindDescriptorSets(frameInfo.commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &frame.descriptorSet, 0, nullptr);
+
+        CullPushConstants push{};
+        LveFrustum frustum{};
+        if (frustumCulling) {
+            frustum = LveFrustum{ frameInfo.camera.getProjection() * frameInfo.camera.getView() };
+        }
+        std::copy(frustum.getPlanes().begin(), frustum.getPlanes().end(), push.frustumPlanes);
+        push.objectCount = objectCount;
+        vkCmdPushConstants(frameInfo.commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPushConstants), &push);
+        vkCmdDispatch(frameInfo.commandBuffer, (objectCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+        // the draws read the counts and the instances written by the shader, the CPU reads the counts back after the fence
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(frameInfo.commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    void LveGpuCulling::draw(FrameInfo& frameInfo, const std::function<bool(LveModel&)>& bindModel) {
+        auto& frame = frames[frameInfo.frameIndex];
+        drawCount = 0;
+        if (objectCount == 0) {
+            return;
+        }
+
+        VkBuffer buffers[] = { frame.instanceBuffer->getBuffer() };
+        VkDeviceSize offsets[] = { 0 };
+        vkCmdBindVertexBuffers(frameInfo.commandBuffer, 1, 1, buffers, offsets);
+
+        bool multiDraw = lveDevice.supportsMultiDrawIndirect();
+        uint32_t maxDrawCount = lveDevice.properties.limits.maxDrawIndirectCount;
+        for (uint32_t i = 0; i < frame.drawCount; i++) {
+            LveModel& model = *drawModels[i];
+            if (!bindModel(model)) continue;
+
+            if (!multiDraw || model.getVertexFormat() != LveModel::VertexFormat::Float) {
+                // a compact model pushes its own position decoding
+                model.drawIndirect(frameInfo.commandBuffer, frame.drawBuffer->getBuffer(), i * sizeof(GpuDrawCommand));
+                drawCount++;
+                continue;
+            }
+
+            // the next models in the same block read the buffers just bound, one call draws them all
+            uint32_t block = model.getGeometryRange().block;
+            uint32_t last = i;
+            for (uint32_t next = i + 1; next < frame.drawCount && next - i < maxDrawCount; next++) {
+                LveModel& nextModel = *drawModels[next];
+                if (nextModel.getVertexFormat() != LveModel::VertexFormat::Float || nextModel.getIndexType() != model.getIndexType() || nextModel.getGeometryRange().block != block) {
+                    break;
+                }
+                last = next;
+            }
+            vkCmdDrawIndexedIndirect(frameInfo.commandBuffer, frame.drawBuffer->getBuffer(), i * sizeof(GpuDrawCommand), last - i + 1, sizeof(GpuDrawCommand));
+            drawCount++;
+            i = last;
+        }
+    }
+}  // namespace lve
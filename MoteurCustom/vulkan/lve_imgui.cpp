@@ -20,8 +20,16 @@ namespace lve {
     glm::vec3 position(0.0f, 1.5f, 0.0f);
     glm::vec3 rotation(0.0f, 0.0f, 0.0f);
     glm::vec3 scale(0.5f, 0.5f, 0.5f);
+    static unsigned int inspectedId = 5;
+    static uint32_t visibleObjects = 0, totalObjects = 0, drawCalls = 0;
+    static bool gpuCulling = false;
     
     LveImgui::LveImgui(LveWindow& window, LveDevice& device, LveRenderer& renderer) : lveWindow{ window }, lveDevice{ device }, lveRenderer{ renderer } {
+        if (lveWindow.isHeadless()) {
+            // no window to draw the UI into nor inputs to read
+            return;
+        }
+
         VkDescriptorPoolSize pool_sizes[] = {
             { VK_DESCRIPTOR_TYPE_SAMPLER, 1000 },
             { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1000 },
@@ -52,6 +60,9 @@ namespace lve {
     }
     
     LveImgui::~LveImgui() {
+        if (lveWindow.isHeadless()) {
+            return;
+        }
         ImGui_ImplVulkan_Shutdown();
         ImGui_ImplGlfw_Shutdown();
         ImGui::DestroyContext();
@@ -59,6 +70,10 @@ namespace lve {
     }
     
     void LveImgui::renderImGui(VkCommandBuffer commandBuffer) {
+        if (lveWindow.isHeadless()) {
+            return;
+        }
+
         ImGui_ImplGlfw_NewFrame();
         ImGui_ImplVulkan_NewFrame();
         ImGui::NewFrame();
@@ -82,6 +97,34 @@ namespace lve {
     float LveImgui::getPositionSliderValue(int xyz) {
         return position[xyz];
     }
+
+    void LveImgui::setInspectedObject(unsigned int id, const glm::vec3& objectPosition, const glm::vec3& objectRotation, const glm::vec3& objectScale) {
+        inspectedId = id;
+        position = objectPosition;
+        rotation = objectRotation;
+        scale = objectScale;
+    }
+
+    void LveImgui::setRenderStats(uint32_t visibleCount, uint32_t objectCount, uint32_t drawCount) {
+        visibleObjects = visibleCount;
+        totalObjects = objectCount;
+        drawCalls = drawCount;
+    }
+
+    void LveImgui::setGpuCulling(bool enabled) {
+        gpuCulling = enabled;
+    }
+
+    bool LveImgui::isGpuCullingEnabled() const {
+        return gpuCulling;
+    }
+
+    bool LveImgui::wantsMouse() const {
+        if (lveWindow.isHeadless()) {
+            return false;
+        }
+        return ImGui::GetIO().WantCaptureMouse;
+    }
     
     void LveImgui::initImGui() {
         // Setup Dear ImGui context
@@ -107,7 +150,7 @@ namespace lve {
         init_info.Device = lveDevice.getDevice();
         init_info.QueueFamily = lveDevice.getGraphicsQueueFamily();
         init_info.Queue = lveDevice.getGraphicsQueue();
-        init_info.PipelineCache = VK_NULL_HANDLE;
+        init_info.PipelineCache = lveDevice.getPipelineCache();
         init_info.DescriptorPool = imguiPool;
         init_info.Allocator = nullptr;
         init_info.MinImageCount = LveSwapChain::MAX_FRAMES_IN_FLIGHT;
@@ -119,7 +162,8 @@ namespace lve {
         };
         ImGui_ImplVulkan_Init(&init_info, lveRenderer.getSwapChainRenderPass());
 
-        //Upload Fonts
+        //Upload Fonts (submits to the graphics queue and waits for the device)
+        auto queueLocks = lveDevice.lockQueues();
         ImGui_ImplVulkan_CreateFontsTexture();
     }
     
@@ -148,6 +192,7 @@ namespace lve {
         myCube = GameObject();
         float maxScaleValue = 10.0f;
 
+        ImGui::Text("Objet %u (clic gauche pour en choisir un autre)", inspectedId);
         ImGui::InputScalarN("Translation", ImGuiDataType_Float, glm::value_ptr(position), 3, NULL, NULL, "%.3f");
 
 
@@ -164,6 +209,8 @@ namespace lve {
 
         //compteur fps
         ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+        ImGui::Text("Objets visibles : %u / %u (%u draw calls)", visibleObjects, totalObjects, drawCalls);
+        ImGui::Checkbox("Culling GPU (compute + draws indirects)", &gpuCulling);
 
 
         ImGui::End();
@@ -0,0 +1,82 @@
+#include "lve_light_clusters.hpp"
+#include "lve_swap_chain.hpp"
+
+namespace lve {
+    LveLightClusters::LveLightClusters(LveDevice& device, LveDescriptorSetLayout& globalSetLayout, LveDescriptorPool& globalPool)
+        : lveDevice{ device }, globalSetLayout{ globalSetLayout }, globalPool{ globalPool } {
+        frames.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
+    }
+
+    void LveLightClusters::reserveFrame(FrameInfo& frameInfo, uint32_t lightCount, uint32_t indexCount) {
+        auto& frame = frames[frameInfo.frameIndex];
+        bool buffersChanged = frame.descriptorSet != frameInfo.globalDescriptorSet;
+
+        // the fence of this frame has been waited on in beginFrame, the old buffers are no longer in use
+        if (frame.lightBuffer == nullptr || frame.lightBuffer->getInstanceCount() < lightCount) {
+            uint32_t capacity = frame.lightBuffer == nullptr ? 64 : frame.lightBuffer->getInstanceCount();
+            while (capacity < lightCount) {
+                capacity *= 2;
+            }
+            frame.lightBuffer = std::make_unique<LveBuffer>(lveDevice, sizeof(PointLight), capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+            frame.lightBuffer->map();
+            buffersChanged = true;
+        }
+        if (frame.clusterBuffer == nullptr) {
+            frame.clusterBuffer = std::make_unique<LveBuffer>(lveDevice, sizeof(glm::uvec2), LveClusterGrid::CLUSTER_COUNT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+            frame.clusterBuffer->map();
+            buffersChanged = true;
+        }
+        if (frame.indexBuffer == nullptr || frame.indexBuffer->getInstanceCount() < indexCount) {
+            uint32_t capacity = frame.indexBuffer == nullptr ? 256 : frame.indexBuffer->getInstanceCount();
+            while (capacity < indexCount) {
+                capacity *= 2;
+            }
+            frame.indexBuffer = std::make_unique<LveBuffer>(lveDevice, sizeof(uint32_t), capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+            frame.indexBuffer->map();
+            buffersChanged = true;
+        }
+
+        if (buffersChanged) {
+            auto lightInfo = frame.lightBuffer->descriptorInfo();
+            auto clusterInfo = frame.clusterBuffer->descriptorInfo();
+            auto indexInfo = frame.indexBuffer->descriptorInfo();
+            LveDescriptorWriter(globalSetLayout, globalPool)
+                .writeBuffer(LIGHT_BINDING, &lightInfo)
+                .writeBuffer(CLUSTER_BINDING, &clusterInfo)
+                .writeBuffer(INDEX_BINDING, &indexInfo)
+                .overwrite(frameInfo.globalDescriptorSet);
+            frame.descriptorSet = frameInfo.globalDescriptorSet;
+        }
+    }
+
+    void LveLightClusters::update(FrameInfo& frameInfo, GlobalUbo& ubo, const std::vector<PointLight>& lights, VkExtent2D extent) {
+        clusterGrid.build(ubo.view, ubo.projection, lights);
+        const auto& clusters = clusterGrid.getClusters();
+        const auto& lightIndices = clusterGrid.getLightIndices();
+
+        uint32_t lightCount = static_cast<uint32_t>(lights.size());
+        uint32_t indexCount = static_cast<uint32_t>(lightIndices.size());
+        reserveFrame(frameInfo, lightCount, indexCount);
+
+        auto& frame = frames[frameInfo.frameIndex];
+        if (lightCount > 0) {
+            frame.lightBuffer->writeToBuffer((void*)lights.data(), lightCount * sizeof(PointLight));
+            frame.lightBuffer->flush();
+        }
+        frame.clusterBuffer->writeToBuffer((void*)clusters.data(), clusters.size() * sizeof(glm::uvec2));
+        frame.clusterBuffer->flush();
+        if (indexCount > 0) {
+            frame.indexBuffer->writeToBuffer((void*)lightIndices.data(), indexCount * sizeof(uint32_t));
+            frame.indexBuffer->flush();
+        }
+
+        glm::vec2 sliceScaleBias = clusterGrid.getSliceScaleBias();
+        ubo.clusterParams = {
+            static_cast<float>(extent.width) / LveClusterGrid::TILES_X,
+            static_cast<float>(extent.height) / LveClusterGrid::TILES_Y,
+            sliceScaleBias.x,
+            sliceScaleBias.y };
+        ubo.clusterGrid = { LveClusterGrid::TILES_X, LveClusterGrid::TILES_Y, LveClusterGrid::SLICES, 0 };
+        ubo.numLights = static_cast<int>(lightCount);
+    }
+}  // namespace lve
@@ -0,0 +1,257 @@
+#include "lve_memory_allocator.hpp"
+
+//std
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+namespace lve {
+    namespace {
+        /**
+         * @brief Rounds a value up to a multiple of an alignment.
+         * @param value : The value.
+         * @param alignment : The alignment (not zero).
+         * @return The aligned value.
+        */
+        VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+    }
+
+    LveMemoryAllocator::LveMemoryAllocator(VkDevice device, VkPhysicalDevice physicalDevice) : device{ device } {
+        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        nonCoherentAtomSize = std::max<VkDeviceSize>(properties.limits.nonCoherentAtomSize, 1);
+
+        pools.resize(2 * memoryProperties.memoryTypeCount);
+        for (uint32_t i = 0; i < pools.size(); i++) {
+            Pool& pool = pools[i];
+            pool.memoryType = i / 2;
+            const VkMemoryType& memoryType = memoryProperties.memoryTypes[pool.memoryType];
+            // small heaps (like the host visible part of the VRAM) get smaller blocks
+            pool.blockSize = std::min(DEFAULT_BLOCK_SIZE, memoryProperties.memoryHeaps[memoryType.heapIndex].size / 8);
+            pool.hostVisible = (memoryType.propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+            pool.coherent = (memoryType.propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+            // a flushed or invalidated range never touches the neighbouring allocations
+            pool.granularity = pool.hostVisible && !pool.coherent ? nonCoherentAtomSize : 1;
+        }
+    }
+
+    LveMemoryAllocator::~LveMemoryAllocator() {
+        for (auto& pool : pools) {
+            for (uint32_t i = 0; i < pool.blocks.size(); i++) {
+                if (pool.blocks[i] != nullptr) {
+                    destroyBlock(pool, i);
+                }
+            }
+        }
+    }
+
+    uint32_t LveMemoryAllocator::createBlock(Pool& pool, VkDeviceSize size, bool dedicated) {
+        auto block = std::make_unique<Block>();
+        block->size = size;
+        block->dedicated = dedicated;
+        block->freeRanges[0] = size;
+
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = size;
+        allocInfo.memoryTypeIndex = pool.memoryType;
+        if (vkAllocateMemory(device, &allocInfo, nullptr, &block->memory) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate device memory block!");
+        }
+        if (pool.hostVisible && vkMapMemory(device, block->memory, 0, VK_WHOLE_SIZE, 0, &block->mapped) != VK_SUCCESS) {
+            vkFreeMemory(device, block->memory, nullptr);
+            throw std::runtime_error("failed to map device memory block!");
+        }
+
+        // reuse the index of a released block
+        auto freeSlot = std::find(pool.blocks.begin(), pool.blocks.end(), nullptr);
+        if (freeSlot != pool.blocks.end()) {
+            *freeSlot = std::move(block);
+            return static_cast<uint32_t>(std::distance(pool.blocks.begin(), freeSlot));
+        }
+        pool.blocks.push_back(std::move(block));
+        return static_cast<uint32_t>(pool.blocks.size() - 1);
+    }
+
+    void LveMemoryAllocator::destroyBlock(Pool& pool, uint32_t blockIndex) {
+        auto& block = pool.blocks[blockIndex];
+        if (block->mapped != nullptr) {
+            vkUnmapMemory(device, block->memory);
+        }
+        vkFreeMemory(device, block->memory, nullptr);
+        block.reset();
+    }
+
+    bool LveMemoryAllocator::allocateFromBlock(Block& block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset) {
+        auto best = block.freeRanges.end();
+        VkDeviceSize bestSize = 0;
+        for (auto it = block.freeRanges.begin(); it != block.freeRanges.end(); ++it) {
+            VkDeviceSize alignedOffset = alignUp(it->first, alignment);
+            if (alignedOffset + size > it->first + it->second) {
+                continue;
+            }
+            if (best == block.freeRanges.end() || it->second < bestSize) {
+                best = it;
+                bestSize = it->second;
+                if (alignedOffset + size == it->first + it->second) {
+                    break;
+                }
+            }
+        }
+        if (best == block.freeRanges.end()) {
+            return false;
+        }
+
+        VkDeviceSize rangeOffset = best->first;
+        VkDeviceSize rangeEnd = best->first + best->second;
+        offset = alignUp(rangeOffset, alignment);
+        block.freeRanges.erase(best);
+        // the alignment padding and the end of the range stay free
+        if (offset > rangeOffset) {
+            block.freeRanges[rangeOffset] = offset - rangeOffset;
+        }
+        if (offset + size < rangeEnd) {
+            block.freeRanges[offset + size] = rangeEnd - (offset + size);
+        }
+        return true;
+    }
+
+    LveAllocation LveMemoryAllocator::allocate(const VkMemoryRequirements& requirements, uint32_t memoryType, bool optimalImage) {
+        std::lock_guard<std::mutex> lock{ mutex };
+        LveAllocation allocation{};
+        allocation.pool = 2 * memoryType + (optimalImage ? 1 : 0);
+        Pool& pool = pools[allocation.pool];
+
+        VkDeviceSize size = alignUp(requirements.size, pool.granularity);
+        VkDeviceSize alignment = std::max(requirements.alignment, pool.granularity);
+        bool found = false;
+        if (size > pool.blockSize / 2) {
+            // large resources get their own block instead of wasting the end of a shared one
+            allocation.block = createBlock(pool, size, true);
+        } else {
+            for (uint32_t i = 0; i < pool.blocks.size() && !found; i++) {
+                if (pool.blocks[i] != nullptr && !pool.blocks[i]->dedicated && allocateFromBlock(*pool.blocks[i], size, alignment, allocation.offset)) {
+                    allocation.block = i;
+                    found = true;
+                }
+            }
+            if (!found) {
+                allocation.block = createBlock(pool, pool.blockSize, false);
+            }
+        }
+        Block& block = *pool.blocks[allocation.block];
+        if (!found && !allocateFromBlock(block, size, alignment, allocation.offset)) {
+            throw std::runtime_error("failed to sub-allocate device memory!");
+        }
+
+        block.allocationCount++;
+        block.usedBytes += size;
+        allocation.memory = block.memory;
+        allocation.size = size;
+        allocation.mapped = block.mapped != nullptr ? static_cast<char*>(block.mapped) + allocation.offset : nullptr;
+        return allocation;
+    }
+
+    void LveMemoryAllocator::free(LveAllocation& allocation) {
+        if (allocation.memory == VK_NULL_HANDLE) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock{ mutex };
+        Pool& pool = pools[allocation.pool];
+        Block& block = *pool.blocks[allocation.block];
+
+        // merge the range with the free neighbours
+        VkDeviceSize rangeOffset = allocation.offset;
+        VkDeviceSize rangeEnd = allocation.offset + allocation.size;
+        auto next = block.freeRanges.lower_bound(rangeOffset);
+        if (next != block.freeRanges.end() && next->first == rangeEnd) {
+            rangeEnd += next->second;
+            next = block.freeRanges.erase(next);
+        }
+        if (next != block.freeRanges.begin()) {
+            auto previous = std::prev(next);
+            if (previous->first + previous->second == rangeOffset) {
+                rangeOffset = previous->first;
+                block.freeRanges.erase(previous);
+            }
+        }
+        block.freeRanges[rangeOffset] = rangeEnd - rangeOffset;
+        block.allocationCount--;
+        block.usedBytes -= allocation.size;
+
+        // keep one empty block per pool, so that a resource recreated every frame does not allocate a block each time
+        if (block.allocationCount == 0) {
+            bool release = block.dedicated;
+            for (uint32_t i = 0; i < pool.blocks.size() && !release; i++) {
+                release = i != allocation.block && pool.blocks[i] != nullptr && !pool.blocks[i]->dedicated && pool.blocks[i]->allocationCount == 0;
+            }
+            if (release) {
+                destroyBlock(pool, allocation.block);
+            }
+        }
+        allocation = LveAllocation{};
+    }
+
+    VkMappedMemoryRange LveMemoryAllocator::getMappedRange(const LveAllocation& allocation, VkDeviceSize size, VkDeviceSize offset) const {
+        VkDeviceSize allocationEnd = allocation.offset + allocation.size;
+        VkDeviceSize rangeOffset = allocation.offset + offset;
+        VkDeviceSize rangeEnd = size == VK_WHOLE_SIZE ? allocationEnd : rangeOffset + size;
+        rangeOffset = rangeOffset / nonCoherentAtomSize * nonCoherentAtomSize;
+        rangeEnd = std::min(alignUp(rangeEnd, nonCoherentAtomSize), allocationEnd);
+
+        VkMappedMemoryRange mappedRange = {};
+        mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+        mappedRange.memory = allocation.memory;
+        mappedRange.offset = rangeOffset;
+        mappedRange.size = rangeEnd - rangeOffset;
+        return mappedRange;
+    }
+
+    VkResult LveMemoryAllocator::flush(const LveAllocation& allocation, VkDeviceSize size, VkDeviceSize offset) {
+        if (pools[allocation.pool].coherent) {
+            return VK_SUCCESS;
+        }
+        VkMappedMemoryRange mappedRange = getMappedRange(allocation, size, offset);
+        return vkFlushMappedMemoryRanges(device, 1, &mappedRange);
+    }
+
+    VkResult LveMemoryAllocator::invalidate(const LveAllocation& allocation, VkDeviceSize size, VkDeviceSize offset) {
+        if (pools[allocation.pool].coherent) {
+            return VK_SUCCESS;
+        }
+        VkMappedMemoryRange mappedRange = getMappedRange(allocation, size, offset);
+        return vkInvalidateMappedMemoryRanges(device, 1, &mappedRange);
+    }
+
+    std::vector<LveMemoryHeapStats> LveMemoryAllocator::getHeapStats() const {
+        std::lock_guard<std::mutex> lock{ mutex };
+        std::vector<LveMemoryHeapStats> heapStats(memoryProperties.memoryHeapCount);
+        std::vector<VkDeviceSize> freeBytes(memoryProperties.memoryHeapCount, 0);
+        for (const auto& pool : pools) {
+            uint32_t heap = memoryProperties.memoryTypes[pool.memoryType].heapIndex;
+            auto& stats = heapStats[heap];
+            for (const auto& block : pool.blocks) {
+                if (block == nullptr) {
+                    continue;
+                }
+                stats.blockCount++;
+                stats.allocationCount += block->allocationCount;
+                stats.blockBytes += block->size;
+                stats.usedBytes += block->usedBytes;
+                for (const auto& [rangeOffset, rangeSize] : block->freeRanges) {
+                    freeBytes[heap] += rangeSize;
+                    stats.largestFreeRange = std::max(stats.largestFreeRange, rangeSize);
+                }
+            }
+        }
+        for (uint32_t heap = 0; heap < heapStats.size(); heap++) {
+            if (freeBytes[heap] > 0) {
+                heapStats[heap].fragmentation = 1.f - static_cast<float>(heapStats[heap].largestFreeRange) / static_cast<float>(freeBytes[heap]);
+            }
+        }
+        return heapStats;
+    }
+}  // namespace lve
@@ -0,0 +1,186 @@
+#include "lve_mesh_cache.hpp"
+
+//std
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace lve {
+    static_assert(sizeof(LveMeshCache::Header) % alignof(LveModel::Vertex) == 0, "The vertices follow the header without padding");
+
+    LveMeshCache::~LveMeshCache() {
+        close();
+    }
+
+    std::string LveMeshCache::getCachePath(const std::string& sourcePath) {
+        return sourcePath + ".meshcache";
+    }
+
+    uint64_t LveMeshCache::computeChecksum(const std::string& filePath, uint64_t& fileSize) {
+        std::ifstream file{ filePath, std::ios::binary };
+        if (!file.is_open()) {
+            return 0;
+        }
+
+        // FNV-1a on 8 bytes words, with a shift so that the high bits reach the low ones
+        uint64_t hash = 0xcbf29ce484222325ull;
+        fileSize = 0;
+        std::vector<char> chunk(1 << 20);
+        while (file) {
+            file.read(chunk.data(), chunk.size());
+            size_t readSize = static_cast<size_t>(file.gcount());
+            // the tail of the last chunk is padded with zeros, the size is hashed at the end
+            std::memset(chunk.data() + readSize, 0, (8 - readSize % 8) % 8);
+            for (size_t i = 0; i < readSize; i += 8) {
+                uint64_t word;
+                std::memcpy(&word, chunk.data() + i, sizeof(word));
+                hash = (hash ^ word) * 0x100000001b3ull;
+                hash ^= hash >> 29;
+            }
+            fileSize += readSize;
+        }
+        hash = (hash ^ fileSize) * 0x100000001b3ull;
+        return hash != 0 ? hash : 1;
+    }
+
+    bool LveMeshCache::write(const std::string& cachePath, uint64_t sourceSize, uint64_t sourceChecksum, uint32_t flags, const LveModel::Builder& builder) {
+        Header header{};
+        header.flags = flags;
+        header.vertexCount = static_cast<uint32_t>(builder.vertices.size());
+        header.indexCount = static_cast<uint32_t>(builder.indices.size());
+        header.meshletCount = static_cast<uint32_t>(builder.meshlets.size());
+        header.lodCount = static_cast<uint32_t>(builder.lods.size());
+        header.sourceSize = sourceSize;
+        header.sourceChecksum = sourceChecksum;
+
+        std::string temporaryPath = cachePath + ".tmp";
+        {
+            std::ofstream file{ temporaryPath, std::ios::binary | std::ios::trunc };
+            if (!file.is_open()) {
+                return false;
+            }
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(builder.vertices.data()), builder.vertices.size() * sizeof(LveModel::Vertex));
+            file.write(reinterpret_cast<const char*>(builder.indices.data()), builder.indices.size() * sizeof(uint32_t));
+            file.write(reinterpret_cast<const char*>(builder.meshlets.data()), builder.meshlets.size() * sizeof(LveModel::Meshlet));
+            file.write(reinterpret_cast<const char*>(builder.lods.data()), builder.lods.size() * sizeof(LveModel::Lod));
+            if (!file.good()) {
+                file.close();
+                std::filesystem::remove(temporaryPath);
+                return false;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporaryPath, cachePath, error);
+        if (error) {
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+        return true;
+    }
+
+    bool LveMeshCache::open(const std::string& cachePath, uint64_t sourceSize, uint64_t sourceChecksum, uint32_t flags) {
+        close();
+
+#ifdef _WIN32
+        HANDLE file = CreateFileA(cachePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER fileSize{};
+        HANDLE mapping = nullptr;
+        if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        }
+        if (mapping != nullptr) {
+            mappedData = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            mappedSize = static_cast<size_t>(fileSize.QuadPart);
+            // the view keeps the mapping alive
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+#else
+        int file = ::open(cachePath.c_str(), O_RDONLY);
+        if (file < 0) {
+            return false;
+        }
+        struct stat fileStat{};
+        if (fstat(file, &fileStat) == 0 && fileStat.st_size > 0) {
+            void* data = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+            if (data != MAP_FAILED) {
+                mappedData = data;
+                mappedSize = static_cast<size_t>(fileStat.st_size);
+            }
+        }
+        ::close(file);
+#endif
+        if (mappedData == nullptr) {
+            mappedSize = 0;
+            return false;
+        }
+
+        Header header{};
+        if (mappedSize >= sizeof(Header)) {
+            std::memcpy(&header, mappedData, sizeof(Header));
+        }
+        uint64_t expectedSize = sizeof(Header) + static_cast<uint64_t>(header.vertexCount) * sizeof(LveModel::Vertex) + static_cast<uint64_t>(header.indexCount) * sizeof(uint32_t)
+            + static_cast<uint64_t>(header.meshletCount) * sizeof(LveModel::Meshlet)
+            + static_cast<uint64_t>(header.lodCount) * sizeof(LveModel::Lod);
+        bool valid = mappedSize >= sizeof(Header)
+            && header.magic == MAGIC
+            && header.version == VERSION
+            && header.vertexSize == sizeof(LveModel::Vertex)
+            && header.sourceSize == sourceSize
+            && header.sourceChecksum == sourceChecksum
+            && header.flags == flags
+            && expectedSize == mappedSize;
+        if (!valid) {
+            close();
+            return false;
+        }
+
+        const char* data = static_cast<const char*>(mappedData);
+        vertexCount = header.vertexCount;
+        indexCount = header.indexCount;
+        vertices = reinterpret_cast<const LveModel::Vertex*>(data + sizeof(Header));
+        indices = reinterpret_cast<const uint32_t*>(data + sizeof(Header) + vertexCount * sizeof(LveModel::Vertex));
+        meshletCount = header.meshletCount;
+        meshlets = reinterpret_cast<const LveModel::Meshlet*>(indices + indexCount);
+        lodCount = header.lodCount;
+        lods = reinterpret_cast<const LveModel::Lod*>(meshlets + meshletCount);
+        return true;
+    }
+
+    void LveMeshCache::close() {
+        if (mappedData != nullptr) {
+#ifdef _WIN32
+            UnmapViewOfFile(mappedData);
+#else
+            munmap(const_cast<void*>(mappedData), mappedSize);
+#endif
+        }
+        mappedData = nullptr;
+        mappedSize = 0;
+        vertices = nullptr;
+        vertexCount = 0;
+        indices = nullptr;
+        indexCount = 0;
+        meshlets = nullptr;
+        meshletCount = 0;
+        lods = nullptr;
+        lodCount = 0;
+    }
+}  // namespace lve
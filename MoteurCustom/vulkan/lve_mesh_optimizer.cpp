@@ -0,0 +1,293 @@
+#include "lve_mesh_optimizer.hpp"
+
+//std
+#include <algorithm>
+#include <cmath>
+
+namespace lve {
+    namespace {
+        constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+        constexpr uint32_t FORSYTH_CACHE_SIZE = 16; /** @brief Cache size of the ordering scores (16 keeps the ordering fast with a result close to 32). */
+        constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+        constexpr float CACHE_DECAY_POWER = 1.5f;
+        constexpr float VALENCE_BOOST_SCALE = 2.f;
+        constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+        /**
+         * @brief Simulates a FIFO post-transform cache, a vertex is in the cache while less than cacheSize misses happened since its own miss.
+        */
+        class FifoCache {
+        public:
+            FifoCache(uint32_t vertexCount, uint32_t cacheSize) : timestamps(vertexCount, 0), cacheSize{ cacheSize }, timestamp{ cacheSize + 1 } {}
+
+            /**
+             * @brief Fetches a vertex.
+             * @param vertex : The vertex.
+             * @return True if the vertex was not in the cache.
+            */
+            bool fetch(uint32_t vertex) {
+                if (timestamp - timestamps[vertex] > cacheSize) {
+                    timestamps[vertex] = timestamp++;
+                    return true;
+                }
+                return false;
+            }
+
+        private:
+            std::vector<uint32_t> timestamps; /** @brief Value of timestamp when each vertex last entered the cache. */
+            uint32_t cacheSize; /** @brief Number of entries of the cache. */
+            uint32_t timestamp; /** @brief Number of misses so far, plus cacheSize + 1. */
+        };
+
+        /**
+         * @brief Forsyth's score of a vertex : high when the vertex is recent in the cache or has few triangles left.
+         * @param cachePosition : The position of the vertex in the cache (-1 if it is not in the cache).
+         * @param remainingTriangles : The number of triangles of the vertex not emitted yet.
+         * @return The score (-1 when the vertex has no triangle left).
+        */
+        float computeVertexScore(int cachePosition, uint32_t remainingTriangles) {
+            if (remainingTriangles == 0) {
+                return -1.f;
+            }
+            float score = 0.f;
+            if (cachePosition >= 0) {
+                if (cachePosition < 3) {
+                    // the vertices of the last triangle get a fixed score, so that the next triangle does not simply reuse its edge
+                    score = LAST_TRIANGLE_SCORE;
+                } else {
+                    float scale = 1.f - static_cast<float>(cachePosition - 3) / static_cast<float>(FORSYTH_CACHE_SIZE - 3);
+                    score = std::pow(scale, CACHE_DECAY_POWER);
+                }
+            }
+            return score + VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingTriangles), -VALENCE_BOOST_POWER);
+        }
+    }
+
+    void LveMeshOptimizer::optimize(LveModel::Builder& builder) {
+        if (builder.indices.size() < 3) {
+            return;
+        }
+        uint32_t vertexCount = static_cast<uint32_t>(builder.vertices.size());
+        optimizeVertexCache(builder.indices, vertexCount);
+        optimizeOverdraw(builder.indices, builder.vertices);
+        optimizeVertexFetch(builder.vertices, builder.indices);
+    }
+
+    void LveMeshOptimizer::optimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount) {
+        size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0) {
+            return;
+        }
+
+        // triangles of each vertex, the first remainingTriangles[v] entries of its range are the triangles not emitted yet
+        std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+        for (size_t i = 0; i < triangleCount * 3; i++) {
+            adjacencyOffsets[indices[i] + 1]++;
+        }
+        for (uint32_t v = 0; v < vertexCount; v++) {
+            adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+        }
+        std::vector<uint32_t> remainingTriangles(vertexCount, 0);
+        std::vector<uint32_t> adjacency(triangleCount * 3);
+        for (size_t i = 0; i < triangleCount * 3; i++) {
+            uint32_t vertex = indices[i];
+            adjacency[adjacencyOffsets[vertex] + remainingTriangles[vertex]++] = static_cast<uint32_t>(i / 3);
+        }
+
+        std::vector<float> vertexScores(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; v++) {
+            vertexScores[v] = computeVertexScore(-1, remainingTriangles[v]);
+        }
+        auto triangleScore = [&](size_t triangle) {
+            return vertexScores[indices[triangle * 3 + 0]] + vertexScores[indices[triangle * 3 + 1]] + vertexScores[indices[triangle * 3 + 2]];
+        };
+
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> output;
+        output.reserve(triangleCount * 3);
+        std::vector<uint32_t> cache;
+        std::vector<uint32_t> newCache;
+        cache.reserve(FORSYTH_CACHE_SIZE + 3);
+        newCache.reserve(FORSYTH_CACHE_SIZE + 3);
+        size_t inputCursor = 0;
+
+        size_t bestTriangle = 0;
+        float bestScore = -1.f;
+        for (size_t t = 0; t < triangleCount; t++) {
+            float score = triangleScore(t);
+            if (score > bestScore) {
+                bestScore = score;
+                bestTriangle = t;
+            }
+        }
+
+        for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++) {
+            if (bestScore < 0.f) {
+                // dead end : no triangle left around the cache, take the next one in the input order
+                while (emitted[inputCursor]) {
+                    inputCursor++;
+                }
+                bestTriangle = inputCursor;
+            }
+
+            const uint32_t* triangle = &indices[bestTriangle * 3];
+            emitted[bestTriangle] = true;
+            output.insert(output.end(), triangle, triangle + 3);
+
+            newCache.clear();
+            for (int corner = 0; corner < 3; corner++) {
+                uint32_t vertex = triangle[corner];
+                // remove the triangle from the live range of the vertex
+                uint32_t* first = &adjacency[adjacencyOffsets[vertex]];
+                uint32_t* last = first + remainingTriangles[vertex];
+                *std::find(first, last, static_cast<uint32_t>(bestTriangle)) = *(last - 1);
+                remainingTriangles[vertex]--;
+                if (std::find(newCache.begin(), newCache.end(), vertex) == newCache.end()) {
+                    newCache.push_back(vertex);
+                }
+            }
+            // the vertices of the triangle go to the front, the others move back
+            size_t triangleVertexCount = newCache.size();
+            for (uint32_t vertex : cache) {
+                if (std::find(newCache.begin(), newCache.begin() + triangleVertexCount, vertex) == newCache.begin() + triangleVertexCount) {
+                    newCache.push_back(vertex);
+                }
+            }
+
+            // the vertices pushed out of the cache lose their cache score
+            for (size_t i = FORSYTH_CACHE_SIZE; i < newCache.size(); i++) {
+                vertexScores[newCache[i]] = computeVertexScore(-1, remainingTriangles[newCache[i]]);
+            }
+            newCache.resize(std::min<size_t>(newCache.size(), FORSYTH_CACHE_SIZE));
+            for (size_t i = 0; i < newCache.size(); i++) {
+                vertexScores[newCache[i]] = computeVertexScore(static_cast<int>(i), remainingTriangles[newCache[i]]);
+            }
+            std::swap(cache, newCache);
+
+            // the next triangle is the best one touching the cache
+            bestScore = -1.f;
+            for (uint32_t vertex : cache) {
+                const uint32_t* first = &adjacency[adjacencyOffsets[vertex]];
+                for (uint32_t i = 0; i < remainingTriangles[vertex]; i++) {
+                    float score = triangleScore(first[i]);
+                    if (score > bestScore) {
+                        bestScore = score;
+                        bestTriangle = first[i];
+                    }
+                }
+            }
+        }
+
+        std::copy(output.begin(), output.end(), indices.begin());
+    }
+
+    void LveMeshOptimizer::optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<LveModel::Vertex>& vertices) {
+        size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0) {
+            return;
+        }
+
+        // a triangle missing its three vertices starts a new cluster : the cache is cold there, moving the cluster costs nothing
+        std::vector<size_t> clusterStarts;
+        FifoCache cache{ static_cast<uint32_t>(vertices.size()), CACHE_SIZE };
+        for (size_t t = 0; t < triangleCount; t++) {
+            int misses = 0;
+            for (int corner = 0; corner < 3; corner++) {
+                misses += cache.fetch(indices[t * 3 + corner]) ? 1 : 0;
+            }
+            if (misses == 3 || t == 0) {
+                clusterStarts.push_back(t);
+            }
+        }
+        clusterStarts.push_back(triangleCount);
+        size_t clusterCount = clusterStarts.size() - 1;
+        if (clusterCount < 2) {
+            return;
+        }
+
+        // area weighted centroid and normal of the mesh and of each cluster
+        std::vector<glm::vec3> clusterCentroids(clusterCount, glm::vec3{ 0.f });
+        std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3{ 0.f });
+        std::vector<float> clusterAreas(clusterCount, 0.f);
+        glm::vec3 meshCentroid{ 0.f };
+        float meshArea = 0.f;
+        for (size_t c = 0; c < clusterCount; c++) {
+            for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++) {
+                const glm::vec3& a = vertices[indices[t * 3 + 0]].position;
+                const glm::vec3& b = vertices[indices[t * 3 + 1]].position;
+                const glm::vec3& p = vertices[indices[t * 3 + 2]].position;
+                glm::vec3 normal = glm::cross(b - a, p - a);
+                float area = glm::length(normal);
+                glm::vec3 center = (a + b + p) / 3.f;
+                clusterCentroids[c] += center * area;
+                clusterNormals[c] += normal;
+                clusterAreas[c] += area;
+            }
+            meshCentroid += clusterCentroids[c];
+            meshArea += clusterAreas[c];
+        }
+        if (meshArea > 0.f) {
+            meshCentroid /= meshArea;
+        }
+
+        // clusters far out along their normal are in front of the rest of the mesh when they face the camera
+        std::vector<float> clusterKeys(clusterCount, 0.f);
+        for (size_t c = 0; c < clusterCount; c++) {
+            float normalLength = glm::length(clusterNormals[c]);
+            if (clusterAreas[c] > 0.f && normalLength > 0.f) {
+                glm::vec3 centroid = clusterCentroids[c] / clusterAreas[c];
+                clusterKeys[c] = glm::dot(centroid - meshCentroid, clusterNormals[c] / normalLength);
+            }
+        }
+        std::vector<uint32_t> clusterOrder(clusterCount);
+        for (uint32_t c = 0; c < clusterCount; c++) {
+            clusterOrder[c] = c;
+        }
+        std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&](uint32_t a, uint32_t b) { return clusterKeys[a] > clusterKeys[b]; });
+
+        std::vector<uint32_t> output;
+        output.reserve(indices.size());
+        for (uint32_t c : clusterOrder) {
+            output.insert(output.end(), indices.begin() + clusterStarts[c] * 3, indices.begin() + clusterStarts[c + 1] * 3);
+        }
+        std::copy(output.begin(), output.end(), indices.begin());
+    }
+
+    void LveMeshOptimizer::optimizeVertexFetch(std::vector<LveModel::Vertex>& vertices, std::vector<uint32_t>& indices) {
+        std::vector<uint32_t> remap(vertices.size(), INVALID_INDEX);
+        std::vector<LveModel::Vertex> fetchOrder;
+        fetchOrder.reserve(vertices.size());
+        for (auto& index : indices) {
+            if (remap[index] == INVALID_INDEX) {
+                remap[index] = static_cast<uint32_t>(fetchOrder.size());
+                fetchOrder.push_back(vertices[index]);
+            }
+            index = remap[index];
+        }
+        vertices = std::move(fetchOrder);
+    }
+
+    LveVertexCacheStats LveMeshOptimizer::analyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount) {
+        LveVertexCacheStats stats{};
+        size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0) {
+            return stats;
+        }
+
+        FifoCache cache{ vertexCount, CACHE_SIZE };
+        std::vector<bool> referenced(vertexCount, false);
+        size_t misses = 0;
+        size_t referencedCount = 0;
+        for (size_t i = 0; i < triangleCount * 3; i++) {
+            uint32_t vertex = indices[i];
+            misses += cache.fetch(vertex) ? 1 : 0;
+            if (!referenced[vertex]) {
+                referenced[vertex] = true;
+                referencedCount++;
+            }
+        }
+        stats.acmr = static_cast<float>(misses) / static_cast<float>(triangleCount);
+        stats.atvr = static_cast<float>(misses) / static_cast<float>(referencedCount);
+        return stats;
+    }
+}  // namespace lve
@@ -0,0 +1,272 @@
+#include "lve_mesh_simplifier.hpp"
+#include "lve_mesh_optimizer.hpp"
+
+//std
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace lve {
+    namespace {
+        constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+        constexpr float MAX_NORMAL_ROTATION_COS = 0.25f; /** @brief A collapse may not turn the normal of a remaining triangle by more than about 75 degrees. */
+
+        /**
+         * @brief Sum of the squared distances to a set of planes, weighted by the area of their triangles.
+        */
+        struct Quadric {
+            double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0;
+            double b2 = 0.0, bc = 0.0, bd = 0.0;
+            double c2 = 0.0, cd = 0.0;
+            double d2 = 0.0;
+            double weight = 0.0; /** @brief Sum of the weights of the planes. */
+
+            /**
+             * @brief Adds a plane.
+             * @param normal : The unit normal of the plane.
+             * @param distance : The signed distance term of the plane (dot(normal, p) + distance = 0 on the plane).
+             * @param planeWeight : The weight of the plane.
+            */
+            void addPlane(const glm::dvec3& normal, double distance, double planeWeight) {
+                a2 += normal.x * normal.x * planeWeight;
+                ab += normal.x * normal.y * planeWeight;
+                ac += normal.x * normal.z * planeWeight;
+                ad += normal.x * distance * planeWeight;
+                b2 += normal.y * normal.y * planeWeight;
+                bc += normal.y * normal.z * planeWeight;
+                bd += normal.y * distance * planeWeight;
+                c2 += normal.z * normal.z * planeWeight;
+                cd += normal.z * distance * planeWeight;
+                d2 += distance * distance * planeWeight;
+                weight += planeWeight;
+            }
+
+            /**
+             * @brief Adds the planes of another quadric.
+             * @param other : The other quadric.
+            */
+            void add(const Quadric& other) {
+                a2 += other.a2; ab += other.ab; ac += other.ac; ad += other.ad;
+                b2 += other.b2; bc += other.bc; bd += other.bd;
+                c2 += other.c2; cd += other.cd;
+                d2 += other.d2;
+                weight += other.weight;
+            }
+
+            /**
+             * @brief Evaluates the quadric at a position.
+             * @param position : The position.
+             * @return The weighted mean of the squared distances to the planes.
+            */
+            double evaluate(const glm::vec3& position) const {
+                double x = position.x;
+                double y = position.y;
+                double z = position.z;
+                double sum = a2 * x * x + b2 * y * y + c2 * z * z
+                    + 2.0 * (ab * x * y + ac * x * z + bc * y * z)
+                    + 2.0 * (ad * x + bd * y + cd * z)
+                    + d2;
+                return weight > 0.0 ? std::abs(sum) / weight : 0.0;
+            }
+        };
+
+        /**
+         * @brief Candidate collapse of a vertex onto a neighbour.
+        */
+        struct Collapse {
+            uint32_t source; /** @brief Vertex that disappears. */
+            uint32_t target; /** @brief Vertex that takes its place. */
+            double error; /** @brief Quadric error of the source at the position of the target. */
+        };
+    }
+
+    void LveMeshSimplifier::buildLods(LveModel::Builder& builder) {
+        uint32_t vertexCount = static_cast<uint32_t>(builder.vertices.size());
+        builder.lods.assign(1, { 0, static_cast<uint32_t>(builder.indices.size()), 0.f });
+        std::vector<uint32_t> level(builder.indices);
+        float error = 0.f;
+        while (builder.lods.size() < MAX_LODS) {
+            size_t previousIndexCount = level.size();
+            size_t targetIndexCount = static_cast<size_t>(previousIndexCount / 3 * LOD_RATIO) * 3;
+            // each level is simplified from the previous one, their errors add up
+            error += simplify(builder.vertices, level, targetIndexCount);
+            if (level.size() > previousIndexCount * 9 / 10) {
+                break;
+            }
+            LveMeshOptimizer::optimizeVertexCache(level, vertexCount);
+            builder.lods.push_back({ static_cast<uint32_t>(builder.indices.size()), static_cast<uint32_t>(level.size()), error });
+            builder.indices.insert(builder.indices.end(), level.begin(), level.end());
+        }
+    }
+
+    uint32_t LveMeshSimplifier::selectLod(const std::vector<LveModel::Lod>& lods, float screenSizePerUnit, float maxScreenError) {
+        // the errors grow with the level
+        uint32_t level = 0;
+        while (level + 1 < lods.size() && lods[level + 1].error * screenSizePerUnit <= maxScreenError) {
+            level++;
+        }
+        return level;
+    }
+
+    float LveMeshSimplifier::simplify(const std::vector<LveModel::Vertex>& vertices, std::vector<uint32_t>& indices, size_t targetIndexCount) {
+        uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+        size_t triangleCount = indices.size() / 3;
+
+        // planes of the triangles, weighted by their area so that slivers count little
+        std::vector<Quadric> quadrics(vertexCount);
+        for (size_t t = 0; t < triangleCount; t++) {
+            glm::dvec3 a{ vertices[indices[t * 3 + 0]].position };
+            glm::dvec3 b{ vertices[indices[t * 3 + 1]].position };
+            glm::dvec3 c{ vertices[indices[t * 3 + 2]].position };
+            glm::dvec3 normal = glm::cross(b - a, c - a);
+            double area = glm::length(normal);
+            if (area == 0.0) continue;
+
+            normal /= area;
+            double distance = -glm::dot(normal, a);
+            for (uint32_t k = 0; k < 3; k++) {
+                quadrics[indices[t * 3 + k]].addPlane(normal, distance, area);
+            }
+        }
+
+        // an edge of a single triangle is an open border or an attribute seam, one of more than two is not manifold : their vertices stay
+        std::vector<uint64_t> edges(triangleCount * 3);
+        for (size_t t = 0; t < triangleCount; t++) {
+            for (uint32_t k = 0; k < 3; k++) {
+                uint64_t a = indices[t * 3 + k];
+                uint64_t b = indices[t * 3 + (k + 1) % 3];
+                edges[t * 3 + k] = std::min(a, b) << 32 | std::max(a, b);
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        std::vector<uint8_t> locked(vertexCount, 0);
+        for (size_t e = 0; e < edges.size();) {
+            size_t end = e + 1;
+            while (end < edges.size() && edges[end] == edges[e]) {
+                end++;
+            }
+            if (end - e != 2) {
+                locked[static_cast<uint32_t>(edges[e] >> 32)] = 1;
+                locked[static_cast<uint32_t>(edges[e])] = 1;
+            }
+            e = end;
+        }
+
+        std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+        std::vector<uint32_t> adjacency{};
+        std::vector<uint32_t> adjacencyFill{};
+        std::vector<uint32_t> bestTargets(vertexCount);
+        std::vector<double> bestErrors(vertexCount);
+        std::vector<Collapse> collapses{};
+        std::vector<uint8_t> touched(vertexCount);
+        std::vector<uint32_t> remap(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; v++) {
+            remap[v] = v;
+        }
+        double maxError = 0.0;
+
+        while (indices.size() > targetIndexCount) {
+            triangleCount = indices.size() / 3;
+
+            // triangles of each vertex, in compressed rows
+            std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+            for (uint32_t index : indices) {
+                adjacencyOffsets[index + 1]++;
+            }
+            for (uint32_t v = 0; v < vertexCount; v++) {
+                adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+            }
+            adjacency.resize(indices.size());
+            adjacencyFill.assign(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (size_t t = 0; t < triangleCount; t++) {
+                for (uint32_t k = 0; k < 3; k++) {
+                    adjacency[adjacencyFill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+                }
+            }
+
+            // cheapest neighbour of each vertex that can move
+            std::fill(bestTargets.begin(), bestTargets.end(), INVALID_INDEX);
+            std::fill(bestErrors.begin(), bestErrors.end(), std::numeric_limits<double>::max());
+            for (size_t i = 0; i < indices.size(); i++) {
+                uint32_t a = indices[i];
+                uint32_t b = indices[i % 3 == 2 ? i - 2 : i + 1];
+                for (auto [source, target] : { std::pair{ a, b }, std::pair{ b, a } }) {
+                    if (locked[source] || source == target) continue;
+
+                    double error = quadrics[source].evaluate(vertices[target].position);
+                    if (error < bestErrors[source]) {
+                        bestErrors[source] = error;
+                        bestTargets[source] = target;
+                    }
+                }
+            }
+            collapses.clear();
+            for (uint32_t v = 0; v < vertexCount; v++) {
+                if (bestTargets[v] != INVALID_INDEX) {
+                    collapses.push_back({ v, bestTargets[v], bestErrors[v] });
+                }
+            }
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+            // the collapses of a pass touch disjoint triangles, so that each one is checked against the mesh it changes
+            std::fill(touched.begin(), touched.end(), 0);
+            size_t remainingTriangles = triangleCount;
+            size_t targetTriangles = targetIndexCount / 3;
+            size_t collapseCount = 0;
+            for (const Collapse& collapse : collapses) {
+                if (remainingTriangles <= targetTriangles) break;
+                if (touched[collapse.source] || touched[collapse.target]) continue;
+
+                const glm::vec3& sourcePosition = vertices[collapse.source].position;
+                const glm::vec3& targetPosition = vertices[collapse.target].position;
+                bool flips = false;
+                uint32_t removedTriangles = 0;
+                for (uint32_t a = adjacencyOffsets[collapse.source]; a < adjacencyOffsets[collapse.source + 1] && !flips; a++) {
+                    const uint32_t* triangle = &indices[adjacency[a] * 3];
+                    if (triangle[0] == collapse.target || triangle[1] == collapse.target || triangle[2] == collapse.target) {
+                        removedTriangles++;
+                        continue;
+                    }
+                    // the winding is kept, the source corner moves onto the target
+                    uint32_t corner = triangle[0] == collapse.source ? 0 : triangle[1] == collapse.source ? 1 : 2;
+                    const glm::vec3& next = vertices[triangle[(corner + 1) % 3]].position;
+                    const glm::vec3& previous = vertices[triangle[(corner + 2) % 3]].position;
+                    glm::vec3 before = glm::cross(next - sourcePosition, previous - sourcePosition);
+                    glm::vec3 after = glm::cross(next - targetPosition, previous - targetPosition);
+                    flips = glm::dot(before, after) <= MAX_NORMAL_ROTATION_COS * glm::length(before) * glm::length(after);
+                }
+                if (flips) continue;
+
+                for (uint32_t a = adjacencyOffsets[collapse.source]; a < adjacencyOffsets[collapse.source + 1]; a++) {
+                    const uint32_t* triangle = &indices[adjacency[a] * 3];
+                    touched[triangle[0]] = 1;
+                    touched[triangle[1]] = 1;
+                    touched[triangle[2]] = 1;
+                }
+                remap[collapse.source] = collapse.target;
+                quadrics[collapse.target].add(quadrics[collapse.source]);
+                maxError = std::max(maxError, collapse.error);
+                remainingTriangles -= removedTriangles;
+                collapseCount++;
+            }
+            if (collapseCount == 0) {
+                break;
+            }
+
+            // the triangles of a collapsed edge lose a corner and disappear
+            size_t keptIndices = 0;
+            for (size_t t = 0; t < triangleCount; t++) {
+                uint32_t a = remap[indices[t * 3 + 0]];
+                uint32_t b = remap[indices[t * 3 + 1]];
+                uint32_t c = remap[indices[t * 3 + 2]];
+                if (a == b || b == c || a == c) continue;
+
+                indices[keptIndices++] = a;
+                indices[keptIndices++] = b;
+                indices[keptIndices++] = c;
+            }
+            indices.resize(keptIndices);
+        }
+        return static_cast<float>(std::sqrt(maxError));
+    }
+}  // namespace lve
@@ -0,0 +1,207 @@
+#include "lve_meshlet_builder.hpp"
+
+//std
+#include <algorithm>
+#include <cmath>
+
+namespace lve {
+    namespace {
+        constexpr uint32_t NO_TRIANGLE = UINT32_MAX;
+        constexpr float MIN_CONE_DOT = 0.1f;
+
+        /**
+         * @brief Computes the unit normal of a triangle, on the side of its vertex normals when the mesh has some.
+         * The pipelines draw both faces, so the winding alone does not say which side is seen.
+         * @param vertices : The vertices of the mesh.
+         * @param indices : The indices of the mesh.
+         * @param firstIndex : The first index of the triangle.
+         * @param normal : Receives the normal.
+         * @return False for a triangle without area.
+        */
+        bool getTriangleNormal(const std::vector<LveModel::Vertex>& vertices, const std::vector<uint32_t>& indices, size_t firstIndex, glm::vec3& normal) {
+            const LveModel::Vertex& a = vertices[indices[firstIndex + 0]];
+            const LveModel::Vertex& b = vertices[indices[firstIndex + 1]];
+            const LveModel::Vertex& c = vertices[indices[firstIndex + 2]];
+            normal = glm::cross(b.position - a.position, c.position - a.position);
+            float length = glm::length(normal);
+            if (length == 0.f) {
+                return false;
+            }
+            normal /= length;
+            if (glm::dot(normal, a.normal + b.normal + c.normal) < 0.f) {
+                normal = -normal;
+            }
+            return true;
+        }
+    }
+
+    void LveMeshletBuilder::build(LveModel::Builder& builder) {
+        const std::vector<uint32_t>& indices = builder.indices;
+        uint32_t vertexCount = static_cast<uint32_t>(builder.vertices.size());
+        uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+        builder.meshlets.clear();
+        if (triangleCount == 0) {
+            return;
+        }
+
+        // triangles of each vertex, in compressed rows
+        std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+        for (size_t i = 0; i < triangleCount * 3; i++) {
+            adjacencyOffsets[indices[i] + 1]++;
+        }
+        for (uint32_t v = 0; v < vertexCount; v++) {
+            adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+        }
+        std::vector<uint32_t> adjacency(triangleCount * 3);
+        std::vector<uint32_t> adjacencyFill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (uint32_t t = 0; t < triangleCount; t++) {
+            for (uint32_t k = 0; k < 3; k++) {
+                adjacency[adjacencyFill[indices[t * 3 + k]]++] = t;
+            }
+        }
+
+        std::vector<uint8_t> emitted(triangleCount, 0);
+        std::vector<uint32_t> vertexMeshlets(vertexCount, UINT32_MAX);
+        std::vector<uint32_t> candidates{};
+        std::vector<uint32_t> meshletIndices{};
+        meshletIndices.reserve(triangleCount * 3);
+        uint32_t nextSeed = 0;
+
+        while (meshletIndices.size() < triangleCount * 3) {
+            uint32_t meshletIndex = static_cast<uint32_t>(builder.meshlets.size());
+            LveModel::Meshlet meshlet{};
+            meshlet.firstIndex = static_cast<uint32_t>(meshletIndices.size());
+            uint32_t meshletVertexCount = 0;
+            uint32_t meshletTriangleCount = 0;
+
+            auto addTriangle = [&](uint32_t triangle) {
+                emitted[triangle] = 1;
+                for (uint32_t k = 0; k < 3; k++) {
+                    uint32_t vertex = indices[triangle * 3 + k];
+                    meshletIndices.push_back(vertex);
+                    if (vertexMeshlets[vertex] == meshletIndex) continue;
+
+                    // the triangles of a new vertex become candidates, those of the other vertices already are
+                    vertexMeshlets[vertex] = meshletIndex;
+                    meshletVertexCount++;
+                    for (uint32_t a = adjacencyOffsets[vertex]; a < adjacencyOffsets[vertex + 1]; a++) {
+                        if (!emitted[adjacency[a]]) {
+                            candidates.push_back(adjacency[a]);
+                        }
+                    }
+                }
+                meshletTriangleCount++;
+            };
+
+            // the meshlet starts on the border of the previous one, or at the first triangle left
+            uint32_t seed = NO_TRIANGLE;
+            for (uint32_t candidate : candidates) {
+                if (!emitted[candidate]) {
+                    seed = candidate;
+                    break;
+                }
+            }
+            if (seed == NO_TRIANGLE) {
+                while (emitted[nextSeed]) {
+                    nextSeed++;
+                }
+                seed = nextSeed;
+            }
+            candidates.clear();
+            addTriangle(seed);
+
+            while (meshletTriangleCount < MAX_TRIANGLES) {
+                uint32_t best = NO_TRIANGLE;
+                uint32_t bestNewVertices = 4;
+                size_t keptCandidates = 0;
+                for (size_t c = 0; c < candidates.size(); c++) {
+                    uint32_t triangle = candidates[c];
+                    if (emitted[triangle]) continue;
+
+                    candidates[keptCandidates++] = triangle;
+                    if (bestNewVertices == 0) continue;
+
+                    uint32_t newVertices = 0;
+                    for (uint32_t k = 0; k < 3; k++) {
+                        newVertices += vertexMeshlets[indices[triangle * 3 + k]] != meshletIndex ? 1 : 0;
+                    }
+                    if (newVertices < bestNewVertices && meshletVertexCount + newVertices <= MAX_VERTICES) {
+                        best = triangle;
+                        bestNewVertices = newVertices;
+                    }
+                }
+                candidates.resize(keptCandidates);
+                if (best == NO_TRIANGLE) {
+                    break;
+                }
+                addTriangle(best);
+            }
+
+            meshlet.indexCount = static_cast<uint32_t>(meshletIndices.size()) - meshlet.firstIndex;
+            builder.meshlets.push_back(meshlet);
+        }
+
+        builder.indices = std::move(meshletIndices);
+        for (auto& meshlet : builder.meshlets) {
+            computeBounds(builder.vertices, builder.indices, meshlet);
+        }
+    }
+
+    void LveMeshletBuilder::computeBounds(const std::vector<LveModel::Vertex>& vertices, const std::vector<uint32_t>& indices, LveModel::Meshlet& meshlet) {
+        size_t firstIndex = meshlet.firstIndex;
+        size_t lastIndex = firstIndex + meshlet.indexCount;
+
+        // sphere around the box of the vertices, a little larger than the smallest one but cheap
+        glm::vec3 minPosition = vertices[indices[firstIndex]].position;
+        glm::vec3 maxPosition = minPosition;
+        for (size_t i = firstIndex + 1; i < lastIndex; i++) {
+            minPosition = glm::min(minPosition, vertices[indices[i]].position);
+            maxPosition = glm::max(maxPosition, vertices[indices[i]].position);
+        }
+        meshlet.center = (minPosition + maxPosition) * 0.5f;
+        float radiusSquared = 0.f;
+        for (size_t i = firstIndex; i < lastIndex; i++) {
+            glm::vec3 offset = vertices[indices[i]].position - meshlet.center;
+            radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+        }
+        meshlet.radius = std::sqrt(radiusSquared);
+
+        // the axis is the average of the unit normals, the cone must contain all of them
+        glm::vec3 normal{};
+        glm::vec3 normalSum{ 0.f };
+        for (size_t i = firstIndex; i < lastIndex; i += 3) {
+            if (getTriangleNormal(vertices, indices, i, normal)) {
+                normalSum += normal;
+            }
+        }
+        float sumLength = glm::length(normalSum);
+        meshlet.coneAxis = sumLength > 0.f ? normalSum / sumLength : glm::vec3{ 0.f, 0.f, 1.f };
+        meshlet.coneApex = meshlet.center;
+        meshlet.coneCutoff = 2.f;
+        if (sumLength == 0.f) {
+            return;
+        }
+
+        float minDot = 1.f;
+        for (size_t i = firstIndex; i < lastIndex; i += 3) {
+            if (getTriangleNormal(vertices, indices, i, normal)) {
+                minDot = std::min(minDot, glm::dot(meshlet.coneAxis, normal));
+            }
+        }
+        if (minDot <= MIN_CONE_DOT) {
+            // a cone this wide almost never faces away, the test would only cost time
+            return;
+        }
+
+        // the apex is the point of the axis behind the plane of every triangle
+        float maxDistance = 0.f;
+        for (size_t i = firstIndex; i < lastIndex; i += 3) {
+            if (getTriangleNormal(vertices, indices, i, normal)) {
+                float distance = glm::dot(meshlet.center - vertices[indices[i]].position, normal) / glm::dot(meshlet.coneAxis, normal);
+                maxDistance = std::max(maxDistance, distance);
+            }
+        }
+        meshlet.coneApex = meshlet.center - meshlet.coneAxis * maxDistance;
+        meshlet.coneCutoff = std::sqrt(1.f - minDot * minDot);
+    }
+}  // namespace lve
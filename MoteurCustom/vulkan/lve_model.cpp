@@ -1,96 +1,168 @@
 #include "lve_model.hpp"
-#include "lve_utils.hpp"
-
-//libs
-#define TINYOBJLOADER_IMPLEMENTATION
-#include "tiny_obj_loader.h"
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/hash.hpp>
+#include "lve_mesh_cache.hpp"
+#include "lve_mesh_optimizer.hpp"
+#include "lve_meshlet_builder.hpp"
+#include "lve_mesh_simplifier.hpp"
+#include "lve_obj_loader.hpp"
+#include "lve_upload_queue.hpp"
+#include "lve_vertex_quantizer.hpp"
 
 //std
 #include <cassert>
+#include <cstdint>
 #include <cstring>
 #include <iostream>
-#include <unordered_map>
-
-namespace std {
-    template<>
-    struct hash<lve::LveModel::Vertex> {
-        size_t operator()(lve::LveModel::Vertex const& vertex) const {
-            size_t seed = 0;
-            lve::hashCombine(seed, vertex.position, vertex.color, vertex.normal, vertex.uv);
-            return seed;
-        }
-    };
-}
+#include <stdexcept>
 
 namespace lve {
-    LveModel::LveModel(LveDevice& device, const LveModel::Builder& builder) : lveDevice{ device } {
-        createVertexBuffers(builder.vertices);
-        createIndexBuffers(builder.indices);
+    LveModel::LveModel(LveDevice& device, const LveModel::Builder& builder, VertexFormat vertexFormat)
+        : LveModel(device, builder.vertices.data(), static_cast<uint32_t>(builder.vertices.size()), builder.indices.data(), static_cast<uint32_t>(builder.indices.size()),
+            builder.meshlets.data(), static_cast<uint32_t>(builder.meshlets.size()), builder.lods.data(), static_cast<uint32_t>(builder.lods.size()), vertexFormat) {}
+
+    LveModel::LveModel(LveDevice& device, const Vertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount,
+        const Meshlet* meshlets, uint32_t meshletCount, const Lod* lods, uint32_t lodCount, VertexFormat vertexFormat)
+        : lveDevice{ device }, meshlets(meshlets, meshlets + meshletCount), lods(lods, lods + lodCount), vertexFormat{ vertexFormat } {
+        // an empty OBJ gets here too, the bounding box reads the first vertex
+        if (vertexCount < 3) {
+            throw std::runtime_error("Vertex count must be at least 3");
+        }
+        if (this->lods.empty() && indexCount > 0) {
+            this->lods.push_back({ 0, indexCount, 0.f });
+        }
+        computeBoundingBox(vertices, vertexCount);
+        createGeometry(vertices, vertexCount, indices, indexCount);
     }
     
-    LveModel::~LveModel() {}
+    LveModel::~LveModel() {
+        // the ranges may still be the destination of a copy
+        lveDevice.getUploadQueue().wait(uploadTicket);
+        lveDevice.getGeometryPool().free(mesh);
+    }
+
+    std::unique_ptr <LveModel> LveModel::createModelFromFile(LveDevice& device, const std::string& filePath, bool optimize, VertexFormat vertexFormat) {
+        uint64_t sourceSize = 0;
+        uint64_t sourceChecksum = LveMeshCache::computeChecksum(filePath, sourceSize);
+        std::string cachePath = LveMeshCache::getCachePath(filePath);
+        uint32_t cacheFlags = optimize ? LveMeshCache::FLAG_OPTIMIZED : 0;
+
+        // the cache stays mapped until the arrays are in the staging ring
+        LveMeshCache cache{};
+        if (sourceChecksum != 0 && cache.open(cachePath, sourceSize, sourceChecksum, cacheFlags)) {
+            std::cout << "Vertex count: " << cache.getVertexCount() << " (cached)\n";
+            return std::make_unique<LveModel>(device, cache.getVertices(), cache.getVertexCount(), cache.getIndices(), cache.getIndexCount(), cache.getMeshlets(), cache.getMeshletCount(), cache.getLods(), cache.getLodCount(), vertexFormat);
+        }
 
-    std::unique_ptr <LveModel> LveModel::createModelFromFile(LveDevice& device, const std::string& filePath) {
         Builder builder{};
         builder.loadModel(filePath);
         std::cout << "Vertex count: " << builder.vertices.size() << "\n";
+        if (optimize) {
+            uint32_t vertexCount = static_cast<uint32_t>(builder.vertices.size());
+            LveVertexCacheStats before = LveMeshOptimizer::analyzeVertexCache(builder.indices, vertexCount);
+            LveMeshOptimizer::optimize(builder);
+            if (builder.indices.size() / 3 >= LveMeshletBuilder::MIN_TRIANGLES) {
+                // the meshlets regroup the triangles, the vertices are then put back in order of first use
+                LveMeshletBuilder::build(builder);
+                LveMeshOptimizer::optimizeVertexFetch(builder.vertices, builder.indices);
+                std::cout << "Meshlets: " << builder.meshlets.size() << "\n";
+            }
+            LveVertexCacheStats after = LveMeshOptimizer::analyzeVertexCache(builder.indices, static_cast<uint32_t>(builder.vertices.size()));
+            std::cout << "Mesh optimization: ACMR " << before.acmr << " -> " << after.acmr << ", ATVR " << before.atvr << " -> " << after.atvr << "\n";
+        }
+        if (builder.indices.size() / 3 >= LveMeshSimplifier::MIN_TRIANGLES) {
+            LveMeshSimplifier::buildLods(builder);
+            std::cout << "Levels of detail:";
+            for (const Lod& lod : builder.lods) {
+                std::cout << " " << lod.indexCount / 3;
+            }
+            std::cout << " triangles\n";
+        }
+        if (sourceChecksum != 0 && !LveMeshCache::write(cachePath, sourceSize, sourceChecksum, cacheFlags, builder)) {
+            std::cerr << "failed to write mesh cache " << cachePath << "\n";
+        }
 
-        return std::make_unique<LveModel>(device, builder);
+        return std::make_unique<LveModel>(device, builder, vertexFormat);
     }
     
-    void LveModel::createVertexBuffers(const std::vector<Vertex>& vertices) {
-        vertexCount = static_cast<uint32_t>(vertices.size());
-        assert(vertexCount >= 3 && "Vertex count must be at least 3");
-        VkDeviceSize bufferSize = sizeof(vertices[0]) * vertexCount;
-        uint32_t vertexSize = sizeof(vertices[0]);
-
-        LveBuffer stagingBuffer{ lveDevice, vertexSize, vertexCount, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT };
+    void LveModel::createGeometry(const Vertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount) {
+        // the levels of detail follow level 0 in the index range
+        this->vertexCount = vertexCount;
+        this->indexCount = lods.empty() ? 0 : lods[0].indexCount;
+        hasIndexBuffer = indexCount > 0;
 
-        stagingBuffer.map();
-        stagingBuffer.writeToBuffer((void*)vertices.data());
+        // the staging ring copies the arrays, they can be released on return
+        std::vector<CompactVertex> compactVertices{};
+        const void* vertexData = vertices;
+        uint32_t vertexSize = sizeof(vertices[0]);
+        if (vertexFormat == VertexFormat::Compact) {
+            vertexDecode = LveVertexQuantizer::getDecode(boundingBox);
+            compactVertices.resize(vertexCount);
+            LveVertexQuantizer::quantize(vertices, vertexCount, vertexDecode, compactVertices.data());
+            vertexData = compactVertices.data();
+            vertexSize = sizeof(CompactVertex);
+        }
 
-        vertexBuffer = std::make_unique<LveBuffer>(lveDevice, vertexSize, vertexCount, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        // most props are far below 64k vertices, their indices take half the memory and bandwidth
+        std::vector<uint16_t> shortIndices{};
+        const void* indexData = indices;
+        uint32_t indexSize = sizeof(uint32_t);
+        indexType = VK_INDEX_TYPE_UINT32;
+        if (hasIndexBuffer && vertexCount <= UINT16_MAX + 1u) {
+            shortIndices.assign(indices, indices + indexCount);
+            indexData = shortIndices.data();
+            indexSize = sizeof(uint16_t);
+            indexType = VK_INDEX_TYPE_UINT16;
+        }
 
-        lveDevice.copyBuffer(stagingBuffer.getBuffer(), vertexBuffer->getBuffer(), bufferSize);
+        LveGeometryPool& geometryPool = lveDevice.getGeometryPool();
+        mesh = geometryPool.allocate(vertexSize, vertexCount, indexSize, indexCount);
+        uploadTicket = geometryPool.upload(mesh, vertexData, indexData);
     }
     
-    void LveModel::createIndexBuffers(const std::vector<uint32_t>& indices) {
-        indexCount = static_cast<uint32_t>(indices.size());
-        hasIndexBuffer = indexCount > 0;
-        if (!hasIndexBuffer) {
-            return;
+    void LveModel::computeBoundingBox(const Vertex* vertices, uint32_t count) {
+        // the vertices are unique after loadModel, so this is cheaper than walking the indices
+        glm::vec3 minPosition = vertices[0].position;
+        glm::vec3 maxPosition = vertices[0].position;
+        for (uint32_t i = 1; i < count; i++) {
+            minPosition = glm::min(minPosition, vertices[i].position);
+            maxPosition = glm::max(maxPosition, vertices[i].position);
         }
-
-        VkDeviceSize bufferSize = sizeof(indices[0]) * indexCount;
-        uint32_t indexSize = sizeof(indices[0]);
-
-        LveBuffer stagingBuffer{ lveDevice, indexSize, indexCount, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT };
-
-        stagingBuffer.map();
-        stagingBuffer.writeToBuffer((void*)indices.data());
-
-        indexBuffer = std::make_unique<LveBuffer>(lveDevice, indexSize, indexCount, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-
-        lveDevice.copyBuffer(stagingBuffer.getBuffer(), indexBuffer->getBuffer(), bufferSize);
+        boundingBox = AABB(minPosition, maxPosition);
     }
     
-    void LveModel::draw(VkCommandBuffer commandBuffer) {
+    bool LveModel::isReady() {
+        if (!uploaded) {
+            uploaded = lveDevice.getUploadQueue().isComplete(uploadTicket);
+        }
+        return uploaded;
+    }
+    
+    void LveModel::draw(VkCommandBuffer commandBuffer, uint32_t instanceCount, uint32_t firstInstance) {
+        LveGeometryPool::MeshRange range = getGeometryRange();
         if (hasIndexBuffer) {
-            vkCmdDrawIndexed(commandBuffer, indexCount, 1, 0, 0, 0);
+            vkCmdDrawIndexed(commandBuffer, indexCount, instanceCount, range.firstIndex, range.vertexOffset, firstInstance);
         } else {
-            vkCmdDraw(commandBuffer, vertexCount, 1, 0, 0);
+            vkCmdDraw(commandBuffer, vertexCount, instanceCount, static_cast<uint32_t>(range.vertexOffset), firstInstance);
         }
     }
     
+    void LveModel::drawRange(VkCommandBuffer commandBuffer, uint32_t firstIndex, uint32_t indexCount, uint32_t instanceCount, uint32_t firstInstance) {
+        assert(hasIndexBuffer && "Index ranges need an index buffer");
+        LveGeometryPool::MeshRange range = getGeometryRange();
+        vkCmdDrawIndexed(commandBuffer, indexCount, instanceCount, range.firstIndex + firstIndex, range.vertexOffset, firstInstance);
+    }
+    
+    void LveModel::drawIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset) {
+        assert(hasIndexBuffer && "Indirect draws need an index buffer");
+        vkCmdDrawIndexedIndirect(commandBuffer, buffer, offset, 1, sizeof(VkDrawIndexedIndirectCommand));
+    }
+    
     void LveModel::bind(VkCommandBuffer commandBuffer) {
-        VkBuffer buffers[] = { vertexBuffer->getBuffer() };
+        // the draws pick their range of the block with firstIndex and vertexOffset
+        VkBuffer block = lveDevice.getGeometryPool().getBuffer(getGeometryRange().block);
+        VkBuffer buffers[] = { block };
         VkDeviceSize offset[] = { 0 };
         vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offset);
-        if (hasIndexBuffer) {
-            vkCmdBindIndexBuffer(commandBuffer, indexBuffer->getBuffer(), 0, VK_INDEX_TYPE_UINT32);
-        }
+        vkCmdBindIndexBuffer(commandBuffer, block, 0, indexType);
     }
 
     std::vector<VkVertexInputBindingDescription>LveModel::Vertex::getBindingDescriptions() {
@@ -109,59 +181,26 @@ namespace lve {
         attributeDescriptions.push_back({ 3,0,VK_FORMAT_R32G32_SFLOAT,offsetof(Vertex, uv) });
         return attributeDescriptions;
     }
-    
-    void LveModel::Builder::loadModel(const std::string& filepath) {
-        tinyobj::attrib_t attrib;
-        std::vector<tinyobj::shape_t> shapes;
-        std::vector<tinyobj::material_t > materials;
-        std::string warn, err;
-
-        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filepath.c_str())) {
-            throw std::runtime_error(warn + err);
-        }
-        vertices.clear();
-        indices.clear();
 
-        std::unordered_map<Vertex, uint32_t> uniqueVertices{};
-        for (const auto& shape : shapes) {
-            for (const auto& index : shape.mesh.indices) {
-                Vertex vertex{};
+    std::vector<VkVertexInputBindingDescription>LveModel::CompactVertex::getBindingDescriptions() {
+        std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
+        bindingDescriptions[0].binding = 0;
+        bindingDescriptions[0].stride = sizeof(CompactVertex);
+        bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        return bindingDescriptions;
+    }
 
-                if (index.vertex_index >= 0) {
-                    vertex.position =
-                    {
-                        attrib.vertices[3 * index.vertex_index + 0],
-                        attrib.vertices[3 * index.vertex_index + 1],
-                        attrib.vertices[3 * index.vertex_index + 2],
-                    };
-                    vertex.color =
-                    {
-                        attrib.colors[3 * index.vertex_index + 0],
-                        attrib.colors[3 * index.vertex_index + 1],
-                        attrib.colors[3 * index.vertex_index + 2],
-                    };
-                }
-                if (index.normal_index >= 0) {
-                    vertex.normal =
-                    {
-                        attrib.normals[3 * index.normal_index + 0],
-                        attrib.normals[3 * index.normal_index + 1],
-                        attrib.normals[3 * index.normal_index + 2],
-                    };
-                }
-                if (index.texcoord_index >= 0) {
-                    vertex.uv =
-                    {
-                        attrib.texcoords[2 * index.texcoord_index + 0],
-                        attrib.texcoords[2 * index.texcoord_index + 1],
-                    };
-                }
-                if (uniqueVertices.count(vertex) == 0) {
-                    uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-                    vertices.push_back(vertex);
-                }
-                indices.push_back(uniqueVertices[vertex]);
-            }
-        }
+    std::vector<VkVertexInputAttributeDescription>LveModel::CompactVertex::getAttributeDescriptions() {
+        // every format here is mandatory for vertex buffers
+        std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
+        attributeDescriptions.push_back({ 0,0,VK_FORMAT_R16G16B16A16_UNORM,offsetof(CompactVertex, position) });
+        attributeDescriptions.push_back({ 1,0,VK_FORMAT_R8G8B8A8_UNORM,offsetof(CompactVertex, color) });
+        attributeDescriptions.push_back({ 2,0,VK_FORMAT_R16G16_SNORM,offsetof(CompactVertex, normal) });
+        attributeDescriptions.push_back({ 3,0,VK_FORMAT_R16G16_SFLOAT,offsetof(CompactVertex, uv) });
+        return attributeDescriptions;
+    }
+    
+    void LveModel::Builder::loadModel(const std::string& filepath) {
+        LveObjLoader::load(filepath, vertices, indices);
     }
 } //namespace lve
\ No newline at end of file
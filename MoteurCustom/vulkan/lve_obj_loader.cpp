@@ -0,0 +1,225 @@
+#include "lve_obj_loader.hpp"
+
+//libs
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "tiny_obj_loader.h"
+
+//std
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+
+namespace lve {
+    namespace {
+        constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+        constexpr size_t MIN_ITEMS_PER_THREAD = 16 * 1024;
+
+        /**
+         * @brief Chooses the number of threads of a job.
+         * @param requested : The requested number of threads (0 for one per hardware thread).
+         * @param itemCount : The number of items to process.
+         * @return The number of threads, at least 1.
+        */
+        uint32_t resolveThreadCount(uint32_t requested, size_t itemCount) {
+            uint32_t threadCount = requested > 0 ? requested : std::max(std::thread::hardware_concurrency(), 1u);
+            size_t usefulThreads = std::max<size_t>(itemCount / MIN_ITEMS_PER_THREAD, 1);
+            return static_cast<uint32_t>(std::min<size_t>(threadCount, usefulThreads));
+        }
+
+        /**
+         * @brief Runs a function on equal ranges of items, one per thread (the calling thread takes the first range).
+         * @param itemCount : The number of items.
+         * @param threadCount : The number of threads.
+         * @param fn : Called with the thread index and the range [begin, end) of the thread.
+        */
+        void parallelFor(size_t itemCount, uint32_t threadCount, const std::function<void(uint32_t, size_t, size_t)>& fn) {
+            std::vector<std::thread> threads;
+            threads.reserve(threadCount - 1);
+            for (uint32_t t = 1; t < threadCount; t++) {
+                threads.emplace_back(fn, t, itemCount * t / threadCount, itemCount * (t + 1) / threadCount);
+            }
+            fn(0, 0, itemCount / threadCount);
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        }
+
+        /**
+         * @brief Gets the hash partition of a corner, from the high bits so that the low bits stay free for the table slots.
+         * @param hash : The hash of the corner.
+         * @param partitionCount : The number of partitions.
+         * @return The partition.
+        */
+        uint32_t getPartition(uint64_t hash, uint32_t partitionCount) {
+            return static_cast<uint32_t>((hash >> 40) % partitionCount);
+        }
+    }
+
+    uint64_t LveObjLoader::hashVertex(const LveModel::Vertex& vertex) {
+        const float values[] = {
+            vertex.position.x, vertex.position.y, vertex.position.z,
+            vertex.color.x, vertex.color.y, vertex.color.z,
+            vertex.normal.x, vertex.normal.y, vertex.normal.z,
+            vertex.uv.x, vertex.uv.y };
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (float value : values) {
+            // adding +0 turns -0 into +0
+            float normalized = value + 0.f;
+            uint32_t bits;
+            std::memcpy(&bits, &normalized, sizeof(bits));
+            hash = (hash ^ bits) * 0x9e3779b97f4a7c15ull;
+            hash ^= hash >> 32;
+        }
+        return hash;
+    }
+
+    void LveObjLoader::load(const std::string& filepath, std::vector<LveModel::Vertex>& vertices, std::vector<uint32_t>& indices, uint32_t threadCount) {
+        tinyobj::attrib_t attrib;
+        std::vector<tinyobj::shape_t> shapes;
+        std::vector<tinyobj::material_t > materials;
+        std::string warn, err;
+
+        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filepath.c_str())) {
+            throw std::runtime_error(warn + err);
+        }
+
+        std::vector<LveModel::Vertex> corners;
+        std::vector<uint64_t> hashes;
+        buildCorners(attrib, shapes, corners, hashes, threadCount);
+        deduplicate(corners, hashes, vertices, indices, threadCount);
+    }
+
+    void LveObjLoader::buildCorners(const tinyobj::attrib_t& attrib, const std::vector<tinyobj::shape_t>& shapes, std::vector<LveModel::Vertex>& corners, std::vector<uint64_t>& hashes, uint32_t threadCount) {
+        std::vector<size_t> shapeOffsets(shapes.size() + 1, 0);
+        for (size_t s = 0; s < shapes.size(); s++) {
+            shapeOffsets[s + 1] = shapeOffsets[s] + shapes[s].mesh.indices.size();
+        }
+        size_t cornerCount = shapeOffsets.back();
+        corners.resize(cornerCount);
+        hashes.resize(cornerCount);
+
+        parallelFor(cornerCount, resolveThreadCount(threadCount, cornerCount), [&](uint32_t, size_t begin, size_t end) {
+            // first shape overlapping the range
+            size_t s = std::upper_bound(shapeOffsets.begin(), shapeOffsets.end(), begin) - shapeOffsets.begin() - 1;
+            for (size_t corner = begin; corner < end; corner++) {
+                while (corner >= shapeOffsets[s + 1]) {
+                    s++;
+                }
+                const auto& index = shapes[s].mesh.indices[corner - shapeOffsets[s]];
+                LveModel::Vertex vertex{};
+
+                if (index.vertex_index >= 0) {
+                    vertex.position =
+                    {
+                        attrib.vertices[3 * index.vertex_index + 0],
+                        attrib.vertices[3 * index.vertex_index + 1],
+                        attrib.vertices[3 * index.vertex_index + 2],
+                    };
+                    vertex.color =
+                    {
+                        attrib.colors[3 * index.vertex_index + 0],
+                        attrib.colors[3 * index.vertex_index + 1],
+                        attrib.colors[3 * index.vertex_index + 2],
+                    };
+                }
+                if (index.normal_index >= 0) {
+                    vertex.normal =
+                    {
+                        attrib.normals[3 * index.normal_index + 0],
+                        attrib.normals[3 * index.normal_index + 1],
+                        attrib.normals[3 * index.normal_index + 2],
+                    };
+                }
+                if (index.texcoord_index >= 0) {
+                    vertex.uv =
+                    {
+                        attrib.texcoords[2 * index.texcoord_index + 0],
+                        attrib.texcoords[2 * index.texcoord_index + 1],
+                    };
+                }
+                corners[corner] = vertex;
+                hashes[corner] = hashVertex(vertex);
+            }
+        });
+    }
+
+    void LveObjLoader::deduplicate(const std::vector<LveModel::Vertex>& corners, const std::vector<uint64_t>& hashes, std::vector<LveModel::Vertex>& vertices, std::vector<uint32_t>& indices, uint32_t threadCount) {
+        size_t cornerCount = corners.size();
+        uint32_t threads = resolveThreadCount(threadCount, cornerCount);
+        uint32_t partitionCount = threads;
+
+        // scatter the corners by partition, each partition keeps its corners in increasing order
+        std::vector<size_t> partitionCounts(static_cast<size_t>(threads) * partitionCount, 0);
+        parallelFor(cornerCount, threads, [&](uint32_t t, size_t begin, size_t end) {
+            size_t* counts = &partitionCounts[static_cast<size_t>(t) * partitionCount];
+            for (size_t corner = begin; corner < end; corner++) {
+                counts[getPartition(hashes[corner], partitionCount)]++;
+            }
+        });
+        std::vector<size_t> partitionStarts(partitionCount + 1, 0);
+        std::vector<size_t> scatterOffsets(partitionCounts.size());
+        size_t offset = 0;
+        for (uint32_t p = 0; p < partitionCount; p++) {
+            partitionStarts[p] = offset;
+            for (uint32_t t = 0; t < threads; t++) {
+                scatterOffsets[static_cast<size_t>(t) * partitionCount + p] = offset;
+                offset += partitionCounts[static_cast<size_t>(t) * partitionCount + p];
+            }
+        }
+        partitionStarts[partitionCount] = offset;
+        std::vector<uint32_t> partitionCorners(cornerCount);
+        parallelFor(cornerCount, threads, [&](uint32_t t, size_t begin, size_t end) {
+            size_t* offsets = &scatterOffsets[static_cast<size_t>(t) * partitionCount];
+            for (size_t corner = begin; corner < end; corner++) {
+                partitionCorners[offsets[getPartition(hashes[corner], partitionCount)]++] = static_cast<uint32_t>(corner);
+            }
+        });
+
+        // each partition finds the first corner equal to each of its corners, with linear probing
+        std::vector<uint32_t> firstCorners(cornerCount);
+        parallelFor(partitionCount, partitionCount, [&](uint32_t, size_t begin, size_t end) {
+            for (size_t p = begin; p < end; p++) {
+                size_t count = partitionStarts[p + 1] - partitionStarts[p];
+                size_t capacity = 16;
+                while (capacity < count * 2) {
+                    capacity *= 2;
+                }
+                std::vector<uint32_t> table(capacity, EMPTY_SLOT);
+                size_t mask = capacity - 1;
+                for (size_t i = partitionStarts[p]; i < partitionStarts[p + 1]; i++) {
+                    uint32_t corner = partitionCorners[i];
+                    uint64_t hash = hashes[corner];
+                    size_t slot = static_cast<size_t>(hash) & mask;
+                    while (true) {
+                        uint32_t candidate = table[slot];
+                        if (candidate == EMPTY_SLOT) {
+                            table[slot] = corner;
+                            firstCorners[corner] = corner;
+                            break;
+                        }
+                        if (hashes[candidate] == hash && corners[candidate] == corners[corner]) {
+                            firstCorners[corner] = candidate;
+                            break;
+                        }
+                        slot = (slot + 1) & mask;
+                    }
+                }
+            }
+        });
+
+        // the first corner of a vertex always comes before the others, the numbering follows the corner order
+        vertices.clear();
+        indices.resize(cornerCount);
+        for (size_t corner = 0; corner < cornerCount; corner++) {
+            uint32_t first = firstCorners[corner];
+            if (first == corner) {
+                indices[corner] = static_cast<uint32_t>(vertices.size());
+                vertices.push_back(corners[corner]);
+            } else {
+                indices[corner] = indices[first];
+            }
+        }
+    }
+}  // namespace lve
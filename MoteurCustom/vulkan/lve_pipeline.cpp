@@ -6,13 +6,14 @@
 #include <cassert>
 
 namespace lve {
-    LvePipeline::LvePipeline(LveDevice& device, const std::string& vertFilePath, const std::string& fragFilePath, const PipeLineConfigInfo& configInfo) : lveDevice{ device } {
-        createGraphicsPipeline(vertFilePath, fragFilePath, configInfo);
+    LvePipeline::LvePipeline(LveDevice& device, const std::string& vertFilePath, const std::string& fragFilePath, const PipeLineConfigInfo& configInfo)
+        : lveDevice{ device }, vertFilePath{ vertFilePath }, fragFilePath{ fragFilePath } {
+        assert(configInfo.pipelineLayout != VK_NULL_HANDLE && "Cannot create graphics pipeline: no pipelineLayout provided in configInfo");
+        assert(configInfo.renderPass != VK_NULL_HANDLE && "Cannot create graphics pipeline: no renderPass provided in configInfo");
+        copyPipeLineConfigInfo(configInfo, this->configInfo);
     }
     
     LvePipeline::~LvePipeline() {
-        vkDestroyShaderModule(lveDevice.getDevice(), vertShaderModule, nullptr);
-        vkDestroyShaderModule(lveDevice.getDevice(), fragShaderModule, nullptr);
         vkDestroyPipeline(lveDevice.getDevice(), graphicsPipeline, nullptr);
     }
     
@@ -36,16 +37,7 @@ namespace lve {
         return buffer;
     }
     
-    void LvePipeline::createGraphicsPipeline(const std::string& vertFilepath, const std::string& fragFilepath, const PipeLineConfigInfo& configInfo) {
-        assert(configInfo.pipelineLayout != VK_NULL_HANDLE && "Cannot create graphics pipeline: no pipelineLayout provided in configInfo");
-        assert(configInfo.renderPass != VK_NULL_HANDLE && "Cannot create graphics pipeline: no renderPass provided in configInfo");
-
-        auto vertCode = readFile(vertFilepath);
-        auto fragCode = readFile(fragFilepath);
-
-        createShaderModule(vertCode, &vertShaderModule);
-        createShaderModule(fragCode, &fragShaderModule);
-
+    VkPipeline LvePipeline::createGraphicsPipeline(VkShaderModule vertShaderModule, VkShaderModule fragShaderModule) const {
         VkPipelineShaderStageCreateInfo shaderStages[2];
         shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
         shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
@@ -91,20 +83,31 @@ namespace lve {
         pipelineInfo.basePipelineIndex = -1;
         pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-        if (vkCreateGraphicsPipelines(lveDevice.getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
+        // the pipeline cache is internally synchronized, several threads may build pipelines at once
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        if (vkCreateGraphicsPipelines(lveDevice.getDevice(), lveDevice.getPipelineCache(), 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
             throw std::runtime_error("failed to create graphics pipeline");
         }
+        return pipeline;
+    }
+
+    VkPipeline LvePipeline::setGraphicsPipeline(VkPipeline pipeline) {
+        VkPipeline previous = graphicsPipeline;
+        graphicsPipeline = pipeline;
+        return previous;
     }
     
-    void LvePipeline::createShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule) {
+    VkShaderModule LvePipeline::createShaderModule(LveDevice& device, const std::vector<char>& code) {
         VkShaderModuleCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
         createInfo.codeSize = code.size();
         createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
 
-        if (vkCreateShaderModule(lveDevice.getDevice(), &createInfo, nullptr, shaderModule) != VK_SUCCESS) {
+        VkShaderModule shaderModule = VK_NULL_HANDLE;
+        if (vkCreateShaderModule(device.getDevice(), &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
             throw std::runtime_error("failed to create shader module");
         }
+        return shaderModule;
     }
     
     void LvePipeline::bind(VkCommandBuffer(commandBuffer)) {
@@ -183,6 +186,27 @@ namespace lve {
         configInfo.attributeDescriptions = LveModel::Vertex::getAttributeDescriptions();
     }
     
+    void LvePipeline::copyPipeLineConfigInfo(const PipeLineConfigInfo& source, PipeLineConfigInfo& destination) {
+        destination.bindingDescriptions = source.bindingDescriptions;
+        destination.attributeDescriptions = source.attributeDescriptions;
+        destination.viewportInfo = source.viewportInfo;
+        destination.inputAssemblyInfo = source.inputAssemblyInfo;
+        destination.rasterizationInfo = source.rasterizationInfo;
+        destination.multisampleInfo = source.multisampleInfo;
+        destination.colorBlendAttachment = source.colorBlendAttachment;
+        destination.colorBlendInfo = source.colorBlendInfo;
+        destination.depthStencilInfo = source.depthStencilInfo;
+        destination.dynamicStateEnables = source.dynamicStateEnables;
+        destination.dynamicStateInfo = source.dynamicStateInfo;
+        destination.pipelineLayout = source.pipelineLayout;
+        destination.renderPass = source.renderPass;
+        destination.subpass = source.subpass;
+
+        destination.colorBlendInfo.pAttachments = &destination.colorBlendAttachment;
+        destination.dynamicStateInfo.pDynamicStates = destination.dynamicStateEnables.data();
+        destination.dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(destination.dynamicStateEnables.size());
+    }
+
     void LvePipeline::enableAlphaBlending(PipeLineConfigInfo& configInfo) {
         configInfo.colorBlendAttachment.blendEnable = VK_TRUE;
         configInfo.colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
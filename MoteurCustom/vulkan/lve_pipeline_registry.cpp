@@ -0,0 +1,457 @@
+#include "lve_pipeline_registry.hpp"
+#include "lve_swap_chain.hpp"
+#include "lve_utils.hpp"
+
+//std
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace lve {
+    namespace {
+        constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+
+        /**
+         * @brief Appends a Vulkan handle to a key, as two words.
+         * @param words : The words of the key.
+         * @param handle : The handle (a pointer or a 64 bit integer depending on the platform).
+        */
+        template <typename T>
+        void appendHandle(std::vector<uint32_t>& words, T handle) {
+            uint64_t value = 0;
+            std::memcpy(&value, &handle, sizeof(handle));
+            words.push_back(static_cast<uint32_t>(value));
+            words.push_back(static_cast<uint32_t>(value >> 32));
+        }
+
+        /**
+         * @brief Checks that file content can be SPIR-V, so that a file caught half written is not given to the driver.
+         * @param code : The content of the file.
+         * @return True if the content is made of words and starts with the SPIR-V magic number.
+        */
+        bool isSpirv(const std::vector<char>& code) {
+            uint32_t magic = 0;
+            if (code.size() < 5 * sizeof(uint32_t) || code.size() % sizeof(uint32_t) != 0) {
+                return false;
+            }
+            std::memcpy(&magic, code.data(), sizeof(magic));
+            return magic == SPIRV_MAGIC;
+        }
+    }
+
+    std::size_t LvePipelineRegistry::KeyHash::operator()(const Key& key) const {
+        std::size_t seed = 0;
+        hashCombine(seed, key.vertFilePath, key.fragFilePath);
+        for (uint32_t word : key.config) {
+            hashCombine(seed, word);
+        }
+        return seed;
+    }
+
+    LvePipelineRegistry::LvePipelineRegistry(LveDevice& device) : lveDevice{ device } {}
+
+    LvePipelineRegistry::~LvePipelineRegistry() {
+        setHotReload(false);
+        {
+            std::lock_guard<std::mutex> lock{ mutex };
+            stopCompilers = true;
+        }
+        buildCondition.notify_all();
+        for (std::thread& compiler : compilers) {
+            compiler.join();
+        }
+        assert(pipelines.empty() && "Every pipeline must be released before the registry");
+        for (const PendingSwap& pendingSwap : pendingSwaps) {
+            vkDestroyPipeline(lveDevice.getDevice(), pendingSwap.graphicsPipeline, nullptr);
+        }
+        for (const RetiredPipeline& retiredPipeline : retiredPipelines) {
+            vkDestroyPipeline(lveDevice.getDevice(), retiredPipeline.graphicsPipeline, nullptr);
+        }
+        for (auto& [path, shaderModule] : shaderModules) {
+            vkDestroyShaderModule(lveDevice.getDevice(), shaderModule.module, nullptr);
+        }
+    }
+
+    LvePipelineRegistry::Key LvePipelineRegistry::makeKey(const std::string& vertFilePath, const std::string& fragFilePath, const PipeLineConfigInfo& configInfo) {
+        Key key{ vertFilePath, fragFilePath, {} };
+        std::vector<uint32_t>& words = key.config;
+        auto addFloat = [&](float value) {
+            uint32_t bits = 0;
+            std::memcpy(&bits, &value, sizeof(bits));
+            words.push_back(bits);
+        };
+
+        // the fields read by LvePipeline::createGraphicsPipeline, the pointers are left out
+        words.push_back(static_cast<uint32_t>(configInfo.bindingDescriptions.size()));
+        for (const auto& binding : configInfo.bindingDescriptions) {
+            words.insert(words.end(), { binding.binding, binding.stride, static_cast<uint32_t>(binding.inputRate) });
+        }
+        words.push_back(static_cast<uint32_t>(configInfo.attributeDescriptions.size()));
+        for (const auto& attribute : configInfo.attributeDescriptions) {
+            words.insert(words.end(), { attribute.location, attribute.binding, static_cast<uint32_t>(attribute.format), attribute.offset });
+        }
+        words.insert(words.end(), { static_cast<uint32_t>(configInfo.inputAssemblyInfo.topology), configInfo.inputAssemblyInfo.primitiveRestartEnable });
+        words.insert(words.end(), { configInfo.viewportInfo.viewportCount, configInfo.viewportInfo.scissorCount });
+
+        const auto& rasterization = configInfo.rasterizationInfo;
+        words.insert(words.end(), { rasterization.depthClampEnable, rasterization.rasterizerDiscardEnable, static_cast<uint32_t>(rasterization.polygonMode),
+            rasterization.cullMode, static_cast<uint32_t>(rasterization.frontFace), rasterization.depthBiasEnable });
+        addFloat(rasterization.depthBiasConstantFactor);
+        addFloat(rasterization.depthBiasClamp);
+        addFloat(rasterization.depthBiasSlopeFactor);
+        addFloat(rasterization.lineWidth);
+
+        const auto& multisample = configInfo.multisampleInfo;
+        words.insert(words.end(), { static_cast<uint32_t>(multisample.rasterizationSamples), multisample.sampleShadingEnable, multisample.alphaToCoverageEnable, multisample.alphaToOneEnable });
+        addFloat(multisample.minSampleShading);
+
+        const auto& blend = configInfo.colorBlendAttachment;
+        words.insert(words.end(), { blend.blendEnable, static_cast<uint32_t>(blend.srcColorBlendFactor), static_cast<uint32_t>(blend.dstColorBlendFactor), static_cast<uint32_t>(blend.colorBlendOp),
+            static_cast<uint32_t>(blend.srcAlphaBlendFactor), static_cast<uint32_t>(blend.dstAlphaBlendFactor), static_cast<uint32_t>(blend.alphaBlendOp), blend.colorWriteMask });
+        words.insert(words.end(), { configInfo.colorBlendInfo.logicOpEnable, static_cast<uint32_t>(configInfo.colorBlendInfo.logicOp), configInfo.colorBlendInfo.attachmentCount });
+        for (float constant : configInfo.colorBlendInfo.blendConstants) {
+            addFloat(constant);
+        }
+
+        const auto& depthStencil = configInfo.depthStencilInfo;
+        words.insert(words.end(), { depthStencil.depthTestEnable, depthStencil.depthWriteEnable, static_cast<uint32_t>(depthStencil.depthCompareOp),
+            depthStencil.depthBoundsTestEnable, depthStencil.stencilTestEnable });
+        addFloat(depthStencil.minDepthBounds);
+        addFloat(depthStencil.maxDepthBounds);
+        for (const VkStencilOpState& stencil : { depthStencil.front, depthStencil.back }) {
+            words.insert(words.end(), { static_cast<uint32_t>(stencil.failOp), static_cast<uint32_t>(stencil.passOp), static_cast<uint32_t>(stencil.depthFailOp),
+                static_cast<uint32_t>(stencil.compareOp), stencil.compareMask, stencil.writeMask, stencil.reference });
+        }
+
+        words.push_back(static_cast<uint32_t>(configInfo.dynamicStateEnables.size()));
+        for (VkDynamicState state : configInfo.dynamicStateEnables) {
+            words.push_back(static_cast<uint32_t>(state));
+        }
+        appendHandle(words, configInfo.pipelineLayout);
+        appendHandle(words, configInfo.renderPass);
+        words.push_back(configInfo.subpass);
+        return key;
+    }
+
+    std::shared_ptr<LvePipeline> LvePipelineRegistry::getPipeline(const std::string& vertFilePath, const std::string& fragFilePath, const PipeLineConfigInfo& configInfo) {
+        Key key = makeKey(vertFilePath, fragFilePath, configInfo);
+        std::lock_guard<std::mutex> buildLock{ buildMutex };
+        if (auto pipeline = findPipeline(key)) {
+            return pipeline;
+        }
+
+        acquireShaderModules(vertFilePath, fragFilePath);
+        auto pipeline = std::make_unique<LvePipeline>(lveDevice, vertFilePath, fragFilePath, configInfo);
+        try {
+            pipeline->setGraphicsPipeline(pipeline->createGraphicsPipeline(shaderModules.at(vertFilePath).module, shaderModules.at(fragFilePath).module));
+        } catch (...) {
+            releaseShaderModule(vertFilePath);
+            releaseShaderModule(fragFilePath);
+            throw;
+        }
+        return addPipeline(std::move(key), pipeline.release());
+    }
+
+    std::shared_ptr<LvePipeline> LvePipelineRegistry::requestPipeline(const std::string& vertFilePath, const std::string& fragFilePath, const PipeLineConfigInfo& configInfo) {
+        Key key = makeKey(vertFilePath, fragFilePath, configInfo);
+        std::lock_guard<std::mutex> buildLock{ buildMutex };
+        if (auto pipeline = findPipeline(key)) {
+            return pipeline;
+        }
+
+        if (compilers.empty()) {
+            // the calling thread keeps recording frames
+            uint32_t threadCount = std::clamp(std::thread::hardware_concurrency(), 2u, MAX_COMPILER_THREADS + 1) - 1;
+            for (uint32_t i = 0; i < threadCount; i++) {
+                compilers.emplace_back(&LvePipelineRegistry::compilePipelines, this);
+            }
+        }
+        acquireShaderModules(vertFilePath, fragFilePath);
+        std::shared_ptr<LvePipeline> pipeline = addPipeline(std::move(key), new LvePipeline(lveDevice, vertFilePath, fragFilePath, configInfo));
+        {
+            std::lock_guard<std::mutex> lock{ mutex };
+            buildQueue.push_back(pipeline.get());
+        }
+        buildCondition.notify_all();
+        return pipeline;
+    }
+
+    std::shared_ptr<LvePipeline> LvePipelineRegistry::findPipeline(const Key& key) {
+        std::lock_guard<std::mutex> lock{ mutex };
+        auto it = pipelines.find(key);
+        if (it == pipelines.end()) {
+            return nullptr;
+        }
+        // an expired pipeline is being released, the caller replaces it
+        auto pipeline = it->second.pipeline.lock();
+        if (pipeline != nullptr) {
+            sharedRequestCount++;
+        }
+        return pipeline;
+    }
+
+    std::shared_ptr<LvePipeline> LvePipelineRegistry::addPipeline(Key key, LvePipeline* pipeline) {
+        std::shared_ptr<LvePipeline> sharedPipeline{ pipeline, [this](LvePipeline* released) { releasePipeline(released); } };
+        std::lock_guard<std::mutex> lock{ mutex };
+        pipelines[std::move(key)] = { sharedPipeline, pipeline };
+        return sharedPipeline;
+    }
+
+    void LvePipelineRegistry::acquireShaderModules(const std::string& vertFilePath, const std::string& fragFilePath) {
+        acquireShaderModule(vertFilePath);
+        try {
+            acquireShaderModule(fragFilePath);
+        } catch (...) {
+            releaseShaderModule(vertFilePath);
+            throw;
+        }
+    }
+
+    void LvePipelineRegistry::compilePipelines() {
+        std::unique_lock<std::mutex> lock{ mutex };
+        while (true) {
+            buildCondition.wait(lock, [this]() { return stopCompilers || !buildQueue.empty(); });
+            if (stopCompilers) {
+                return;
+            }
+
+            // releasePipeline waits for a pipeline being compiled, and its shader modules are not reloaded meanwhile
+            LvePipeline* pipeline = buildQueue.front();
+            buildQueue.pop_front();
+            compilingPipelines.push_back(pipeline);
+            VkShaderModule vertShaderModule = shaderModules.at(pipeline->getVertFilePath()).module;
+            VkShaderModule fragShaderModule = shaderModules.at(pipeline->getFragFilePath()).module;
+            lock.unlock();
+
+            VkPipeline graphicsPipeline = VK_NULL_HANDLE;
+            std::exception_ptr error{};
+            try {
+                graphicsPipeline = pipeline->createGraphicsPipeline(vertShaderModule, fragShaderModule);
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            lock.lock();
+            compilingPipelines.erase(std::find(compilingPipelines.begin(), compilingPipelines.end(), pipeline));
+            if (graphicsPipeline != VK_NULL_HANDLE) {
+                pendingSwaps.push_back({ pipeline, graphicsPipeline });
+            } else if (buildError == nullptr) {
+                buildError = error;
+            }
+            buildCondition.notify_all();
+        }
+    }
+
+    void LvePipelineRegistry::waitForPipelines() {
+        std::unique_lock<std::mutex> lock{ mutex };
+        buildCondition.wait(lock, [this]() { return buildQueue.empty() && compilingPipelines.empty(); });
+    }
+
+    VkShaderModule LvePipelineRegistry::acquireShaderModule(const std::string& filePath) {
+        auto it = shaderModules.find(filePath);
+        if (it != shaderModules.end()) {
+            it->second.pipelineCount++;
+            return it->second.module;
+        }
+
+        ShaderModule shaderModule{};
+        std::error_code error;
+        shaderModule.writeTime = std::filesystem::last_write_time(filePath, error);
+        shaderModule.changedWriteTime = shaderModule.writeTime;
+        shaderModule.module = LvePipeline::createShaderModule(lveDevice, LvePipeline::readFile(filePath));
+        shaderModule.pipelineCount = 1;
+        std::lock_guard<std::mutex> lock{ mutex };
+        shaderModules.emplace(filePath, shaderModule);
+        return shaderModule.module;
+    }
+
+    void LvePipelineRegistry::releaseShaderModule(const std::string& filePath) {
+        auto it = shaderModules.find(filePath);
+        assert(it != shaderModules.end() && "Releasing a shader module that was not acquired");
+        if (--it->second.pipelineCount > 0) {
+            return;
+        }
+        vkDestroyShaderModule(lveDevice.getDevice(), it->second.module, nullptr);
+        std::lock_guard<std::mutex> lock{ mutex };
+        shaderModules.erase(it);
+    }
+
+    void LvePipelineRegistry::releasePipeline(LvePipeline* pipeline) {
+        std::lock_guard<std::mutex> buildLock{ buildMutex };
+        {
+            std::unique_lock<std::mutex> lock{ mutex };
+            for (auto it = pipelines.begin(); it != pipelines.end(); ++it) {
+                if (it->second.rawPipeline == pipeline) {
+                    pipelines.erase(it);
+                    break;
+                }
+            }
+            // a compiler thread may hold it, its result is destroyed below
+            buildQueue.erase(std::remove(buildQueue.begin(), buildQueue.end(), pipeline), buildQueue.end());
+            buildCondition.wait(lock, [&]() { return std::find(compilingPipelines.begin(), compilingPipelines.end(), pipeline) == compilingPipelines.end(); });
+
+            // a compilation or a rebuild not swapped in yet was never bound
+            size_t keptSwaps = 0;
+            for (const PendingSwap& pendingSwap : pendingSwaps) {
+                if (pendingSwap.pipeline == pipeline) {
+                    vkDestroyPipeline(lveDevice.getDevice(), pendingSwap.graphicsPipeline, nullptr);
+                } else {
+                    pendingSwaps[keptSwaps++] = pendingSwap;
+                }
+            }
+            pendingSwaps.resize(keptSwaps);
+        }
+        releaseShaderModule(pipeline->getVertFilePath());
+        releaseShaderModule(pipeline->getFragFilePath());
+        delete pipeline;
+    }
+
+    void LvePipelineRegistry::setHotReload(bool enabled) {
+        if (enabled && !watcher.joinable()) {
+            stopWatcher = false;
+            watcher = std::thread{ &LvePipelineRegistry::watchShaders, this };
+        } else if (!enabled && watcher.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock{ watcherMutex };
+                stopWatcher = true;
+            }
+            watcherCondition.notify_all();
+            watcher.join();
+        }
+    }
+
+    void LvePipelineRegistry::watchShaders() {
+        std::unique_lock<std::mutex> lock{ watcherMutex };
+        while (!watcherCondition.wait_for(lock, WATCH_INTERVAL, [this]() { return stopWatcher; })) {
+            lock.unlock();
+            reloadChangedShaders();
+            lock.lock();
+        }
+    }
+
+    void LvePipelineRegistry::reloadChangedShaders() {
+        std::lock_guard<std::mutex> buildLock{ buildMutex };
+        {
+            // the compiler threads use the current modules, the files are checked again once the requests are compiled
+            // (no request is added while the build mutex is locked)
+            std::lock_guard<std::mutex> lock{ mutex };
+            if (!buildQueue.empty() || !compilingPipelines.empty()) {
+                return;
+            }
+        }
+        for (auto& [path, shaderModule] : shaderModules) {
+            std::error_code error;
+            std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(path, error);
+            if (error || writeTime == shaderModule.writeTime) {
+                continue;
+            }
+            // a file being written keeps changing, it is read once its time has held for a whole interval
+            if (writeTime != shaderModule.changedWriteTime) {
+                shaderModule.changedWriteTime = writeTime;
+                continue;
+            }
+            shaderModule.writeTime = writeTime;
+
+            VkShaderModule newModule = VK_NULL_HANDLE;
+            try {
+                std::vector<char> code = LvePipeline::readFile(path);
+                if (!isSpirv(code)) {
+                    throw std::runtime_error("not a SPIR-V file");
+                }
+                newModule = LvePipeline::createShaderModule(lveDevice, code);
+            } catch (const std::exception& e) {
+                std::cerr << "failed to reload shader " << path << ": " << e.what() << "\n";
+                continue;
+            }
+
+            // every pipeline using the file is built again, or none if one fails
+            std::vector<PendingSwap> rebuilt{};
+            try {
+                for (const auto& [key, entry] : pipelines) {
+                    const LvePipeline& pipeline = *entry.rawPipeline;
+                    bool vertChanged = pipeline.getVertFilePath() == path;
+                    bool fragChanged = pipeline.getFragFilePath() == path;
+                    if (!vertChanged && !fragChanged) continue;
+
+                    VkShaderModule vertShaderModule = vertChanged ? newModule : shaderModules.at(pipeline.getVertFilePath()).module;
+                    VkShaderModule fragShaderModule = fragChanged ? newModule : shaderModules.at(pipeline.getFragFilePath()).module;
+                    rebuilt.push_back({ entry.rawPipeline, pipeline.createGraphicsPipeline(vertShaderModule, fragShaderModule) });
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "failed to rebuild the pipelines of " << path << ": " << e.what() << "\n";
+                for (const PendingSwap& pendingSwap : rebuilt) {
+                    vkDestroyPipeline(lveDevice.getDevice(), pendingSwap.graphicsPipeline, nullptr);
+                }
+                vkDestroyShaderModule(lveDevice.getDevice(), newModule, nullptr);
+                continue;
+            }
+
+            // the pipelines built from the old module no longer need it
+            vkDestroyShaderModule(lveDevice.getDevice(), shaderModule.module, nullptr);
+            shaderModule.module = newModule;
+            {
+                std::lock_guard<std::mutex> lock{ mutex };
+                for (const PendingSwap& swap : rebuilt) {
+                    // an older rebuild of the same pipeline was never bound
+                    for (PendingSwap& pendingSwap : pendingSwaps) {
+                        if (pendingSwap.pipeline == swap.pipeline) {
+                            vkDestroyPipeline(lveDevice.getDevice(), pendingSwap.graphicsPipeline, nullptr);
+                            pendingSwap.pipeline = nullptr;
+                        }
+                    }
+                    pendingSwaps.push_back(swap);
+                }
+                pendingSwaps.erase(std::remove_if(pendingSwaps.begin(), pendingSwaps.end(), [](const PendingSwap& pendingSwap) { return pendingSwap.pipeline == nullptr; }), pendingSwaps.end());
+                reloadCount += static_cast<uint32_t>(rebuilt.size());
+            }
+            std::cout << "Reloaded shader " << path << ", " << rebuilt.size() << " pipelines rebuilt" << std::endl;
+        }
+    }
+
+    std::unique_lock<std::mutex> LvePipelineRegistry::pauseBuilds() {
+        std::unique_lock<std::mutex> buildLock{ buildMutex };
+        // no request is queued while the build mutex is held, the compiler threads only finish the queue
+        waitForPipelines();
+        return buildLock;
+    }
+
+    void LvePipelineRegistry::beginFrame() {
+        std::lock_guard<std::mutex> lock{ mutex };
+        frameCount++;
+        if (buildError != nullptr) {
+            std::exception_ptr error = buildError;
+            buildError = nullptr;
+            std::rethrow_exception(error);
+        }
+
+        // the fence of the frame that last bound them has been waited on
+        size_t destroyed = 0;
+        while (destroyed < retiredPipelines.size() && retiredPipelines[destroyed].frame + LveSwapChain::MAX_FRAMES_IN_FLIGHT <= frameCount) {
+            vkDestroyPipeline(lveDevice.getDevice(), retiredPipelines[destroyed++].graphicsPipeline, nullptr);
+        }
+        retiredPipelines.erase(retiredPipelines.begin(), retiredPipelines.begin() + destroyed);
+
+        // a swap between two frames, so that the draws of a frame all use the same pipeline
+        for (const PendingSwap& pendingSwap : pendingSwaps) {
+            // a newly compiled pipeline replaces nothing
+            VkPipeline previous = pendingSwap.pipeline->setGraphicsPipeline(pendingSwap.graphicsPipeline);
+            if (previous != VK_NULL_HANDLE) {
+                retiredPipelines.push_back({ previous, frameCount });
+            }
+        }
+        pendingSwaps.clear();
+    }
+
+    LvePipelineRegistryStats LvePipelineRegistry::getStats() const {
+        std::lock_guard<std::mutex> lock{ mutex };
+        LvePipelineRegistryStats stats{};
+        stats.pipelineCount = static_cast<uint32_t>(pipelines.size());
+        stats.shaderModuleCount = static_cast<uint32_t>(shaderModules.size());
+        stats.sharedRequestCount = sharedRequestCount;
+        stats.reloadCount = reloadCount;
+        stats.pendingBuildCount = static_cast<uint32_t>(buildQueue.size() + compilingPipelines.size());
+        return stats;
+    }
+}  // namespace lve
@@ -1,4 +1,5 @@
 #include "lve_renderer.hpp"
+#include "lve_pipeline_registry.hpp"
 
 #include <stdexcept>
 #include <array>
@@ -25,7 +26,9 @@ namespace lve {
             extent = lveWindow.getExtent();
             glfwWaitEvents();
         }
-        vkDeviceWaitIdle(lveDevice.getDevice());
+        // no reload nor compiler thread may build with the render pass until the new swap chain has taken it over
+        auto buildPause = lveDevice.getPipelineRegistry().pauseBuilds();
+        lveDevice.waitIdle();
         //lveSwapChain = nullptr;
         if (lveSwapChain == nullptr) {
             lveSwapChain = std::make_unique<LveSwapChain>(lveDevice, extent);
@@ -1,11 +1,16 @@
 #include "lve_simple_render_system.hpp"
+#include "lve_swap_chain.hpp"
+#include "lve_mesh_simplifier.hpp"
+#include "lve_pipeline_registry.hpp"
 
 #include <stdexcept>
 #include <array>
 #include <iostream>
 #include <ctime>
 #include <chrono>
+#include <string>
 #include <vector>
+#include <cstddef>
 
 #include "glm/glm.hpp"
 #include "glm/gtc/constants.hpp"
@@ -13,30 +18,47 @@
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 
-#define MS_PER_UPDATE 0.016 // 1/60
-
 namespace lve {
-    struct SimplePushConstantData {
-        glm::mat4 modelMatrix{ 1.f };
-        glm::mat4 normalMatrix{ 1.f };
-    };
-    
-    SimpleRenderSystem::SimpleRenderSystem(LveDevice& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout) : lveDevice{ device } {
+    std::vector<VkVertexInputBindingDescription> SimpleInstanceData::getBindingDescriptions() {
+        std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
+        bindingDescriptions[0].binding = 1;
+        bindingDescriptions[0].stride = sizeof(SimpleInstanceData);
+        bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+        return bindingDescriptions;
+    }
+
+    std::vector<VkVertexInputAttributeDescription> SimpleInstanceData::getAttributeDescriptions() {
+        // a mat4 attribute takes one location per column
+        std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
+        for (uint32_t column = 0; column < 4; column++) {
+            attributeDescriptions.push_back({ 4 + column, 1, VK_FORMAT_R32G32B32A32_SFLOAT, static_cast<uint32_t>(offsetof(SimpleInstanceData, modelMatrix) + column * sizeof(glm::vec4)) });
+        }
+        for (uint32_t column = 0; column < 4; column++) {
+            attributeDescriptions.push_back({ 8 + column, 1, VK_FORMAT_R32G32B32A32_SFLOAT, static_cast<uint32_t>(offsetof(SimpleInstanceData, normalMatrix) + column * sizeof(glm::vec4)) });
+        }
+        return attributeDescriptions;
+    }
+
+    SimpleRenderSystem::SimpleRenderSystem(LveDevice& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout, LveModel::VertexFormat vertexFormat) : lveDevice{ device }, renderPass{ renderPass } {
         createPipelineLayout(globalSetLayout);
-        createPipeline(renderPass);
+        createPipeline(vertexFormat);
+        instanceBuffers.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
     }
     
     SimpleRenderSystem::~SimpleRenderSystem() {
+        // a reload may be building the pipelines with the layout, they are released first
+        lvePipelines = {};
         vkDestroyPipelineLayout(lveDevice.getDevice(), pipelineLayout, nullptr);
     }
     
     void SimpleRenderSystem::createPipelineLayout(VkDescriptorSetLayout globalSetLayout) {
+        std::vector<VkDescriptorSetLayout> descriptorSetLayouts{ globalSetLayout };
+
+        // only read by the compact vertex shader
         VkPushConstantRange pushConstantRange{};
-        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
         pushConstantRange.offset = 0;
-        pushConstantRange.size = sizeof(SimplePushConstantData);
-
-        std::vector<VkDescriptorSetLayout> descriptorSetLayouts{ globalSetLayout };
+        pushConstantRange.size = sizeof(LveModel::VertexDecode);
 
         VkPipelineLayoutCreateInfo pipelineLayoutinfo{};
         pipelineLayoutinfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
@@ -55,33 +77,263 @@ namespace lve {
         return duration_in_seconds.count();
     }
     
-    void SimpleRenderSystem::createPipeline(VkRenderPass renderPass) {
+    void SimpleRenderSystem::createPipeline(LveModel::VertexFormat vertexFormat) {
         assert(pipelineLayout != nullptr && "Cannot create pipeline pipeline before pipeline layout");
 
         PipeLineConfigInfo pipelineConfig{};
         LvePipeline::defaultPipeLineConfigInfo(pipelineConfig);
+        std::string vertFilePath = "./shaders/SPIR-V/simple_shader.vert.spv";
+        if (vertexFormat == LveModel::VertexFormat::Compact) {
+            pipelineConfig.bindingDescriptions = LveModel::CompactVertex::getBindingDescriptions();
+            pipelineConfig.attributeDescriptions = LveModel::CompactVertex::getAttributeDescriptions();
+            vertFilePath = "./shaders/SPIR-V/simple_shader_compact.vert.spv";
+        }
+        auto instanceBindings = SimpleInstanceData::getBindingDescriptions();
+        auto instanceAttributes = SimpleInstanceData::getAttributeDescriptions();
+        pipelineConfig.bindingDescriptions.insert(pipelineConfig.bindingDescriptions.end(), instanceBindings.begin(), instanceBindings.end());
+        pipelineConfig.attributeDescriptions.insert(pipelineConfig.attributeDescriptions.end(), instanceAttributes.begin(), instanceAttributes.end());
         pipelineConfig.renderPass = renderPass;
         pipelineConfig.pipelineLayout = pipelineLayout;
-        lvePipeline = std::make_unique<LvePipeline>(lveDevice, "./shaders/SPIR-V/simple_shader.vert.spv", "./shaders/SPIR-V/simple_shader.frag.spv", pipelineConfig);
+        backFaceCulling = (pipelineConfig.rasterizationInfo.cullMode & VK_CULL_MODE_BACK_BIT) != 0;
+        lvePipelines[static_cast<size_t>(vertexFormat)] = lveDevice.getPipelineRegistry().requestPipeline(vertFilePath, "./shaders/SPIR-V/simple_shader.frag.spv", pipelineConfig);
+    }
+
+    bool SimpleRenderSystem::bindModel(VkCommandBuffer commandBuffer, LveModel& model) {
+        LveModel::VertexFormat vertexFormat = model.getVertexFormat();
+        auto& pipeline = lvePipelines[static_cast<size_t>(vertexFormat)];
+        if (pipeline == nullptr) {
+            createPipeline(vertexFormat);
+        }
+        if (!pipeline->isReady()) {
+            // the other vertex format reads other attributes, the model waits for its own pipeline
+            return false;
+        }
+        // the pipelines share their layout, the descriptor sets stay bound
+        if (boundPipeline != pipeline.get()) {
+            pipeline->bind(commandBuffer);
+            boundPipeline = pipeline.get();
+        }
+        if (vertexFormat == LveModel::VertexFormat::Compact) {
+            vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(LveModel::VertexDecode), &model.getVertexDecode());
+        }
+        // the models of one geometry block share its buffers, the draws select their ranges
+        uint32_t block = model.getGeometryRange().block;
+        if (block != boundBlock || model.getIndexType() != boundIndexType) {
+            model.bind(commandBuffer);
+            boundBlock = block;
+            boundIndexType = model.getIndexType();
+        }
+        return true;
     }
     
+    LveBuffer& SimpleRenderSystem::getInstanceBuffer(int frameIndex, uint32_t instanceCount) {
+        auto& instanceBuffer = instanceBuffers[frameIndex];
+        if (instanceBuffer == nullptr || instanceBuffer->getInstanceCount() < instanceCount) {
+            // the fence of this frame has been waited on in beginFrame, the old buffer is no longer in use
+            uint32_t capacity = instanceBuffer == nullptr ? 64 : instanceBuffer->getInstanceCount();
+            while (capacity < instanceCount) {
+                capacity *= 2;
+            }
+            instanceBuffer = std::make_unique<LveBuffer>(lveDevice, sizeof(SimpleInstanceData), capacity, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+            instanceBuffer->map();
+        }
+        return *instanceBuffer;
+    }
+
+    void SimpleRenderSystem::setGpuDriven(bool enabled) {
+        if (enabled && !gpuDriven) {
+            if (gpuCulling == nullptr) {
+                gpuCulling = std::make_unique<LveGpuCulling>(lveDevice);
+            }
+            // the CPU path cleared the dirty flags without updating the GPU copies
+            gpuCulling->invalidate();
+        }
+        gpuDriven = enabled;
+    }
+
+    void SimpleRenderSystem::cullGameObjects(FrameInfo& frameInfo) {
+        if (gpuDriven) {
+            gpuCulling->cull(frameInfo, frustumCulling);
+        }
+    }
+
     void SimpleRenderSystem::renderGameObjects(FrameInfo& frameInfo) {
-        lvePipeline->bind(frameInfo.commandBuffer);
+        stats = {};
+
+        // bindModel binds the pipeline of the first model, the descriptor sets only need the shared layout
+        boundPipeline = nullptr;
+        boundBlock = UINT32_MAX;
+        if (gpuDriven) {
+            vkCmdBindDescriptorSets(frameInfo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &frameInfo.globalDescriptorSet, 0, nullptr);
+            gpuCulling->draw(frameInfo, [&](LveModel& model) { return bindModel(frameInfo.commandBuffer, model); });
+            stats.objectCount = gpuCulling->getObjectCount();
+            stats.visibleCount = gpuCulling->getVisibleCount();
+            stats.drawCount = gpuCulling->getDrawCount();
+            return;
+        }
+
+        // rebuild the matrices of every moved object at once, the culling needs them
+        transformBatch.clear();
+        dirtyTransforms.clear();
+        frameInfo.registry.each<ModelComponent, TransformComponent>([&](LveGameObject::id_t, ModelComponent& model, TransformComponent& transform) {
+            if (model.model == nullptr) return;
+
+            stats.objectCount++;
+            if (transform.isDirty()) {
+                transformBatch.add(transform.getInterpolatedTranslation(), transform.getInterpolatedRotation(), transform.getInterpolatedScale());
+                dirtyTransforms.push_back(&transform);
+            }
+        });
+        if (!dirtyTransforms.empty()) {
+            batchModelMatrices.resize(dirtyTransforms.size());
+            batchNormalMatrices.resize(dirtyTransforms.size());
+            transformBatch.computeMatrices(batchModelMatrices.data(), batchNormalMatrices.data());
+            for (size_t i = 0; i < dirtyTransforms.size(); i++) {
+                dirtyTransforms[i]->setCachedMatrices(batchModelMatrices[i], batchNormalMatrices[i]);
+            }
+        }
+
+        // group the visible objects by model and level of detail, one instanced draw per group
+        batches.clear();
+        batchLookup.clear();
+        objectBatches.clear();
+        visibleTransforms.clear();
+        LveFrustum frustum{};
+        if (frustumCulling) {
+            frustum = LveFrustum{ frameInfo.camera.getProjection() * frameInfo.camera.getView() };
+        }
+        frameInfo.registry.each<ModelComponent, TransformComponent>([&](LveGameObject::id_t, ModelComponent& model, TransformComponent& transform) {
+            if (model.model == nullptr || !model.model->isReady()) return;
+
+            if (frustumCulling && !frustum.intersectsAABB(LveFrustum::transformAABB(model.model->getBoundingBox(), transform.mat4()))) {
+                return;
+            }
+
+            uint32_t lod = selectLod(frameInfo.camera, *model.model, transform);
+            if (lod > 0) {
+                stats.simplifiedCount++;
+            }
+            auto [it, inserted] = batchLookup.try_emplace(std::pair{ model.model.get(), lod }, static_cast<uint32_t>(batches.size()));
+            if (inserted) {
+                batches.push_back({ model.model.get(), lod, 0, 0 });
+            }
+            batches[it->second].instanceCount++;
+            objectBatches.push_back(it->second);
+            visibleTransforms.push_back(&transform);
+        });
+        stats.visibleCount = static_cast<uint32_t>(visibleTransforms.size());
+        if (batches.empty()) {
+            return;
+        }
+
+        uint32_t instanceCount = 0;
+        for (auto& batch : batches) {
+            batch.firstInstance = instanceCount;
+            instanceCount += batch.instanceCount;
+            batch.instanceCount = 0;
+        }
+
+        LveBuffer& instanceBuffer = getInstanceBuffer(frameInfo.frameIndex, instanceCount);
+        auto instances = static_cast<SimpleInstanceData*>(instanceBuffer.getMappedMemory());
+        instanceTransforms.resize(instanceCount);
+        for (size_t i = 0; i < visibleTransforms.size(); i++) {
+            auto& batch = batches[objectBatches[i]];
+            uint32_t instanceIndex = batch.firstInstance + batch.instanceCount++;
+            auto& instance = instances[instanceIndex];
+            instance.modelMatrix = visibleTransforms[i]->mat4();
+            instance.normalMatrix = visibleTransforms[i]->normalMatrix();
+            instanceTransforms[instanceIndex] = visibleTransforms[i];
+        }
+        instanceBuffer.flush();
 
         vkCmdBindDescriptorSets(frameInfo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &frameInfo.globalDescriptorSet, 0, nullptr);
 
-        for (auto& kv : frameInfo.gameObjects) {
-            auto& obj = kv.second;
-            if (obj.model == nullptr) continue;
-            //obj.transform.rotation.y = glm::mod(obj.transform.rotation.y + 0.01f, glm::two_pi<float>());
-            //obj.transform.rotation.x = glm::mod(obj.transform.rotation.x + 0.005f, glm::two_pi<float>());
-            SimplePushConstantData push{};
-            push.modelMatrix = obj.transform.mat4();
-            push.normalMatrix = obj.transform.normalMatrix();
-
-            vkCmdPushConstants(frameInfo.commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(SimplePushConstantData), &push);
-            obj.model->bind(frameInfo.commandBuffer);
-            obj.model->draw(frameInfo.commandBuffer);
+        VkBuffer buffers[] = { instanceBuffer.getBuffer() };
+        VkDeviceSize offsets[] = { 0 };
+        vkCmdBindVertexBuffers(frameInfo.commandBuffer, 1, 1, buffers, offsets);
+
+        for (auto& batch : batches) {
+            if (!bindModel(frameInfo.commandBuffer, *batch.model)) continue;
+
+            if (batch.lod > 0) {
+                // the levels follow the full mesh in the index range of the model
+                const LveModel::Lod& lod = batch.model->getLods()[batch.lod];
+                batch.model->drawRange(frameInfo.commandBuffer, lod.firstIndex, lod.indexCount, batch.instanceCount, batch.firstInstance);
+                stats.drawCount++;
+                continue;
+            }
+            if (clusterCulling && !batch.model->getMeshlets().empty()) {
+                // each instance sees its own meshlets
+                for (uint32_t instance = batch.firstInstance; instance < batch.firstInstance + batch.instanceCount; instance++) {
+                    drawMeshlets(frameInfo, *batch.model, *instanceTransforms[instance], instance);
+                }
+                continue;
+            }
+            batch.model->draw(frameInfo.commandBuffer, batch.instanceCount, batch.firstInstance);
+            stats.drawCount++;
+        }
+    }
+
+    uint32_t SimpleRenderSystem::selectLod(const LveCamera& camera, const LveModel& model, TransformComponent& transform) const {
+        const std::vector<LveModel::Lod>& lods = model.getLods();
+        if (!lodSelection || lods.size() < 2) {
+            return 0;
+        }
+
+        // bounding sphere of the transformed box, the errors of the levels grow with the largest scale
+        const AABB& box = model.getBoundingBox();
+        glm::vec3 boxMin{ box.minX, box.minY, box.minZ };
+        glm::vec3 boxMax{ box.maxX, box.maxY, box.maxZ };
+        glm::vec3 scale = glm::abs(transform.getInterpolatedScale());
+        float maxScale = glm::max(scale.x, glm::max(scale.y, scale.z));
+        glm::vec3 center = glm::vec3(transform.mat4() * glm::vec4((boxMin + boxMax) * 0.5f, 1.f));
+        float radius = glm::length(boxMax - boxMin) * 0.5f * maxScale;
+
+        glm::vec3 toCamera = camera.getPosition() - center;
+        float distance = glm::length(toCamera);
+        if (distance <= radius) {
+            return 0;
+        }
+        // the nearest point of the sphere is where an error looks the largest
+        glm::vec3 nearest = center + toCamera * (radius / distance);
+        return LveMeshSimplifier::selectLod(lods, camera.getProjectedSize(maxScale, nearest), LOD_SCREEN_ERROR);
+    }
+
+    void SimpleRenderSystem::drawMeshlets(FrameInfo& frameInfo, LveModel& model, TransformComponent& transform, uint32_t instance) {
+        const glm::mat4& modelMatrix = transform.mat4();
+        LveFrustum frustum{};
+        if (frustumCulling) {
+            frustum = LveFrustum{ frameInfo.camera.getProjection() * frameInfo.camera.getView() * modelMatrix };
+        }
+        glm::vec3 cameraPosition = glm::vec3(glm::inverse(modelMatrix) * glm::vec4(frameInfo.camera.getPosition(), 1.f));
+        // a meshlet facing away is hidden only if the pipeline drops the back faces (the default one is two-sided),
+        // and the normal cones keep their angles only under a uniform scale without mirroring
+        glm::vec3 scale = transform.getInterpolatedScale();
+        bool coneCulling = backFaceCulling && scale.x > 0.f && scale.x == scale.y && scale.x == scale.z;
+
+        // consecutive visible meshlets are contiguous in the index buffer, they share a draw
+        uint32_t runFirstIndex = 0;
+        uint32_t runIndexCount = 0;
+        for (const LveModel::Meshlet& meshlet : model.getMeshlets()) {
+            stats.meshletCount++;
+            if (!frustum.intersectsSphere(meshlet.center, meshlet.radius) || (coneCulling && meshlet.isBackFacing(cameraPosition))) {
+                continue;
+            }
+            stats.visibleMeshletCount++;
+            if (runIndexCount > 0 && runFirstIndex + runIndexCount == meshlet.firstIndex) {
+                runIndexCount += meshlet.indexCount;
+                continue;
+            }
+            if (runIndexCount > 0) {
+                model.drawRange(frameInfo.commandBuffer, runFirstIndex, runIndexCount, 1, instance);
+                stats.drawCount++;
+            }
+            runFirstIndex = meshlet.firstIndex;
+            runIndexCount = meshlet.indexCount;
+        }
+        if (runIndexCount > 0) {
+            model.drawRange(frameInfo.commandBuffer, runFirstIndex, runIndexCount, 1, instance);
+            stats.drawCount++;
         }
     }
 
@@ -21,7 +21,11 @@ namespace lve {
     }
     
     void LveSwapChain::init() {
-        createSwapChain();
+        if (device.isHeadless()) {
+            createOffscreenImages();
+        } else {
+            createSwapChain();
+        }
         createImageViews();
         createRenderPass();
         createDepthResources();
@@ -40,10 +44,15 @@ namespace lve {
             swapChain = nullptr;
         }
 
+        for (int i = 0; i < offscreenImageMemorys.size(); i++) {
+            vkDestroyImage(device.getDevice(), swapChainImages[i], nullptr);
+            device.getAllocator().free(offscreenImageMemorys[i]);
+        }
+
         for (int i = 0; i < depthImages.size(); i++) {
             vkDestroyImageView(device.getDevice(), depthImageViews[i], nullptr);
             vkDestroyImage(device.getDevice(), depthImages[i], nullptr);
-            vkFreeMemory(device.getDevice(), depthImageMemorys[i], nullptr);
+            device.getAllocator().free(depthImageMemorys[i]);
         }
 
         for (auto framebuffer : swapChainFramebuffers) {
@@ -63,6 +72,12 @@ namespace lve {
     VkResult LveSwapChain::acquireNextImage(uint32_t* imageIndex) {
         vkWaitForFences(device.getDevice(), 1, &inFlightFences[currentFrame], VK_TRUE, std::numeric_limits<uint64_t>::max());
 
+        if (device.isHeadless()) {
+            // one offscreen image per frame in flight, the fence above guarantees it is no longer in use
+            *imageIndex = static_cast<uint32_t>(currentFrame);
+            return VK_SUCCESS;
+        }
+
         VkResult result = vkAcquireNextImageKHR(device.getDevice(), swapChain, std::numeric_limits<uint64_t>::max(), imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, imageIndex);
 
         return result;
@@ -77,6 +92,21 @@ namespace lve {
         VkSubmitInfo submitInfo = {};
         submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
+        if (device.isHeadless()) {
+            // nothing to acquire nor present, the fence alone paces the offscreen ring
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers = buffers;
+
+            vkResetFences(device.getDevice(), 1, &inFlightFences[currentFrame]);
+            auto queueLock = device.lockQueue(device.getGraphicsQueue());
+            if (vkQueueSubmit(device.getGraphicsQueue(), 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
+                throw std::runtime_error("failed to submit draw command buffer!");
+            }
+
+            currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+            return VK_SUCCESS;
+        }
+
         VkSemaphore waitSemaphores[] = { imageAvailableSemaphores[currentFrame] };
         VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
         submitInfo.waitSemaphoreCount = 1;
@@ -91,8 +121,12 @@ namespace lve {
         submitInfo.pSignalSemaphores = signalSemaphores;
 
         vkResetFences(device.getDevice(), 1, &inFlightFences[currentFrame]);
-        if (vkQueueSubmit(device.getGraphicsQueue(), 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
-            throw std::runtime_error("failed to submit draw command buffer!");
+        {
+            // the loader threads submit their uploads to this queue when the device has no transfer queue
+            auto queueLock = device.lockQueue(device.getGraphicsQueue());
+            if (vkQueueSubmit(device.getGraphicsQueue(), 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
+                throw std::runtime_error("failed to submit draw command buffer!");
+            }
         }
 
         VkPresentInfoKHR presentInfo = {};
@@ -107,7 +141,11 @@ namespace lve {
 
         presentInfo.pImageIndices = imageIndex;
 
-        auto result = vkQueuePresentKHR(device.getPresentQueue(), &presentInfo);
+        VkResult result;
+        {
+            auto queueLock = device.lockQueue(device.getPresentQueue());
+            result = vkQueuePresentKHR(device.getPresentQueue(), &presentInfo);
+        }
 
         currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
 
@@ -176,6 +214,34 @@ namespace lve {
         swapChainExtent = extent;
     }
     
+    void LveSwapChain::createOffscreenImages() {
+        swapChainImageFormat = VK_FORMAT_B8G8R8A8_SRGB;
+        swapChainExtent = windowExtent;
+
+        swapChainImages.resize(MAX_FRAMES_IN_FLIGHT);
+        offscreenImageMemorys.resize(MAX_FRAMES_IN_FLIGHT);
+
+        for (int i = 0; i < swapChainImages.size(); i++) {
+            VkImageCreateInfo imageInfo{};
+            imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageInfo.extent.width = swapChainExtent.width;
+            imageInfo.extent.height = swapChainExtent.height;
+            imageInfo.extent.depth = 1;
+            imageInfo.mipLevels = 1;
+            imageInfo.arrayLayers = 1;
+            imageInfo.format = swapChainImageFormat;
+            imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+            imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            imageInfo.flags = 0;
+
+            device.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, swapChainImages[i], offscreenImageMemorys[i]);
+        }
+    }
+
     void LveSwapChain::createImageViews() {
         swapChainImageViews.resize(swapChainImages.size());
         for (size_t i = 0; i < swapChainImages.size(); i++) {
@@ -197,6 +263,13 @@ namespace lve {
     }
     
     void LveSwapChain::createRenderPass() {
+        // the pipelines keep the render pass they were built with, it lives as long as the swap chain is recreated with the same formats
+        if (oldSwapChain != nullptr && oldSwapChain->swapChainImageFormat == swapChainImageFormat && oldSwapChain->swapChainDepthFormat == findDepthFormat()) {
+            renderPass = oldSwapChain->renderPass;
+            oldSwapChain->renderPass = VK_NULL_HANDLE;
+            return;
+        }
+
         VkAttachmentDescription depthAttachment{};
         depthAttachment.format = findDepthFormat();
         depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
@@ -219,7 +292,8 @@ namespace lve {
         colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
         colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        // offscreen images are never presented, keep them ready for a readback instead
+        colorAttachment.finalLayout = device.isHeadless() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
         VkAttachmentReference colorAttachmentRef = {};
         colorAttachmentRef.attachment = 0;
@@ -0,0 +1,198 @@
+#include "lve_transform_batch.hpp"
+
+//std
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LVE_TRANSFORM_SIMD
+#include <emmintrin.h>
+#endif
+
+namespace lve {
+    void computeTransformMatrices(const glm::vec3& translation, const glm::vec3& rotation, const glm::vec3& scale, glm::mat4& modelMatrix, glm::mat3& normalMatrix) {
+        const float c3 = glm::cos(rotation.z);
+        const float s3 = glm::sin(rotation.z);
+        const float c2 = glm::cos(rotation.x);
+        const float s2 = glm::sin(rotation.x);
+        const float c1 = glm::cos(rotation.y);
+        const float s1 = glm::sin(rotation.y);
+        const glm::vec3 invScale = 1.0f / scale;
+
+        modelMatrix = glm::mat4{
+            {
+                scale.x * (c1 * c3 + s1 * s2 * s3),
+                scale.x * (c2 * s3),
+                scale.x * (c1 * s2 * s3 - c3 * s1),
+                0.0f,
+            },
+            {
+                scale.y * (c3 * s1 * s2 - c1 * s3),
+                scale.y * (c2 * c3),
+                scale.y * (c1 * c3 * s2 + s1 * s3),
+                0.0f,
+            },
+            {
+                scale.z * (c2 * s1),
+                scale.z * (-s2),
+                scale.z * (c1 * c2),
+                0.0f,
+            },
+            {translation.x, translation.y, translation.z, 1.0f} };
+
+        normalMatrix = glm::mat3{
+            {
+                invScale.x * (c1 * c3 + s1 * s2 * s3),
+                invScale.x * (c2 * s3),
+                invScale.x * (c1 * s2 * s3 - c3 * s1),
+            },
+            {
+                invScale.y * (c3 * s1 * s2 - c1 * s3),
+                invScale.y * (c2 * c3),
+                invScale.y * (c1 * c3 * s2 + s1 * s3),
+            },
+            {
+                invScale.z * (c2 * s1),
+                invScale.z * (-s2),
+                invScale.z * (c1 * c2),
+            }
+        };
+    }
+
+#ifdef LVE_TRANSFORM_SIMD
+    namespace {
+        /**
+         * @brief Computes the sine and cosine of 4 angles at once.
+         * The angle is reduced to [-pi/4, pi/4] with a 3 part pi/2 (Cody-Waite), then minimax polynomials are evaluated.
+         * The absolute error stays under 1e-7 for |x| < 8192.
+         * @param x : The angles in radians.
+         * @param sinOut : Receives the sines.
+         * @param cosOut : Receives the cosines.
+        */
+        inline void sincos4(__m128 x, __m128& sinOut, __m128& cosOut) {
+            const __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(0.636619772367581343f)));
+            const __m128 q = _mm_cvtepi32_ps(quadrant);
+            __m128 r = _mm_sub_ps(x, _mm_mul_ps(q, _mm_set1_ps(1.5703125f)));
+            r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(4.837512969970703125e-4f)));
+            r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(7.54978995489188216e-8f)));
+            const __m128 r2 = _mm_mul_ps(r, r);
+
+            __m128 s = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-1.9515295891e-4f), r2), _mm_set1_ps(8.3321608736e-3f));
+            s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(-1.6666654611e-1f));
+            s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, r2), r), r);
+
+            __m128 c = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(2.443315711809948e-5f), r2), _mm_set1_ps(-1.388731625493765e-3f));
+            c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(4.166664568298827e-2f));
+            c = _mm_mul_ps(_mm_mul_ps(c, r2), r2);
+            c = _mm_add_ps(_mm_sub_ps(c, _mm_mul_ps(r2, _mm_set1_ps(0.5f))), _mm_set1_ps(1.0f));
+
+            // odd quadrants swap sine and cosine, the quadrant bits give the signs
+            const __m128i one = _mm_set1_epi32(1);
+            const __m128i two = _mm_set1_epi32(2);
+            const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+            const __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, two), 30));
+            const __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30));
+            sinOut = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s)), sinSign);
+            cosOut = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c)), cosSign);
+        }
+
+        /**
+         * @brief Transposes 4 SoA rows into 4 per-object columns.
+         * @param x : X components of the 4 objects.
+         * @param y : Y components of the 4 objects.
+         * @param z : Z components of the 4 objects.
+         * @param w : W components of the 4 objects.
+         * @param out : Receives the columns, out[k] is the column of object k.
+        */
+        inline void transpose4(__m128 x, __m128 y, __m128 z, __m128 w, __m128* out) {
+            _MM_TRANSPOSE4_PS(x, y, z, w);
+            out[0] = x;
+            out[1] = y;
+            out[2] = z;
+            out[3] = w;
+        }
+    }
+#endif
+
+    void LveTransformBatch::clear() {
+        translationX.clear(); translationY.clear(); translationZ.clear();
+        rotationX.clear(); rotationY.clear(); rotationZ.clear();
+        scaleX.clear(); scaleY.clear(); scaleZ.clear();
+    }
+
+    void LveTransformBatch::reserve(size_t count) {
+        translationX.reserve(count); translationY.reserve(count); translationZ.reserve(count);
+        rotationX.reserve(count); rotationY.reserve(count); rotationZ.reserve(count);
+        scaleX.reserve(count); scaleY.reserve(count); scaleZ.reserve(count);
+    }
+
+    void LveTransformBatch::add(const glm::vec3& translation, const glm::vec3& rotation, const glm::vec3& scale) {
+        translationX.push_back(translation.x); translationY.push_back(translation.y); translationZ.push_back(translation.z);
+        rotationX.push_back(rotation.x); rotationY.push_back(rotation.y); rotationZ.push_back(rotation.z);
+        scaleX.push_back(scale.x); scaleY.push_back(scale.y); scaleZ.push_back(scale.z);
+    }
+
+    void LveTransformBatch::computeMatricesScalar(glm::mat4* modelMatrices, glm::mat3* normalMatrices) const {
+        for (size_t i = 0; i < size(); i++) {
+            computeTransformMatrices({ translationX[i], translationY[i], translationZ[i] }, { rotationX[i], rotationY[i], rotationZ[i] }, { scaleX[i], scaleY[i], scaleZ[i] }, modelMatrices[i], normalMatrices[i]);
+        }
+    }
+
+    void LveTransformBatch::computeMatrices(glm::mat4* modelMatrices, glm::mat3* normalMatrices) const {
+        size_t i = 0;
+#ifdef LVE_TRANSFORM_SIMD
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        __m128 columns[4];
+        for (; i + 4 <= size(); i += 4) {
+            __m128 s1, c1, s2, c2, s3, c3;
+            sincos4(_mm_loadu_ps(&rotationY[i]), s1, c1);
+            sincos4(_mm_loadu_ps(&rotationX[i]), s2, c2);
+            sincos4(_mm_loadu_ps(&rotationZ[i]), s3, c3);
+
+            // rotation part shared by the model and normal matrices, rIJ is row J of column I
+            const __m128 s2s3 = _mm_mul_ps(s2, s3);
+            const __m128 c3s2 = _mm_mul_ps(c3, s2);
+            const __m128 r00 = _mm_add_ps(_mm_mul_ps(c1, c3), _mm_mul_ps(s1, s2s3));
+            const __m128 r01 = _mm_mul_ps(c2, s3);
+            const __m128 r02 = _mm_sub_ps(_mm_mul_ps(c1, s2s3), _mm_mul_ps(c3, s1));
+            const __m128 r10 = _mm_sub_ps(_mm_mul_ps(c3s2, s1), _mm_mul_ps(c1, s3));
+            const __m128 r11 = _mm_mul_ps(c2, c3);
+            const __m128 r12 = _mm_add_ps(_mm_mul_ps(c1, c3s2), _mm_mul_ps(s1, s3));
+            const __m128 r20 = _mm_mul_ps(c2, s1);
+            const __m128 r21 = _mm_sub_ps(zero, s2);
+            const __m128 r22 = _mm_mul_ps(c1, c2);
+
+            const __m128 sx = _mm_loadu_ps(&scaleX[i]);
+            const __m128 sy = _mm_loadu_ps(&scaleY[i]);
+            const __m128 sz = _mm_loadu_ps(&scaleZ[i]);
+            const __m128 isx = _mm_div_ps(one, sx);
+            const __m128 isy = _mm_div_ps(one, sy);
+            const __m128 isz = _mm_div_ps(one, sz);
+
+            // model matrices : one transpose per column, the 4 objects of the batch are written together
+            transpose4(_mm_mul_ps(sx, r00), _mm_mul_ps(sx, r01), _mm_mul_ps(sx, r02), zero, columns);
+            for (int k = 0; k < 4; k++) _mm_storeu_ps(&modelMatrices[i + k][0][0], columns[k]);
+            transpose4(_mm_mul_ps(sy, r10), _mm_mul_ps(sy, r11), _mm_mul_ps(sy, r12), zero, columns);
+            for (int k = 0; k < 4; k++) _mm_storeu_ps(&modelMatrices[i + k][1][0], columns[k]);
+            transpose4(_mm_mul_ps(sz, r20), _mm_mul_ps(sz, r21), _mm_mul_ps(sz, r22), zero, columns);
+            for (int k = 0; k < 4; k++) _mm_storeu_ps(&modelMatrices[i + k][2][0], columns[k]);
+            transpose4(_mm_loadu_ps(&translationX[i]), _mm_loadu_ps(&translationY[i]), _mm_loadu_ps(&translationZ[i]), one, columns);
+            for (int k = 0; k < 4; k++) _mm_storeu_ps(&modelMatrices[i + k][3][0], columns[k]);
+
+            // normal matrices : the columns are vec3, so only 3 floats of each transposed column are copied
+            alignas(16) float column[4];
+            transpose4(_mm_mul_ps(isx, r00), _mm_mul_ps(isx, r01), _mm_mul_ps(isx, r02), zero, columns);
+            for (int k = 0; k < 4; k++) { _mm_store_ps(column, columns[k]); std::memcpy(&normalMatrices[i + k][0][0], column, 3 * sizeof(float)); }
+            transpose4(_mm_mul_ps(isy, r10), _mm_mul_ps(isy, r11), _mm_mul_ps(isy, r12), zero, columns);
+            for (int k = 0; k < 4; k++) { _mm_store_ps(column, columns[k]); std::memcpy(&normalMatrices[i + k][1][0], column, 3 * sizeof(float)); }
+            transpose4(_mm_mul_ps(isz, r20), _mm_mul_ps(isz, r21), _mm_mul_ps(isz, r22), zero, columns);
+            for (int k = 0; k < 4; k++) { _mm_store_ps(column, columns[k]); std::memcpy(&normalMatrices[i + k][2][0], column, 3 * sizeof(float)); }
+        }
+#endif
+        // remaining transforms (or everything without SSE2)
+        for (; i < size(); i++) {
+            computeTransformMatrices({ translationX[i], translationY[i], translationZ[i] }, { rotationX[i], rotationY[i], rotationZ[i] }, { scaleX[i], scaleY[i], scaleZ[i] }, modelMatrices[i], normalMatrices[i]);
+        }
+    }
+}  // namespace lve
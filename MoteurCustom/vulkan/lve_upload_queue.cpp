@@ -0,0 +1,229 @@
+#include "lve_upload_queue.hpp"
+
+//std
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace lve {
+    namespace {
+        /**
+         * @brief Rounds a value up to a multiple of an alignment.
+         * @param value : The value.
+         * @param alignment : The alignment (not zero).
+         * @return The aligned value.
+        */
+        VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+    }
+
+    LveUploadQueue::LveUploadQueue(LveDevice& device) : lveDevice{ device } {
+        VkCommandPoolCreateInfo poolInfo = {};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.queueFamilyIndex = lveDevice.getTransferQueueFamily();
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        if (vkCreateCommandPool(lveDevice.getDevice(), &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create upload command pool!");
+        }
+
+        stagingRing = std::make_unique<LveBuffer>(lveDevice, RING_SIZE, 1, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        stagingRing->map();
+    }
+
+    LveUploadQueue::~LveUploadQueue() {
+        waitIdle();
+        for (auto& batch : freeBatches) {
+            vkFreeCommandBuffers(lveDevice.getDevice(), commandPool, 1, &batch.commandBuffer);
+            vkDestroyFence(lveDevice.getDevice(), batch.fence, nullptr);
+        }
+        vkDestroyCommandPool(lveDevice.getDevice(), commandPool, nullptr);
+    }
+
+    void LveUploadQueue::beginBatch() {
+        if (recordingBatch.id != 0) {
+            return;
+        }
+
+        if (!freeBatches.empty()) {
+            recordingBatch = std::move(freeBatches.back());
+            freeBatches.pop_back();
+        } else {
+            VkCommandBufferAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            allocInfo.commandPool = commandPool;
+            allocInfo.commandBufferCount = 1;
+            if (vkAllocateCommandBuffers(lveDevice.getDevice(), &allocInfo, &recordingBatch.commandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("failed to allocate upload command buffer!");
+            }
+
+            VkFenceCreateInfo fenceInfo = {};
+            fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+            if (vkCreateFence(lveDevice.getDevice(), &fenceInfo, nullptr, &recordingBatch.fence) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create upload fence!");
+            }
+        }
+        recordingBatch.id = nextBatchId++;
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        if (vkBeginCommandBuffer(recordingBatch.commandBuffer, &beginInfo) != VK_SUCCESS) {
+            throw std::runtime_error("failed to begin recording upload command buffer!");
+        }
+    }
+
+    void LveUploadQueue::submitBatch() {
+        if (recordingBatch.id == 0) {
+            return;
+        }
+        if (vkEndCommandBuffer(recordingBatch.commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to record upload command buffer!");
+        }
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &recordingBatch.commandBuffer;
+        {
+            // the transfer queue is the graphics queue on devices without another queue, the frames submit to it too
+            auto queueLock = lveDevice.lockQueue(lveDevice.getTransferQueue());
+            if (vkQueueSubmit(lveDevice.getTransferQueue(), 1, &submitInfo, recordingBatch.fence) != VK_SUCCESS) {
+                throw std::runtime_error("failed to submit upload command buffer!");
+            }
+        }
+
+        recordingBatch.ringEnd = ringHead;
+        inFlightBatches.push_back(std::move(recordingBatch));
+        recordingBatch = Batch{};
+        submittedBatchCount++;
+    }
+
+    void LveUploadQueue::retireBatches(uint64_t waitId) {
+        // the batches are submitted to a single queue, they finish in order
+        while (!inFlightBatches.empty()) {
+            Batch& batch = inFlightBatches.front();
+            if (batch.id <= waitId) {
+                vkWaitForFences(lveDevice.getDevice(), 1, &batch.fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+            } else if (vkGetFenceStatus(lveDevice.getDevice(), batch.fence) != VK_SUCCESS) {
+                break;
+            }
+
+            ringTail = std::max(ringTail, batch.ringEnd);
+            completedBatchId.store(batch.id);
+            vkResetFences(lveDevice.getDevice(), 1, &batch.fence);
+            batch.id = 0;
+            batch.stagingBuffers.clear();
+            freeBatches.push_back(std::move(batch));
+            inFlightBatches.pop_front();
+        }
+    }
+
+    bool LveUploadQueue::allocateStaging(VkDeviceSize size, VkDeviceSize& offset) {
+        if (ringHead == ringTail) {
+            // nothing is in use, start again at the beginning of the ring
+            ringHead = ringTail = alignUp(ringHead, RING_SIZE);
+        }
+        VkDeviceSize start = alignUp(ringHead, STAGING_ALIGNMENT);
+        // a range never wraps around the end of the ring, the rest of the lap is skipped instead
+        if (start % RING_SIZE + size > RING_SIZE) {
+            start = alignUp(start, RING_SIZE);
+        }
+        if (start + size - ringTail > RING_SIZE) {
+            return false;
+        }
+        offset = start % RING_SIZE;
+        ringHead = start + size;
+        return true;
+    }
+
+    uint64_t LveUploadQueue::upload(const void* data, VkDeviceSize size, VkBuffer dstBuffer, VkDeviceSize dstOffset) {
+        if (size == 0) {
+            return 0;
+        }
+        std::lock_guard<std::mutex> lock{ mutex };
+        beginBatch();
+
+        VkBuffer srcBuffer = stagingRing->getBuffer();
+        VkDeviceSize srcOffset = 0;
+        if (size > RING_SIZE) {
+            auto stagingBuffer = std::make_unique<LveBuffer>(lveDevice, size, 1, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            stagingBuffer->map();
+            stagingBuffer->writeToBuffer(const_cast<void*>(data), size);
+            srcBuffer = stagingBuffer->getBuffer();
+            recordingBatch.stagingBuffers.push_back(std::move(stagingBuffer));
+        } else {
+            // the ring is full : the oldest batch is waited on, or the recording batch is sent first if it holds the whole ring
+            while (!allocateStaging(size, srcOffset)) {
+                if (inFlightBatches.empty()) {
+                    submitBatch();
+                }
+                retireBatches(inFlightBatches.front().id);
+                beginBatch();
+            }
+            std::memcpy(static_cast<char*>(stagingRing->getMappedMemory()) + srcOffset, data, static_cast<size_t>(size));
+        }
+
+        VkBufferCopy copyRegion{};
+        copyRegion.srcOffset = srcOffset;
+        copyRegion.dstOffset = dstOffset;
+        copyRegion.size = size;
+        vkCmdCopyBuffer(recordingBatch.commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+        return recordingBatch.id;
+    }
+
+    uint64_t LveUploadQueue::copy(VkBuffer srcBuffer, VkDeviceSize srcOffset, VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize size) {
+        std::lock_guard<std::mutex> lock{ mutex };
+        beginBatch();
+
+        // the source may be the destination of an upload of the same batch
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(recordingBatch.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        VkBufferCopy copyRegion{};
+        copyRegion.srcOffset = srcOffset;
+        copyRegion.dstOffset = dstOffset;
+        copyRegion.size = size;
+        vkCmdCopyBuffer(recordingBatch.commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+        return recordingBatch.id;
+    }
+
+    void LveUploadQueue::submit() {
+        std::lock_guard<std::mutex> lock{ mutex };
+        submitBatch();
+    }
+
+    bool LveUploadQueue::isComplete(uint64_t ticket) {
+        if (ticket <= completedBatchId.load()) {
+            return true;
+        }
+        std::lock_guard<std::mutex> lock{ mutex };
+        if (ticket == recordingBatch.id) {
+            submitBatch();
+        }
+        retireBatches(0);
+        return ticket <= completedBatchId.load();
+    }
+
+    void LveUploadQueue::wait(uint64_t ticket) {
+        if (ticket <= completedBatchId.load()) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock{ mutex };
+        if (ticket == recordingBatch.id) {
+            submitBatch();
+        }
+        retireBatches(ticket);
+    }
+
+    void LveUploadQueue::waitIdle() {
+        std::lock_guard<std::mutex> lock{ mutex };
+        submitBatch();
+        retireBatches(std::numeric_limits<uint64_t>::max());
+    }
+}  // namespace lve
@@ -0,0 +1,80 @@
+#include "lve_vertex_quantizer.hpp"
+
+//libs
+#include <glm/gtc/packing.hpp>
+
+//std
+#include <algorithm>
+#include <cmath>
+
+namespace lve {
+    namespace {
+        constexpr float UNORM16_MAX = 65535.f;
+
+        /**
+         * @brief Sign of a value, with +1 for 0 so that no axis collapses when folding.
+         * @param value : The value.
+         * @return 1 or -1.
+        */
+        float signNotZero(float value) {
+            return value >= 0.f ? 1.f : -1.f;
+        }
+    }
+
+    LveModel::VertexDecode LveVertexQuantizer::getDecode(const AABB& bounds) {
+        LveModel::VertexDecode decode{};
+        decode.positionOffset = { bounds.minX, bounds.minY, bounds.minZ, 0.f };
+        decode.positionScale = { bounds.maxX - bounds.minX, bounds.maxY - bounds.minY, bounds.maxZ - bounds.minZ, 0.f };
+        return decode;
+    }
+
+    void LveVertexQuantizer::quantize(const LveModel::Vertex* vertices, uint32_t count, const LveModel::VertexDecode& decode, LveModel::CompactVertex* compactVertices) {
+        glm::vec3 offset{ decode.positionOffset };
+        glm::vec3 scale{ decode.positionScale };
+        glm::vec3 inverseScale{
+            scale.x > 0.f ? 1.f / scale.x : 0.f,
+            scale.y > 0.f ? 1.f / scale.y : 0.f,
+            scale.z > 0.f ? 1.f / scale.z : 0.f };
+
+        for (uint32_t i = 0; i < count; i++) {
+            const LveModel::Vertex& vertex = vertices[i];
+            glm::vec3 unorm = glm::clamp((vertex.position - offset) * inverseScale, 0.f, 1.f);
+            compactVertices[i].position = glm::u16vec4(glm::u16vec3(glm::round(unorm * UNORM16_MAX)), 0);
+            compactVertices[i].normal = glm::packSnorm2x16(encodeOctahedral(vertex.normal));
+            compactVertices[i].color = glm::packUnorm4x8(glm::vec4(vertex.color, 1.f));
+            compactVertices[i].uv = glm::packHalf2x16(vertex.uv);
+        }
+    }
+
+    LveModel::Vertex LveVertexQuantizer::dequantize(const LveModel::CompactVertex& compactVertex, const LveModel::VertexDecode& decode) {
+        LveModel::Vertex vertex{};
+        vertex.position = glm::vec3(decode.positionOffset) + glm::vec3(compactVertex.position) / UNORM16_MAX * glm::vec3(decode.positionScale);
+        vertex.color = glm::vec3(glm::unpackUnorm4x8(compactVertex.color));
+        vertex.normal = decodeOctahedral(glm::unpackSnorm2x16(compactVertex.normal));
+        vertex.uv = glm::unpackHalf2x16(compactVertex.uv);
+        return vertex;
+    }
+
+    glm::vec2 LveVertexQuantizer::encodeOctahedral(const glm::vec3& normal) {
+        float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+        if (length == 0.f) {
+            // a mesh without normals
+            return { 0.f, 0.f };
+        }
+        glm::vec2 projected = glm::vec2(normal.x, normal.y) / length;
+        if (normal.z < 0.f) {
+            projected = {
+                (1.f - std::abs(projected.y)) * signNotZero(projected.x),
+                (1.f - std::abs(projected.x)) * signNotZero(projected.y) };
+        }
+        return projected;
+    }
+
+    glm::vec3 LveVertexQuantizer::decodeOctahedral(const glm::vec2& encoded) {
+        glm::vec3 normal{ encoded.x, encoded.y, 1.f - std::abs(encoded.x) - std::abs(encoded.y) };
+        float fold = std::max(-normal.z, 0.f);
+        normal.x += normal.x >= 0.f ? -fold : fold;
+        normal.y += normal.y >= 0.f ? -fold : fold;
+        return glm::normalize(normal);
+    }
+}  // namespace lve
@@ -4,11 +4,16 @@
 
 
 namespace lve {
-    LveWindow::LveWindow(int w, int h, std::string name) : width{ w }, height{ h }, windowName{ name } {
-        initWindow();
+    LveWindow::LveWindow(int w, int h, std::string name, bool headless) : width{ w }, height{ h }, headless{ headless }, windowName{ name } {
+        if (!headless) {
+            initWindow();
+        }
     }
 
     LveWindow::~LveWindow() {
+        if (headless) {
+            return;
+        }
         glfwDestroyWindow(window);
         glfwTerminate();
     }
@@ -24,6 +29,9 @@ namespace lve {
     }
 
     void LveWindow::createWindowSurface(VkInstance instance, VkSurfaceKHR* surface) {
+        if (headless) {
+            throw std::runtime_error("cannot create a window surface for a headless window");
+        }
         if (glfwCreateWindowSurface(instance, window, nullptr, surface) != VK_SUCCESS) {
             throw std::runtime_error("faile to create window surface");
         }
@@ -1,4 +1,7 @@
 #include "point_light_system.hpp"
+#include "lve_cluster_grid.hpp"
+#include "lve_pipeline_registry.hpp"
+#include "lve_swap_chain.hpp"
 
 #include <stdexcept>
 #include <array>
@@ -6,46 +9,52 @@
 #include <ctime>
 #include <chrono>
 #include <vector>
+#include <algorithm>
+#include <cstddef>
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 
-#define MS_PER_UPDATE 0.016 // 1/60
-
 #include "glm/glm.hpp"
 #include "glm/gtc/constants.hpp"
-#include <map>
 
 namespace lve {
-    struct PointLightPushConstants {
-        glm::vec4 position{};
-        glm::vec4 color{};
-        float radius;
-    };
+    std::vector<VkVertexInputBindingDescription> PointLightInstanceData::getBindingDescriptions() {
+        std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
+        bindingDescriptions[0].binding = 0;
+        bindingDescriptions[0].stride = sizeof(PointLightInstanceData);
+        bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+        return bindingDescriptions;
+    }
+
+    std::vector<VkVertexInputAttributeDescription> PointLightInstanceData::getAttributeDescriptions() {
+        std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
+        attributeDescriptions.push_back({ 0, 0, VK_FORMAT_R32G32B32A32_SFLOAT, static_cast<uint32_t>(offsetof(PointLightInstanceData, position)) });
+        attributeDescriptions.push_back({ 1, 0, VK_FORMAT_R32G32B32A32_SFLOAT, static_cast<uint32_t>(offsetof(PointLightInstanceData, color)) });
+        return attributeDescriptions;
+    }
 
     PointLightSystem::PointLightSystem(LveDevice& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout) : lveDevice{ device } {
         createPipelineLayout(globalSetLayout);
         createPipeline(renderPass);
+        instanceBuffers.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
     }
 
     PointLightSystem::~PointLightSystem() {
+        // a reload may be building the pipeline with the layout, it is released first
+        lvePipeline.reset();
         vkDestroyPipelineLayout(lveDevice.getDevice(), pipelineLayout, nullptr);
     }
 
     void PointLightSystem::createPipelineLayout(VkDescriptorSetLayout globalSetLayout) {
-        VkPushConstantRange pushConstantRange{};
-        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-        pushConstantRange.offset = 0;
-        pushConstantRange.size = sizeof(PointLightPushConstants);
-
         std::vector<VkDescriptorSetLayout> descriptorSetLayouts{ globalSetLayout };
 
         VkPipelineLayoutCreateInfo pipelineLayoutinfo{};
         pipelineLayoutinfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
         pipelineLayoutinfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());;
         pipelineLayoutinfo.pSetLayouts = descriptorSetLayouts.data();;
-        pipelineLayoutinfo.pushConstantRangeCount = 1;
-        pipelineLayoutinfo.pPushConstantRanges = &pushConstantRange;
+        pipelineLayoutinfo.pushConstantRangeCount = 0;
+        pipelineLayoutinfo.pPushConstantRanges = nullptr;
         if (vkCreatePipelineLayout(lveDevice.getDevice(), &pipelineLayoutinfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
             throw std::runtime_error("failed to create pipeline layout!");
         }
@@ -57,26 +66,22 @@ namespace lve {
         return duration_in_seconds.count();
     }
 
-    void PointLightSystem::update(FrameInfo& frameInfo, GlobalUbo& ubo) {
-        auto rotateLight = glm::rotate(glm::mat4(1.f), frameInfo.frameTime, { 0.f, -1.f, 0.f });
-
-        int lightIndex = 0;
-        for (auto& kv : frameInfo.gameObjects) {
-            auto& obj = kv.second;
-            if (obj.pointLight == nullptr) continue;
-
-            assert(lightIndex < MAX_LIGHTS && "Point lights exceed maximum specified");
-            // update light positions
-            obj.transform.translation = glm::vec3(rotateLight * glm::vec4(obj.transform.translation, 1.f));
-
-
-            // copy light to ubo
-            ubo.pointLights[lightIndex].position = glm::vec4(obj.transform.translation, 1.f);
-            ubo.pointLights[lightIndex].color = glm::vec4(obj.color, obj.pointLight->lightIntensity);
+    void PointLightSystem::rotateLights(LveRegistry& registry, float dt) {
+        auto rotateLight = glm::rotate(glm::mat4(1.f), dt, { 0.f, -1.f, 0.f });
+        registry.each<PointLightComponent, TransformComponent>([&](LveGameObject::id_t, PointLightComponent&, TransformComponent& transform) {
+            transform.setTranslation(glm::vec3(rotateLight * glm::vec4(transform.getTranslation(), 1.f)));
+        });
+    }
 
-            lightIndex += 1;
-        }
-        ubo.numLights = lightIndex;
+    void PointLightSystem::update(FrameInfo& frameInfo, std::vector<PointLight>& lights) {
+        lights.clear();
+        frameInfo.registry.each<PointLightComponent, TransformComponent>([&](LveGameObject::id_t, PointLightComponent& light, TransformComponent& transform) {
+            // copy light for the clusters, where it is drawn
+            PointLight pointLight{};
+            pointLight.color = glm::vec4(light.color, light.lightIntensity);
+            pointLight.position = glm::vec4(transform.getInterpolatedTranslation(), LveClusterGrid::computeLightRange(pointLight.color));
+            lights.push_back(pointLight);
+        });
     }
 
     void PointLightSystem::createPipeline(VkRenderPass renderPass) {
@@ -85,40 +90,71 @@ namespace lve {
         PipeLineConfigInfo pipelineConfig{};
         LvePipeline::defaultPipeLineConfigInfo(pipelineConfig);
         LvePipeline::enableAlphaBlending(pipelineConfig);
-        pipelineConfig.attributeDescriptions.clear();
-        pipelineConfig.bindingDescriptions.clear();
+        pipelineConfig.attributeDescriptions = PointLightInstanceData::getAttributeDescriptions();
+        pipelineConfig.bindingDescriptions = PointLightInstanceData::getBindingDescriptions();
         pipelineConfig.renderPass = renderPass;
         pipelineConfig.pipelineLayout = pipelineLayout;
-        lvePipeline = std::make_unique<LvePipeline>(lveDevice, "./shaders/SPIR-V/point_light.vert.spv", "./shaders/SPIR-V/point_light.frag.spv", pipelineConfig);
+        lvePipeline = lveDevice.getPipelineRegistry().requestPipeline("./shaders/SPIR-V/point_light.vert.spv", "./shaders/SPIR-V/point_light.frag.spv", pipelineConfig);
+    }
+
+    LveBuffer& PointLightSystem::getInstanceBuffer(int frameIndex, uint32_t instanceCount) {
+        auto& instanceBuffer = instanceBuffers[frameIndex];
+        if (instanceBuffer == nullptr || instanceBuffer->getInstanceCount() < instanceCount) {
+            // the fence of this frame has been waited on in beginFrame, the old buffer is no longer in use
+            uint32_t capacity = instanceBuffer == nullptr ? 64 : instanceBuffer->getInstanceCount();
+            while (capacity < instanceCount) {
+                capacity *= 2;
+            }
+            instanceBuffer = std::make_unique<LveBuffer>(lveDevice, sizeof(PointLightInstanceData), capacity, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+            instanceBuffer->map();
+        }
+        return *instanceBuffer;
     }
 
     void PointLightSystem::render(FrameInfo& frameInfo) {
-        // sort lights
-        std::map<float, LveGameObject::id_t> sorted;
-        for (auto& kv : frameInfo.gameObjects) {
-            auto& obj = kv.second;
-            if (obj.pointLight == nullptr) continue;
-
-            // calculate distance
-            auto offset = frameInfo.camera.getPosition() - obj.transform.translation;
-            float disSquared = glm::dot(offset, offset);
-            sorted[disSquared] = obj.getId();
+        if (!lvePipeline->isReady()) {
+            // the billboards appear once the registry has compiled their pipeline
+            return;
+        }
+
+        // gather the lights and their distance to the camera
+        lightInstances.clear();
+        sortKeys.clear();
+        glm::vec3 cameraPosition = frameInfo.camera.getPosition();
+        frameInfo.registry.each<PointLightComponent, TransformComponent>([&](LveGameObject::id_t, PointLightComponent& light, TransformComponent& transform) {
+            glm::vec3 position = transform.getInterpolatedTranslation();
+            auto offset = cameraPosition - position;
+            sortKeys.push_back({ glm::dot(offset, offset), static_cast<uint32_t>(lightInstances.size()) });
+
+            PointLightInstanceData instance{};
+            instance.position = glm::vec4(position, transform.getInterpolatedScale().x);
+            instance.color = glm::vec4(light.color, light.lightIntensity);
+            lightInstances.push_back(instance);
+        });
+        if (lightInstances.empty()) {
+            return;
         }
+
+        // back to front for the alpha blending, lights at the same distance are all kept
+        std::sort(sortKeys.begin(), sortKeys.end(), [](const LightSortKey& a, const LightSortKey& b) {
+            return a.distanceSquared != b.distanceSquared ? a.distanceSquared > b.distanceSquared : a.index < b.index;
+        });
+
+        uint32_t instanceCount = static_cast<uint32_t>(sortKeys.size());
+        LveBuffer& instanceBuffer = getInstanceBuffer(frameInfo.frameIndex, instanceCount);
+        auto instances = static_cast<PointLightInstanceData*>(instanceBuffer.getMappedMemory());
+        for (uint32_t i = 0; i < instanceCount; i++) {
+            instances[i] = lightInstances[sortKeys[i].index];
+        }
+        instanceBuffer.flush();
+
         lvePipeline->bind(frameInfo.commandBuffer);
 
         vkCmdBindDescriptorSets(frameInfo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &frameInfo.globalDescriptorSet, 0, nullptr);
-        // iterate through sorted lights in reverse order
-        for (auto it = sorted.rbegin(); it != sorted.rend(); ++it) {
-            // use game obj id to find light object
-            auto& obj = frameInfo.gameObjects.at(it->second);
-
-            PointLightPushConstants push{};
-            push.position = glm::vec4(obj.transform.translation, 1.f);
-            push.color = glm::vec4(obj.color, obj.pointLight->lightIntensity);
-            push.radius = obj.transform.scale.x;
-
-            vkCmdPushConstants(frameInfo.commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PointLightPushConstants), &push);
-            vkCmdDraw(frameInfo.commandBuffer, 6, 1, 0, 0);
-        }
+        VkBuffer buffers[] = { instanceBuffer.getBuffer() };
+        VkDeviceSize offsets[] = { 0 };
+        vkCmdBindVertexBuffers(frameInfo.commandBuffer, 0, 1, buffers, offsets);
+        // the instances are blended in order, 6 vertices per billboard
+        vkCmdDraw(frameInfo.commandBuffer, 6, instanceCount, 0, 0);
     }
 }
\ No newline at end of file